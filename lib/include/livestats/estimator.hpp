@@ -1,6 +1,7 @@
 #pragma once
 
 #include <concepts>
+#include <cstddef>
 
 namespace livestats {
 
@@ -25,6 +26,44 @@ concept Estimator = requires(T estimator, T const& const_estimator)
     { const_estimator.size() } -> std::same_as<std::size_t>;
 };
 
+/**
+ * Like an estimator, but observations are pairs of values `(x, y)` supplied to `add(x, y)` or `push(x, y)`,
+ * eg to estimate the covariance of two series.
+ */
+template <typename T>
+concept BivariateEstimator = requires(T estimator, T const& const_estimator, typename T::value_type const x)
+{
+    typename T::value_type;
+    { estimator.add(x, x) } -> std::same_as<typename T::value_type>;
+    { estimator.push(x, x) }; // may return void but not required
+    { estimator.reset() }; // may return void but not required
+    { const_estimator.get() } -> std::same_as<typename T::value_type>;
+    { const_estimator.size() } -> std::same_as<std::size_t>;
+};
+
+/**
+ * A variance estimator that also exposes the mean it tracks internally via `mean()`,
+ * so that consumers needing both do not have to maintain a second mean estimate.
+ */
+template <typename T>
+concept MeanVarianceEstimator = Estimator<T> and requires(T const& const_estimator)
+{
+    { const_estimator.mean() } -> std::same_as<typename T::value_type>;
+};
+
+/**
+ * Return the number of bytes used by the given estimator, including the buffers it owns,
+ * as reported by its `memory_usage()` method; estimators without it are assumed to own no buffer.
+ */
+template <typename T>
+std::size_t memory_usage(T const& estimator)
+{
+    if constexpr (requires { { estimator.memory_usage() } -> std::convertible_to<std::size_t>; })
+        return estimator.memory_usage();
+    else
+        return sizeof(T);
+}
+
 /**
  * An example of an estimator, useful to static assert that estimator adatoprs are themeselves estimators.
  */
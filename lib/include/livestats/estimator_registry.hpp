@@ -0,0 +1,101 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+#include "livestats/seqlock_estimator_adaptor.hpp"
+
+#include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace livestats {
+
+/**
+ * A label of a metric as a name and a value, eg `{"instrument", "ESZ4"}`.
+ */
+using metric_label_t = std::pair<std::string_view, std::string_view>;
+
+/**
+ * A collection of named and labelled estimators to export as metrics, eg via `openmetrics_exporter_t`.
+ * Estimators registered under the same name form a family, and must have different labels.
+ * Estimators are wrapped in `seqlock_estimator_adaptor_t`, so that exporters take consistent snapshots
+ * from another thread without ever blocking the writers; the registry only refers to them,
+ * so they must outlive it, eg by living in a `shared_memory_segment_t`.
+ * Names and labels are validated and rendered once, when registered, so that exporting needs no allocation.
+ * Registering is not thread-safe: it must not happen concurrently with exports.
+ */
+class estimator_registry_t
+{
+public:
+    /**
+     * Reads the current estimate of the estimator at the given address.
+     */
+    using reader_t = double (*)(void const*);
+
+    /**
+     * One estimator of a family, with its labels already rendered as `{name="value",...}`, or empty.
+     */
+    struct series_t
+    {
+        std::string labels;
+        void const* estimator;
+        reader_t read;
+
+        double value() const { return read(estimator); }
+    };
+
+    /**
+     * All estimators registered under the same name.
+     */
+    struct family_t
+    {
+        std::string name;
+        std::string help;
+        std::vector<series_t> series;
+    };
+
+    /**
+     * Register an estimator under the given name and labels, with an optional description of the family.
+     * Throw `std::invalid_argument` if the name or a label name is not a valid metric name,
+     * or if the family already has an estimator with the same labels.
+     */
+    template <Estimator EstimatorType>
+    void add(
+        std::string_view const name,
+        std::initializer_list<metric_label_t> const labels,
+        seqlock_estimator_adaptor_t<EstimatorType> const& estimator,
+        std::string_view const help = {})
+    {
+        add(name, labels, help, &estimator, [] (void const* const p) {
+            auto const& adaptor = *static_cast<seqlock_estimator_adaptor_t<EstimatorType> const*>(p);
+            // a writer stuck in the middle of an update yields NaN rather than hanging the scrape
+            auto const copy = adaptor.try_snapshot();
+            return copy ? static_cast<double>(copy->get()) : std::numeric_limits<double>::quiet_NaN();
+        });
+    }
+
+    /**
+     * Return all families, in the order their first estimator was registered.
+     */
+    std::vector<family_t> const& families() const { return metric_families; }
+
+    /**
+     * Return the total number of registered estimators.
+     */
+    std::size_t size() const;
+
+private:
+    std::vector<family_t> metric_families;
+
+    void add(
+        std::string_view name,
+        std::initializer_list<metric_label_t> labels,
+        std::string_view help,
+        void const* estimator,
+        reader_t read);
+};
+
+} // namespace livestats
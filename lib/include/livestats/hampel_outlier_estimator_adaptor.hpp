@@ -0,0 +1,181 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
+#include "livestats/sliding_window_median_estimator.hpp"
+
+#include <utility>
+
+namespace livestats {
+
+/**
+ * An estimator adaptor that filters outliers before pushing new samples into the underlying estimator,
+ * using the Hampel identifier: new samples are considered outliers if their distance from the median
+ * of the last N samples is more than `threshold()` times the median absolute deviation (MAD) of those samples.
+ * Unlike the mean and variance used by `zscore_outlier_estimator_adaptor_t`,
+ * the median and MAD are barely affected by the outliers themselves.
+ * The default threshold of 4.4478 corresponds to 3 standard deviations for normally distributed data
+ * (the standard deviation being about 1.4826 times the MAD); it is truncated to 4 for integer samples.
+ * In order to allow this filter to adjust to new regimes in the incoming data stream,
+ * the window includes all discarded samples as well as all accepted samples.
+ * Filtering a sample costs O(log² N) on average, dominated by `median_absolute_deviation()`,
+ * since the treap of `sliding_window_median_estimator_t` is only balanced on average.
+ *
+ * @tparam  EstimatorType       The underlying estimator being adapted.
+ */
+template <Estimator EstimatorType>
+class hampel_outlier_estimator_adaptor_t
+{
+    EstimatorType estimator;
+    sliding_window_median_estimator_t<typename EstimatorType::value_type> window;
+
+    std::size_t n_discarded = 0ul;
+    typename EstimatorType::value_type k;
+
+public:
+    using value_type = typename EstimatorType::value_type;
+
+    static constexpr value_type default_threshold = static_cast<value_type>(3 * 1.4826);
+
+    explicit hampel_outlier_estimator_adaptor_t(
+        std::size_t const window_size,
+        value_type const threshold = default_threshold,
+        EstimatorType estimator = {}
+    )
+        : estimator(std::move(estimator))
+        , window(window_size)
+        , k(threshold)
+    { }
+
+    /**
+     * Check if the input value is an outlier:
+     *   - if not pass it to the underlying estimator and return the new result;
+     *   - otherwise discard the sample and return the previous result from the underlying estimator.
+     */
+    value_type add(value_type const x)
+    {
+        push(x);
+        return get();
+    }
+
+    /**
+     * Check if the input value is an outlier:
+     *   - if not pass it to the underlying estimator and return the new result;
+     *   - otherwise discard the sample.
+     */
+    void push(value_type const x)
+    {
+        if (not is_outlier(x))
+            estimator.push(x);
+        else
+            ++n_discarded;
+        window.push(x);
+    }
+
+    /**
+     * Discard everything and reset as if just constructed, keeping the window size and threshold.
+     */
+    void reset()
+    {
+        estimator.reset();
+        window.reset();
+        n_discarded = 0ul;
+    }
+
+    /**
+     * Return the current value of the underlying estimator,
+     * without performing any computation.
+     */
+    value_type get() const { return estimator.get(); }
+
+    /**
+     * Return the total number of samples observed so far, excluding discarded samples.
+     * Use `size_discarded()` to retrieve the number of samples discarded so far.
+     */
+    std::size_t size() const { return estimator.size(); }
+
+    /**
+     * Return the number of samples discarded so far.
+     * Use `size()` to retrieve the number of samples accepted so far.
+     */
+    std::size_t size_discarded() const { return n_discarded; }
+
+    /**
+     * Return the number of bytes used by this adaptor, including the window of recent samples.
+     */
+    std::size_t memory_usage() const
+    {
+        return sizeof(*this)
+            + livestats::memory_usage(estimator) - sizeof(estimator)
+            + window.memory_usage() - sizeof(window);
+    }
+
+    /**
+     * Return the number of median absolute deviations from the median beyond which samples are discarded.
+     */
+    value_type threshold() const { return k; }
+
+    /**
+     * Change the number of median absolute deviations from the median beyond which new samples are discarded.
+     */
+    void set_threshold(value_type const threshold) { k = threshold; }
+
+    /**
+     * Return the median of the last N samples, including discarded samples.
+     */
+    value_type median() const { return window.get(); }
+
+    /**
+     * Return the median absolute deviation of the last N samples, including discarded samples.
+     */
+    value_type median_absolute_deviation() const { return window.median_absolute_deviation(); }
+
+    /**
+     * Save the current state of the underlying estimator and of the outlier filter to the given stream;
+     * see `Serializable`. The threshold is configuration rather than state, so it is not saved.
+     */
+    void save(std::ostream& out) const
+        requires Serializable<EstimatorType> and serialization::Trivial<value_type>
+    {
+        using namespace serialization;
+        write_header<value_type>(out, kind_t::hampel_outlier_adaptor);
+        estimator.save(out);
+        window.save(out);
+        write(out, n_discarded);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved window size must match the window size of this adaptor.
+     */
+    void load(std::istream& in)
+        requires Serializable<EstimatorType> and serialization::Trivial<value_type>
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type>(in, kind_t::hampel_outlier_adaptor))
+            return;
+        estimator.load(in);
+        window.load(in);
+        n_discarded = read<std::size_t>(in);
+        if (not in)
+            reset();
+    }
+
+private:
+    bool is_outlier(value_type const x) const
+    {
+        if (window.size() == 0ul)
+            return false;
+        // a zero MAD (eg most recent samples are equal) gives no scale to judge deviations, so accept everything
+        auto const mad = window.median_absolute_deviation();
+        if (mad == value_type{})
+            return false;
+        auto const median = window.get();
+        auto const deviation = x < median ? median - x : x - median;
+        return deviation > k * mad;
+    }
+};
+static_assert(Estimator<hampel_outlier_estimator_adaptor_t<estimator_archetype_t>>);
+
+} // namespace livestats
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "livestats/serialization.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <string_view>
+
+namespace livestats {
+
+/**
+ * A fast 64-bit hash for `hyperloglog_estimator_t`, mixing integers with the finalizer of MurmurHash3
+ * and strings 8 bytes at a time; it is not meant to resist adversarial keys.
+ */
+struct hyperloglog_hash_t
+{
+    template <std::integral T>
+    std::uint64_t operator()(T const key) const { return mix(static_cast<std::uint64_t>(key)); }
+
+    std::uint64_t operator()(std::string_view const key) const
+    {
+        auto h = 0x9e3779b97f4a7c15ul ^ key.size();
+        std::size_t i = 0ul;
+        for (; i + 8ul <= key.size(); i += 8ul)
+        {
+            std::uint64_t chunk;
+            std::memcpy(&chunk, key.data() + i, 8ul);
+            h = (h ^ mix(chunk)) * 0xff51afd7ed558ccdul;
+        }
+        std::uint64_t tail = 0ul;
+        std::memcpy(&tail, key.data() + i, key.size() - i);
+        return mix(h ^ tail);
+    }
+
+    static std::uint64_t mix(std::uint64_t h)
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdul;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ul;
+        h ^= h >> 33;
+        return h;
+    }
+};
+
+/**
+ * Estimates the number of distinct keys in a sequence, eg unique clients, without storing them,
+ * with the HyperLogLog algorithm of Flajolet et al: each key is hashed to one of 2^Precision registers,
+ * which keeps the longest run of leading zeros seen in the rest of the hashes,
+ * and the harmonic mean of the registers gives the estimate, with a relative standard error of about
+ * `1.04 / sqrt(2^Precision)`, eg 1.6% with the default precision, using 4KB.
+ * Two estimators, eg filled by different threads or over different time buckets, can be combined via `merge()`,
+ * a byte-wise maximum of the registers that compilers vectorize.
+ *
+ * @tparam  Precision   The base 2 logarithm of the number of registers, from 4 to 16;
+ *                      registers are stored inline, so large sketches should not live on the stack.
+ * @tparam  Hash        The hash function of keys, returning `std::uint64_t`.
+ */
+template <std::size_t Precision = 12ul, typename Hash = hyperloglog_hash_t>
+class hyperloglog_estimator_t
+{
+    static_assert(Precision >= 4ul and Precision <= 16ul);
+
+public:
+    using value_type = double;
+
+    static constexpr std::size_t precision = Precision;
+    static constexpr std::size_t register_count = 1ul << Precision;
+
+private:
+    std::array<std::uint8_t, register_count> ranks = {}; // the registers
+    std::size_t n = 0ul;
+    [[no_unique_address]] Hash hash;
+
+public:
+    /**
+     * Add a key and return the new estimate of the number of distinct keys.
+     */
+    template <typename Key>
+        requires std::invocable<Hash const&, Key const&>
+    value_type add(Key const& key)
+    {
+        push(key);
+        return get();
+    }
+
+    /**
+     * Add a key.
+     */
+    template <typename Key>
+        requires std::invocable<Hash const&, Key const&>
+    void push(Key const& key)
+    {
+        push_hash(hash(key));
+    }
+
+    /**
+     * Add a key already hashed with a good 64-bit hash function.
+     */
+    void push_hash(std::uint64_t const h)
+    {
+        ++n;
+        auto const index = h >> (64ul - Precision);
+        // the sentinel bit bounds the rank when the remaining bits are all zero
+        auto const rest = (h << Precision) | (1ul << (Precision - 1ul));
+        auto const rank = static_cast<std::uint8_t>(std::countl_zero(rest) + 1);
+        ranks[index] = std::max(ranks[index], rank);
+    }
+
+    /**
+     * Add all the keys added to another estimator.
+     */
+    void merge(hyperloglog_estimator_t const& other)
+    {
+        for (std::size_t i = 0ul; i < register_count; ++i)
+            ranks[i] = std::max(ranks[i], other.ranks[i]);
+        n += other.n;
+    }
+
+    /**
+     * Discard everything and reset as if default-constructed.
+     */
+    void reset()
+    {
+        ranks.fill(0u);
+        n = 0ul;
+    }
+
+    /**
+     * Return the estimate of the number of distinct keys, in O(number of registers).
+     */
+    value_type get() const
+    {
+        double harmonic_sum = 0.0;
+        std::size_t n_zeros = 0ul;
+        for (auto const r: ranks)
+        {
+            harmonic_sum += inverse_power_of_two(r);
+            n_zeros += r == 0u;
+        }
+        return estimate(harmonic_sum, n_zeros);
+    }
+
+    /**
+     * Return the total number of keys added so far, including duplicates.
+     */
+    std::size_t size() const { return n; }
+
+    /**
+     * Return the relative standard error of the estimate.
+     */
+    static double relative_error() { return 1.04 / std::sqrt(static_cast<double>(register_count)); }
+
+    /**
+     * Return the registers, ie the largest rank of the hashes that fell in each.
+     */
+    std::span<std::uint8_t const, register_count> registers() const { return ranks; }
+
+    /**
+     * Return the number of bytes used by this estimator, which owns no buffer.
+     */
+    std::size_t memory_usage() const { return sizeof(*this); }
+
+    /**
+     * Save the registers and the number of keys to the given stream; see `Serializable`.
+     * The hash function is not saved, so it must be the same when the state is restored.
+     */
+    void save(std::ostream& out) const
+    {
+        using namespace serialization;
+        write_header<value_type>(out, kind_t::hyperloglog);
+        write(out, precision);
+        write(out, ranks);
+        write(out, n);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved precision must match the precision of this estimator.
+     */
+    void load(std::istream& in)
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type>(in, kind_t::hyperloglog))
+            return;
+        if (read<std::size_t>(in) != precision)
+            return fail(in);
+        ranks = read<decltype(ranks)>(in);
+        n = read<std::size_t>(in);
+        auto const valid = [] (std::uint8_t const r) { return r < inverse_powers_of_two.size(); };
+        if (not in or not std::all_of(ranks.begin(), ranks.end(), valid))
+        {
+            reset();
+            fail(in);
+        }
+    }
+
+    /**
+     * Return `2^-rank`, the contribution of a register to the harmonic sum.
+     */
+    static double inverse_power_of_two(std::uint8_t const rank) { return inverse_powers_of_two[rank]; }
+
+    /**
+     * Return the estimate of the number of distinct keys given the harmonic sum of all registers
+     * and the number of registers still zero, eg for registers merged on the fly;
+     * small cardinalities are estimated by linear counting, which is more accurate.
+     */
+    static double estimate(double const harmonic_sum, std::size_t const n_zeros)
+    {
+        constexpr auto m = static_cast<double>(register_count);
+        constexpr auto alpha =
+            register_count == 16ul ? 0.673 :
+            register_count == 32ul ? 0.697 :
+            register_count == 64ul ? 0.709 :
+            0.7213 / (1.0 + 1.079 / m);
+        auto const raw = alpha * m * m / harmonic_sum;
+        if (raw <= 2.5 * m and n_zeros > 0ul)
+            return m * std::log(m / static_cast<double>(n_zeros));
+        return raw;
+    }
+
+private:
+    static constexpr std::array<double, 66ul - Precision> inverse_powers_of_two = [] {
+        std::array<double, 66ul - Precision> powers{};
+        double p = 1.0;
+        for (auto& power: powers)
+        {
+            power = p;
+            p /= 2.0;
+        }
+        return powers;
+    }();
+};
+// explicitly instantiated in livestats_lib for the default precision
+extern template class hyperloglog_estimator_t<>;
+
+} // namespace livestats
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+
+namespace livestats {
+
+/**
+ * Instrumentation policy of sliding time window estimators that records nothing:
+ * it is stateless and all its hooks are empty, so an estimator using it is as fast and as big as without hooks.
+ */
+struct no_instrumentation_t
+{
+    void on_push(std::size_t /* buffer_size */) { }
+    void on_discard() { }
+    void on_advance(std::size_t /* n_evicted */) { }
+    void on_allocation(std::size_t /* capacity */) { }
+};
+
+/**
+ * Instrumentation policy of sliding time window estimators that counts what happens on the hot path,
+ * eg to tell how much work `advance()` does and how big the sample buffer gets.
+ * Counters cover the whole lifetime of the estimator: they are neither reset by `reset()` nor saved by `save()`.
+ */
+struct counting_instrumentation_t
+{
+    /**
+     * Number of buckets of the histogram of evictions per `advance()`:
+     * bucket 0 counts calls evicting nothing, bucket `b` calls evicting `[2^(b-1), 2^b)` samples,
+     * and the last bucket also counts all larger evictions.
+     */
+    static constexpr std::size_t histogram_size = 16ul;
+
+    std::size_t n_pushes = 0ul;         // samples accepted
+    std::size_t n_discarded = 0ul;      // samples discarded because older than the latest sample
+    std::size_t n_advances = 0ul;       // calls to `advance()`, including those made by `push()`
+    std::size_t n_evicted = 0ul;        // samples removed from any window, summed over windows
+    std::size_t n_allocations = 0ul;    // reallocations of the sample buffer
+    std::size_t max_buffer_size = 0ul;  // high watermark of the sample buffer
+    std::array<std::size_t, histogram_size> evictions_histogram{};
+
+    void on_push(std::size_t const buffer_size)
+    {
+        ++n_pushes;
+        max_buffer_size = std::max(max_buffer_size, buffer_size);
+    }
+
+    void on_discard() { ++n_discarded; }
+
+    void on_advance(std::size_t const evicted)
+    {
+        ++n_advances;
+        n_evicted += evicted;
+        ++evictions_histogram[std::min<std::size_t>(std::bit_width(evicted), histogram_size - 1ul)];
+    }
+
+    void on_allocation(std::size_t /* capacity */) { ++n_allocations; }
+};
+
+} // namespace livestats
@@ -0,0 +1,411 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace livestats {
+
+/**
+ * Default hash of `keyed_estimator_map_t`: keys convertible to `std::string_view`, eg `std::string`,
+ * are hashed as string views so that they can be looked up without constructing a key;
+ * other keys use `std::hash`.
+ */
+template <typename Key>
+struct keyed_estimator_hash
+{
+    std::size_t operator()(Key const& key) const { return std::hash<Key>{}(key); }
+};
+
+template <typename Key>
+    requires std::convertible_to<Key const&, std::string_view>
+struct keyed_estimator_hash<Key>
+{
+    using is_transparent = void;
+    std::size_t operator()(std::string_view const key) const { return std::hash<std::string_view>{}(key); }
+};
+
+/**
+ * A hash map from keys to estimators, eg per-client statistics, stored inline in a flat open-addressing table
+ * with linear probing, so that pushing a sample for an existing key touches a single cache line in the common case.
+ * New keys get a copy of the prototype estimator given at construction,
+ * so estimators that need constructor arguments (eg a window size) are supported.
+ * Keys can optionally be evicted after being idle (no pushes) for a given duration:
+ * a CLOCK hand visits a couple of slots every time a new key is inserted and evicts the idle keys it finds,
+ * so that churning keys are reclaimed without any periodic maintenance;
+ * `evict_idle()` can also be called to sweep the whole table at once.
+ *
+ * @tparam  Key             The type of keys; it must be default-constructible.
+ * @tparam  EstimatorType   The type of estimators; it must be copyable.
+ * @tparam  Hash            The hash function; if it has a nested `is_transparent` type, it allows heterogeneous lookup.
+ * @tparam  KeyEqual        The equality of keys; it must support heterogeneous comparisons if `Hash` does.
+ * @tparam  Allocator       The allocator used for the table.
+ */
+template <
+    typename Key,
+    Estimator EstimatorType,
+    typename Hash = keyed_estimator_hash<Key>,
+    typename KeyEqual = std::equal_to<>,
+    typename Allocator = std::allocator<std::pair<Key const, EstimatorType>>
+>
+class keyed_estimator_map_t
+{
+public:
+    using key_type = Key;
+    using estimator_type = EstimatorType;
+    using value_type = typename EstimatorType::value_type;
+    using allocator_type = Allocator;
+    using clock_type = std::chrono::steady_clock;
+
+private:
+    struct slot_t
+    {
+        Key key;
+        EstimatorType estimator;
+        clock_type::time_point last_push;
+        std::uint64_t hash = 0ul;
+        bool used = false;
+    };
+    using slot_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<slot_t>;
+
+    static constexpr std::size_t min_capacity = 16ul;
+    static constexpr std::size_t evict_steps = 2ul; // slots visited by the CLOCK hand on every insertion
+
+    EstimatorType prototype;
+    clock_type::duration timeout;
+    std::vector<slot_t, slot_allocator_t> slots;
+    std::size_t n = 0ul;
+    std::size_t hand = 0ul;
+    int shift = 64;
+
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] KeyEqual equal;
+
+public:
+    /**
+     * Construct an empty map.
+     *
+     * @param   idle_timeout    Keys without pushes for longer than this are evicted; zero disables eviction.
+     * @param   prototype       The estimator copied for every new key.
+     */
+    explicit keyed_estimator_map_t(
+        clock_type::duration const idle_timeout = clock_type::duration::zero(),
+        EstimatorType prototype = {},
+        allocator_type const& alloc = {}
+    )
+        : prototype(std::move(prototype))
+        , timeout(idle_timeout)
+        , slots(slot_allocator_t(alloc))
+    {
+        rehash(min_capacity);
+    }
+
+    /**
+     * Push a new sample into the estimator of the given key, inserting the key if needed.
+     * The key can be of any type supported by `Hash` and `KeyEqual`, eg a `std::string_view` for `std::string` keys;
+     * it is converted to `Key` only when inserted.
+     */
+    template <typename K>
+    void push(K const& key, value_type const x)
+    {
+        push(key, x, timeout == clock_type::duration::zero() ? clock_type::time_point{} : clock_type::now());
+    }
+
+    /**
+     * Same as above but with an explicit timestamp, used to track idle keys.
+     */
+    template <typename K>
+    void push(K const& key, value_type const x, clock_type::time_point const timestamp)
+    {
+        auto& slot = slots[find_or_insert(key, timestamp)];
+        slot.estimator.push(x);
+        slot.last_push = timestamp;
+    }
+
+    /**
+     * Return the estimator of the given key, or `nullptr` if the key is not in the map.
+     */
+    template <typename K>
+    EstimatorType const* find(K const& key) const
+    {
+        auto const i = find_index(key, hash_of(key));
+        return i < slots.size() ? &slots[i].estimator : nullptr;
+    }
+
+    /**
+     * Return true if the given key is in the map; false otherwise.
+     */
+    template <typename K>
+    bool contains(K const& key) const { return find(key) != nullptr; }
+
+    /**
+     * Remove the given key and its estimator; return true if it was in the map.
+     */
+    template <typename K>
+    bool erase(K const& key)
+    {
+        auto const i = find_index(key, hash_of(key));
+        if (i == slots.size())
+            return false;
+        erase_at(i);
+        return true;
+    }
+
+    /**
+     * Evict all keys idle since `now - idle_timeout()` or earlier, and return the number of evicted keys.
+     * This is a no-op if idle eviction is disabled.
+     */
+    std::size_t evict_idle(clock_type::time_point const now)
+    {
+        return sweep(now, slots.size());
+    }
+
+    /**
+     * Call `f(key, estimator)` for every key in the map, in no particular order.
+     * The map must not be modified by `f`.
+     */
+    template <typename F>
+    void for_each(F&& f) const
+    {
+        for (auto const& slot: slots)
+            if (slot.used)
+                f(std::as_const(slot.key), std::as_const(slot.estimator));
+    }
+
+    /**
+     * Remove all keys, keeping the current capacity.
+     */
+    void clear()
+    {
+        for (auto& slot: slots)
+            if (slot.used)
+                release(slot);
+        n = 0ul;
+        hand = 0ul;
+    }
+
+    /**
+     * Make room for at least the given number of keys without growing the table.
+     */
+    void reserve(std::size_t const size)
+    {
+        auto capacity = slots.size();
+        while (size > max_load(capacity))
+            capacity *= 2ul;
+        if (capacity != slots.size())
+            rehash(capacity);
+    }
+
+    /**
+     * Return the number of keys in the map.
+     */
+    std::size_t size() const { return n; }
+
+    /**
+     * Return true if there are no keys in the map; false otherwise.
+     */
+    bool empty() const { return n == 0ul; }
+
+    /**
+     * Return the number of slots in the table.
+     */
+    std::size_t capacity() const { return slots.size(); }
+
+    /**
+     * Return the number of bytes used by this map, including the table and the buffers of all estimators,
+     * eg for capacity planning; this visits every slot, so it costs O(capacity()).
+     */
+    std::size_t memory_usage() const
+    {
+        auto usage = sizeof(*this) + livestats::memory_usage(prototype) - sizeof(EstimatorType);
+        usage += slots.capacity() * sizeof(slot_t);
+        // free slots hold reset copies of the prototype, which may retain their buffers
+        for (auto const& slot: slots)
+            usage += livestats::memory_usage(slot.estimator) - sizeof(EstimatorType);
+        return usage;
+    }
+
+    /**
+     * Return the duration after which keys without pushes are evicted; zero if eviction is disabled.
+     */
+    clock_type::duration idle_timeout() const { return timeout; }
+
+    /**
+     * Change the duration after which keys without pushes are evicted; zero disables eviction.
+     */
+    void set_idle_timeout(clock_type::duration const idle_timeout) { timeout = idle_timeout; }
+
+    /**
+     * Return the allocator used for the table.
+     */
+    allocator_type get_allocator() const { return allocator_type(slots.get_allocator()); }
+
+private:
+    static std::size_t max_load(std::size_t const capacity) { return capacity - capacity / 8ul; }
+
+    template <typename K>
+    std::uint64_t hash_of(K const& key) const
+    {
+        // Fibonacci hashing spreads poor hashes, eg the identity hash of integers, over the table
+        return static_cast<std::uint64_t>(hasher(key)) * 0x9e3779b97f4a7c15ull;
+    }
+
+    std::size_t home(std::uint64_t const hash) const { return static_cast<std::size_t>(hash >> shift); }
+
+    std::size_t next(std::size_t const i) const { return (i + 1ul) & (slots.size() - 1ul); }
+
+    template <typename K>
+    std::size_t find_index(K const& key, std::uint64_t const hash) const
+    {
+        for (auto i = home(hash);; i = next(i))
+        {
+            auto const& slot = slots[i];
+            if (not slot.used)
+                return slots.size();
+            if (slot.hash == hash and equal(slot.key, key))
+                return i;
+        }
+    }
+
+    template <typename K>
+    std::size_t find_or_insert(K const& key, clock_type::time_point const timestamp)
+    {
+        auto const hash = hash_of(key);
+        auto i = home(hash);
+        for (;; i = next(i))
+        {
+            auto const& slot = slots[i];
+            if (not slot.used)
+                break;
+            if (slot.hash == hash and equal(slot.key, key))
+                return i;
+        }
+        if (timeout != clock_type::duration::zero() and sweep(timestamp, evict_steps) > 0ul)
+            i = insertion_index(hash); // the sweep may have shifted slots around
+        if (n + 1ul > max_load(slots.size()))
+        {
+            rehash(slots.size() * 2ul);
+            i = insertion_index(hash);
+        }
+        auto& slot = slots[i];
+        slot.key = Key(key);
+        slot.hash = hash;
+        slot.used = true;
+        slot.last_push = timestamp;
+        ++n;
+        return i;
+    }
+
+    std::size_t insertion_index(std::uint64_t const hash) const
+    {
+        auto i = home(hash);
+        while (slots[i].used)
+            i = next(i);
+        return i;
+    }
+
+    /**
+     * Advance the CLOCK hand over the given number of slots, evicting idle keys.
+     * Evictions do not count as steps, since the hand stays on the slot to visit the key shifted back into it,
+     * so sweeping `slots.size()` slots visits the whole table; every key is evicted at most once,
+     * so the evictions cost O(1) amortized per insertion.
+     */
+    std::size_t sweep(clock_type::time_point const now, std::size_t const steps)
+    {
+        if (timeout == clock_type::duration::zero())
+            return 0ul;
+        std::size_t n_evicted = 0ul;
+        for (std::size_t moved = 0ul; moved < steps and n > 0ul;)
+        {
+            auto const& slot = slots[hand];
+            if (slot.used and now - slot.last_push >= timeout)
+            {
+                // backward shift may move another key into this slot, so visit it again
+                erase_at(hand);
+                ++n_evicted;
+            }
+            else
+            {
+                hand = next(hand);
+                ++moved;
+            }
+        }
+        return n_evicted;
+    }
+
+    /**
+     * Remove the key in the given slot, shifting back the following keys of the same probe sequence
+     * so that no tombstone is needed.
+     */
+    void erase_at(std::size_t i)
+    {
+        for (auto j = next(i); slots[j].used; j = next(j))
+        {
+            // the key in j can move to i only if its home is not cyclically within (i, j]
+            auto const mask = slots.size() - 1ul;
+            if (((j - home(slots[j].hash)) & mask) >= ((j - i) & mask))
+            {
+                std::swap(slots[i], slots[j]);
+                i = j;
+            }
+        }
+        release(slots[i]);
+        --n;
+    }
+
+    void release(slot_t& slot)
+    {
+        slot.key = Key{};
+        slot.estimator.reset();
+        slot.last_push = clock_type::time_point{};
+        slot.hash = 0ul;
+        slot.used = false;
+    }
+
+    /**
+     * Return a free slot, as left by `release()`, holding a reset copy of the prototype.
+     */
+    slot_t free_slot() const
+    {
+        slot_t slot{Key{}, prototype, clock_type::time_point{}, 0ul, false};
+        slot.estimator.reset();
+        return slot;
+    }
+
+    void rehash(std::size_t const capacity)
+    {
+        std::vector<slot_t, slot_allocator_t> old(capacity, free_slot(), slots.get_allocator());
+        old.swap(slots);
+        shift = 64 - std::countr_zero(capacity);
+        hand = 0ul;
+        for (auto& slot: old)
+            if (slot.used)
+                slots[insertion_index(slot.hash)] = std::move(slot);
+    }
+};
+
+namespace pmr {
+
+template <
+    typename Key,
+    Estimator EstimatorType,
+    typename Hash = keyed_estimator_hash<Key>,
+    typename KeyEqual = std::equal_to<>
+>
+using keyed_estimator_map_t = livestats::keyed_estimator_map_t<
+    Key, EstimatorType, Hash, KeyEqual, std::pmr::polymorphic_allocator<std::pair<Key const, EstimatorType>>
+>;
+
+} // namespace pmr
+
+} // namespace livestats
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+namespace livestats::math {
+
+/**
+ * Running means and second co-moments of a sequence of pairs `(x, y)`,
+ * updated with Welford-style formulas when adding or removing one pair, and with the pairwise formula
+ * of Chan et al. when merging two sequences; all operations are O(1).
+ * From them derive the covariance, the correlation and the ordinary least squares fit `y = slope*x + intercept`.
+ * `T` must be a signed type, eg floating point, since co-moments can be negative.
+ */
+template <typename T>
+struct co_moments_t
+{
+    /**
+     * A pair `(x, y)`, to store and pass pairs as a single value.
+     */
+    struct pair_t
+    {
+        T x;
+        T y;
+    };
+
+    std::size_t n = 0ul;
+    T mean_x = T{};
+    T mean_y = T{};
+    T m2_x = T{}; // sum of (x - mean_x)^2
+    T m2_y = T{}; // sum of (y - mean_y)^2
+    T c_xy = T{}; // sum of (x - mean_x)*(y - mean_y)
+
+    std::size_t size() const { return n; }
+
+    void push(pair_t const pair) { push(pair.x, pair.y); }
+
+    void push(T const x, T const y)
+    {
+        ++n;
+        auto const dx = x - mean_x;
+        auto const dy = y - mean_y;
+        mean_x += dx / static_cast<T>(n);
+        mean_y += dy / static_cast<T>(n);
+        m2_x += dx * (x - mean_x);
+        m2_y += dy * (y - mean_y);
+        c_xy += dx * (y - mean_y);
+    }
+
+    void pop(pair_t const pair) { pop(pair.x, pair.y); }
+
+    /**
+     * Remove a pair previously pushed; the sequence must not be empty.
+     */
+    void pop(T const x, T const y)
+    {
+        assert(n > 0ul);
+        if (--n == 0ul)
+        {
+            reset();
+            return;
+        }
+        auto const old_mean_y = mean_y;
+        auto const dx = x - mean_x;
+        auto const dy = y - mean_y;
+        mean_x -= dx / static_cast<T>(n);
+        mean_y -= dy / static_cast<T>(n);
+        m2_x -= dx * (x - mean_x);
+        m2_y -= dy * (y - mean_y);
+        c_xy -= (x - mean_x) * (y - old_mean_y);
+        // rounding errors must not make variances negative
+        if (m2_x < T{})
+            m2_x = T{};
+        if (m2_y < T{})
+            m2_y = T{};
+    }
+
+    void merge(co_moments_t const& other)
+    {
+        if (other.n == 0ul)
+            return;
+        if (n == 0ul)
+        {
+            *this = other;
+            return;
+        }
+        auto const total = n + other.n;
+        auto const dx = other.mean_x - mean_x;
+        auto const dy = other.mean_y - mean_y;
+        auto const weight = static_cast<T>(n) * static_cast<T>(other.n) / static_cast<T>(total);
+        mean_x += dx * static_cast<T>(other.n) / static_cast<T>(total);
+        mean_y += dy * static_cast<T>(other.n) / static_cast<T>(total);
+        m2_x += other.m2_x + dx * dx * weight;
+        m2_y += other.m2_y + dy * dy * weight;
+        c_xy += other.c_xy + dx * dy * weight;
+        n = total;
+    }
+
+    void reset() { *this = co_moments_t{}; }
+
+    T covariance() const { return n ? c_xy / static_cast<T>(n) : T{}; }
+
+    T variance_x() const { return n ? m2_x / static_cast<T>(n) : T{}; }
+
+    T variance_y() const { return n ? m2_y / static_cast<T>(n) : T{}; }
+
+    /**
+     * Pearson correlation coefficient, or 0 if either variance is 0.
+     */
+    T correlation() const
+    {
+        using std::sqrt;
+        auto const denominator = sqrt(m2_x * m2_y);
+        return denominator > T{} ? c_xy / denominator : T{};
+    }
+
+    /**
+     * Slope of the OLS fit of `y` on `x`, eg the beta of `y` relative to `x`, or 0 if the variance of `x` is 0.
+     */
+    T slope() const { return m2_x > T{} ? c_xy / m2_x : T{}; }
+
+    T intercept() const { return mean_y - slope() * mean_x; }
+};
+
+} // namespace livestats::math
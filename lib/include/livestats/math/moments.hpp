@@ -0,0 +1,91 @@
+#pragma once
+
+#include "livestats/math/non_negative.hpp"
+
+#include <cassert>
+#include <cstddef>
+
+namespace livestats::math {
+
+/**
+ * Running count, sum and "unscaled variance" of a sequence of samples, from which derive their mean and variance;
+ * samples can be added, removed oldest first, and whole sequences merged, all in O(1).
+ * Updates go through `non_negative`, so `AccumulatorType` may be unsigned.
+ */
+template <typename ValueType, typename AccumulatorType = ValueType>
+class moments_t
+{
+    std::size_t n = 0ul;
+    AccumulatorType sum = {};
+    AccumulatorType n_s = {};
+
+public:
+    std::size_t size() const { return n; }
+
+    AccumulatorType mean() const { return n > 0ul ? static_cast<AccumulatorType>(sum / n) : AccumulatorType{}; }
+
+    AccumulatorType variance() const { return n > 0ul ? static_cast<AccumulatorType>(n_s / n) : AccumulatorType{}; }
+
+    void push(ValueType const value)
+    {
+        AccumulatorType const x = value;
+        auto const old_mean = mean();
+        ++n;
+        sum += x;
+        auto const new_mean = mean();
+        non_negative::plus_equal_a_minus_b_times_c_minus_d(n_s, x, old_mean, x, new_mean);
+    }
+
+    /**
+     * Remove a sample previously pushed; the sequence must not be empty.
+     */
+    void pop(ValueType const value)
+    {
+        assert(n > 0ul);
+        auto const old_mean = mean();
+        if (--n == 0ul)
+        {
+            reset();
+            return;
+        }
+        AccumulatorType const x = value;
+        sum -= x;
+        auto const new_mean = mean();
+        if (n == 1ul)
+            n_s = AccumulatorType{};
+        else
+            non_negative::minus_equal_a_minus_b_times_c_minus_d(n_s, x, old_mean, x, new_mean);
+    }
+
+    /**
+     * Add all the samples of another sequence, eg more recent samples or those of another shard,
+     * combining the unscaled variances with the pairwise formula of Chan et al.
+     */
+    void merge(moments_t const& other)
+    {
+        if (other.n == 0ul)
+            return;
+        if (n == 0ul)
+        {
+            *this = other;
+            return;
+        }
+        auto const a = mean();
+        auto const b = other.mean();
+        auto const delta = a > b ? a - b : b - a; // also fine for unsigned types
+        auto const total = n + other.n;
+        n_s += other.n_s + delta * delta * static_cast<AccumulatorType>(n) * static_cast<AccumulatorType>(other.n)
+            / static_cast<AccumulatorType>(total);
+        n = total;
+        sum += other.sum;
+    }
+
+    void reset()
+    {
+        n = 0ul;
+        sum = AccumulatorType{};
+        n_s = AccumulatorType{};
+    }
+};
+
+} // namespace livestats::math
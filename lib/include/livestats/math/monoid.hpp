@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <limits>
+
+namespace livestats::math {
+
+/**
+ * A type `value_type` with an associative operation `combine(a, b)` and its identity element `identity()`,
+ * eg max, sum or the merge of two histograms or sketches.
+ * The operation needs neither be commutative nor invertible.
+ */
+template <typename M>
+concept Monoid = requires(M const& monoid, typename M::value_type const& a, typename M::value_type const& b)
+{
+    typename M::value_type;
+    { monoid.identity() } -> std::convertible_to<typename M::value_type>;
+    { monoid.combine(a, b) } -> std::convertible_to<typename M::value_type>;
+};
+
+template <typename T>
+struct sum_monoid_t
+{
+    using value_type = T;
+    T identity() const { return T{}; }
+    T combine(T const a, T const b) const { return a + b; }
+};
+
+template <typename T>
+struct max_monoid_t
+{
+    using value_type = T;
+    T identity() const
+    {
+        return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+    }
+    T combine(T const a, T const b) const { return std::max(a, b); }
+};
+
+template <typename T>
+struct min_monoid_t
+{
+    using value_type = T;
+    T identity() const
+    {
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+    }
+    T combine(T const a, T const b) const { return std::min(a, b); }
+};
+
+} // namespace livestats::math
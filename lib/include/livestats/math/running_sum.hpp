@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+
+namespace livestats::math {
+
+/**
+ * Running count and sum of a sequence of samples, from which derives their mean;
+ * samples can be added, removed oldest first, and whole sequences merged, all in O(1).
+ * It assumes the sum of all samples does not overflow `AccumulatorType`.
+ */
+template <typename ValueType, typename AccumulatorType = ValueType>
+class running_sum_t
+{
+    std::size_t n = 0ul;
+    AccumulatorType sum = {};
+
+public:
+    std::size_t size() const { return n; }
+
+    AccumulatorType mean() const { return n > 0ul ? static_cast<AccumulatorType>(sum / n) : AccumulatorType{}; }
+
+    void push(ValueType const value)
+    {
+        ++n;
+        sum += value;
+    }
+
+    /**
+     * Remove a sample previously pushed; the sequence must not be empty.
+     */
+    void pop(ValueType const value)
+    {
+        assert(n > 0ul);
+        if (--n == 0ul)
+            reset();
+        else
+            sum -= value;
+    }
+
+    /**
+     * Add all the samples of another sequence.
+     */
+    void merge(running_sum_t const& other)
+    {
+        n += other.n;
+        sum += other.sum;
+    }
+
+    void reset()
+    {
+        n = 0ul;
+        sum = AccumulatorType{};
+    }
+};
+
+} // namespace livestats::math
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "livestats/math/monoid.hpp"
+
+#include <boost/circular_buffer.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+namespace livestats::math {
+
+/**
+ * A FIFO queue of monoid values that returns the combination of all values in the queue, in order,
+ * with O(1) worst-case `push_back()`, `pop_front()` and `aggregate()`, and at most a few `combine()` each,
+ * following the De-Amortized Banker's Aggregator (DABA) of Tangwongsan, Hirzel and Schneider.
+ * `push_back()` is O(1) in the worst case only while the queue fits in the preallocated capacity:
+ * beyond it the buffer doubles, copying all values, which is O(1) amortized.
+ * Unlike running sums, values are never subtracted, so it works for non-invertible operations like max,
+ * and does not accumulate rounding errors.
+ *
+ * Like the two-stacks algorithm, the queue is split into a front, whose elements hold the combination from
+ * themselves to the end of the front, and a back, whose elements hold the combination from the beginning
+ * of the back to themselves; the answer is then the combination of the first and last aggregates.
+ * Rather than reversing the back all at once when the front runs out, DABA reverses it incrementally,
+ * one step per operation, starting as soon as the back is as large as the front.
+ *
+ * @tparam  M           The monoid, eg `max_monoid_t<double>`.
+ * @tparam  Allocator   The allocator used for the queue buffer, rebound to the internal element type.
+ */
+template <Monoid M, typename Allocator = std::allocator<typename M::value_type>>
+class sliding_aggregation_t
+{
+public:
+    using value_type = typename M::value_type;
+    using allocator_type = Allocator;
+
+private:
+    struct element_t
+    {
+        value_type value;
+        value_type aggregate;
+    };
+    using element_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<element_t>;
+
+    boost::circular_buffer<element_t, element_allocator_t> elements;
+    [[no_unique_address]] M monoid;
+    // Absolute positions of the boundaries between the sublists of DABA, with f <= l <= r <= a <= b <= end():
+    // [f, l) and [a, b) aggregate up to b, [l, r) up to r, [r, a) from r, [b, end()) from b;
+    // [l, r) and [r, a) are the part of the front being fixed and the part of the old back being reversed.
+    std::size_t f = 0ul;
+    std::size_t l = 0ul;
+    std::size_t r = 0ul;
+    std::size_t a = 0ul;
+    std::size_t b = 0ul;
+
+public:
+    /**
+     * Construct an empty queue, preallocating room for `capacity` values; the buffer grows as needed.
+     */
+    explicit sliding_aggregation_t(std::size_t const capacity = 0ul, M const& m = {}, allocator_type const& alloc = {})
+        : elements(capacity, element_allocator_t(alloc))
+        , monoid(m)
+    { }
+
+    void push_back(value_type const& value)
+    {
+        if (elements.full()) [[unlikely]]
+            elements.set_capacity(std::max(1ul, 2ul * elements.capacity()));
+        auto const e = end();
+        elements.push_back(element_t{value, monoid.combine(b < e ? at(e - 1ul).aggregate : monoid.identity(), value)});
+        fixup();
+    }
+
+    /**
+     * Remove the oldest value, which must exist.
+     */
+    void pop_front()
+    {
+        assert(not empty());
+        elements.pop_front();
+        ++f;
+        l = std::max(l, f);
+        r = std::max(r, f);
+        a = std::max(a, f);
+        b = std::max(b, f);
+        fixup();
+    }
+
+    /**
+     * Return the combination of all values in the queue, from the oldest to the latest.
+     */
+    value_type aggregate() const
+    {
+        auto const e = end();
+        auto const back = b < e ? at(e - 1ul).aggregate : monoid.identity();
+        if (f < l)
+            return monoid.combine(at(f).aggregate, back);
+        // the front is still being fixed: combine its parts
+        auto const reversed = monoid.combine(a > r ? at(a - 1ul).aggregate : monoid.identity(),
+                                             a < b ? at(a).aggregate : monoid.identity());
+        auto const front = monoid.combine(l < r ? at(l).aggregate : monoid.identity(), reversed);
+        return monoid.combine(front, back);
+    }
+
+    value_type const& front() const { return at(f).value; }
+
+    value_type const& back() const { return at(end() - 1ul).value; }
+
+    std::size_t size() const { return elements.size(); }
+
+    bool empty() const { return elements.empty(); }
+
+    std::size_t capacity() const { return elements.capacity(); }
+
+    void clear()
+    {
+        elements.clear();
+        l = r = a = b = f;
+    }
+
+    M const& get_monoid() const { return monoid; }
+
+    allocator_type get_allocator() const { return allocator_type(elements.get_allocator()); }
+
+    /**
+     * Return the number of bytes used by this queue, including the capacity of its buffer.
+     */
+    std::size_t memory_usage() const { return sizeof(*this) + elements.capacity() * sizeof(element_t); }
+
+private:
+    std::size_t end() const { return f + elements.size(); }
+
+    element_t& at(std::size_t const i) { return elements[i - f]; }
+    element_t const& at(std::size_t const i) const { return elements[i - f]; }
+
+    /**
+     * Restore the invariants after each operation, in O(1).
+     * The pending work, ie the size of [l, r) plus [r, a), never exceeds the size of the front minus the size of
+     * the back, which each operation decreases by at most one, so the back is reversed before it overtakes the front.
+     */
+    void fixup()
+    {
+        auto const e = end();
+        if (b - f <= e - b)
+        {
+            assert(l == r and r == a);
+            // the whole front aggregates up to b, and becomes [l, r); the back becomes [r, a)
+            l = f;
+            r = b;
+            a = e;
+            b = e;
+        }
+        if (a > r)
+        {
+            // reverse one element of the old back
+            --a;
+            at(a).aggregate = monoid.combine(at(a).value, a + 1ul < b ? at(a + 1ul).aggregate : monoid.identity());
+        }
+        else if (l < r)
+        {
+            // the old back is reversed, so fix one element of the front
+            at(l).aggregate = monoid.combine(at(l).aggregate, r < b ? at(r).aggregate : monoid.identity());
+            ++l;
+        }
+    }
+};
+
+} // namespace livestats::math
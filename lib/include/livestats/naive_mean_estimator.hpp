@@ -4,6 +4,7 @@
 #include <cstdint>
 
 #include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
 
 namespace livestats {
 
@@ -12,16 +13,18 @@ namespace livestats {
  * This estimator is fast but unsafe in the presence of over/underflows; use only with sanity-checked data.
  * You can use this in combination with `boost::multiprecision::cpp_int` to achieve arbitrary precision.
  *
- * @tparam  ValueType   The type of samples, eg integer, floating point or vectorized numerical type.
+ * @tparam  ValueType       The type of samples, eg integer, floating point or vectorized numerical type.
+ * @tparam  AccumulatorType The type of the running sum, eg `__int128` for `std::uint32_t` samples.
  */
-template <typename ValueType>
+template <typename ValueType, typename AccumulatorType = ValueType>
 class naive_mean_estimator_t
 {
     std::size_t n = 0ul;
-    ValueType sum = ValueType{};
+    AccumulatorType sum = AccumulatorType{};
 
 public:
     using value_type = ValueType;
+    using accumulator_type = AccumulatorType;
 
     /**
      * Update the estimate with a new sample and return the new estimate.
@@ -46,20 +49,59 @@ public:
      */
     void reset()
     {
-        sum = value_type{};
+        sum = accumulator_type{};
         n = 0ul;
     }
 
     /**
      * Return the current value of the mean.
      */
-    value_type get() const { return n ? sum / n : value_type{}; }
+    value_type get() const { return n ? static_cast<value_type>(sum / n) : value_type{}; }
 
     /**
      * Return the total number of samples observed so far.
      */
     std::size_t size() const { return n; }
+
+    /**
+     * Return the number of bytes used by this estimator, which owns no buffer.
+     */
+    std::size_t memory_usage() const { return sizeof(*this); }
+
+    /**
+     * Save the current state to the given stream; see `Serializable`.
+     */
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
+    {
+        serialization::write_header<value_type, accumulator_type>(out, serialization::kind_t::naive_mean);
+        serialization::write(out, n);
+        serialization::write(out, sum);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     */
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
+    {
+        reset();
+        if (not serialization::read_header<value_type, accumulator_type>(in, serialization::kind_t::naive_mean))
+            return;
+        auto const saved_n = serialization::read<std::size_t>(in);
+        auto const saved_sum = serialization::read<accumulator_type>(in);
+        if (in)
+        {
+            n = saved_n;
+            sum = saved_sum;
+        }
+    }
 };
+// explicitly instantiated in livestats_lib for the most common sample types
+extern template class naive_mean_estimator_t<double>;
+extern template class naive_mean_estimator_t<float>;
+extern template class naive_mean_estimator_t<std::int64_t>;
+extern template class naive_mean_estimator_t<std::uint64_t>;
 static_assert(Estimator<naive_mean_estimator_t<double>>);
 
 } // namespace livestats
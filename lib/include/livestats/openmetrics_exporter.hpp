@@ -0,0 +1,49 @@
+#pragma once
+
+#include "livestats/estimator_registry.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace livestats {
+
+/**
+ * Renders the estimators of a registry in the OpenMetrics text format, eg to serve a Prometheus scrape endpoint,
+ * with one gauge family per registry family:
+ *
+ *     # TYPE latency_us gauge
+ *     # HELP latency_us Mean latency of the last 50ms.
+ *     latency_us{venue="xnas"} 12.5
+ *     # EOF
+ *
+ * Each estimator is read via a consistent snapshot, so scraping never blocks nor races with the writers.
+ * The text is rendered into a buffer owned by the exporter and reused by every scrape:
+ * it is sized for the registry on the first scrape, so later scrapes do not allocate.
+ * An exporter must be used by one thread at a time, and its registry must not change while it scrapes.
+ */
+class openmetrics_exporter_t
+{
+    estimator_registry_t const& registry;
+    std::string buffer;
+
+public:
+    /**
+     * The HTTP content type of the rendered text.
+     */
+    static constexpr std::string_view content_type = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+    explicit openmetrics_exporter_t(estimator_registry_t const& registry) : registry(registry) { }
+
+    /**
+     * Render the current value of all estimators and return the text, valid until the next scrape.
+     */
+    std::string_view scrape();
+
+    /**
+     * Return the number of characters the internal buffer can hold without allocating.
+     */
+    std::size_t capacity() const { return buffer.capacity(); }
+};
+
+} // namespace livestats
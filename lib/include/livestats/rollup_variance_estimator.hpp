@@ -0,0 +1,407 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <concepts>
+#include <initializer_list>
+#include <istream>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace livestats {
+
+/**
+ * One level of a `rollup_variance_estimator_t`: the last `n_buckets` buckets of `bucket_size` each,
+ * eg 60 buckets of 1s.
+ */
+struct rollup_level_t
+{
+    std::chrono::steady_clock::duration bucket_size;
+    std::size_t n_buckets;
+};
+
+/**
+ * Estimator to compute the mean and variance over long time windows, eg the last hour or the last day,
+ * in memory proportional to the number of buckets rather than to the number of samples.
+ * Samples are aggregated into the count, sum and "unscaled variance" of fixed-size time buckets,
+ * at several resolutions, eg 60 buckets of 1s, 60 buckets of 1m and 24 buckets of 1h:
+ * each sample goes into the current bucket of the finest level, and each bucket is merged into
+ * the current bucket of the next coarser level as soon as it is complete, so ingestion is O(1) amortized.
+ * Queries are hopping windows over the last completed buckets of a level, eg the last 60 minutes in steps of 1m,
+ * and cost O(number of buckets).
+ * Buckets are aligned to multiples of their size since the epoch of `std::chrono::steady_clock`.
+ *
+ * @tparam  ValueType   The type of samples; it must be floating point.
+ * @tparam  Allocator   The allocator used for the levels and their buckets.
+ */
+template <std::floating_point ValueType, typename Allocator = std::allocator<ValueType>>
+class rollup_variance_estimator_t
+{
+public:
+    using value_type = ValueType;
+    using allocator_type = Allocator;
+
+private:
+    /**
+     * The count, sum and "unscaled variance" of the samples in a bucket.
+     */
+    struct bucket_t
+    {
+        std::size_t n = 0ul;
+        value_type sum = {};
+        value_type n_s = {};
+
+        value_type mean() const { return n > 0ul ? sum / static_cast<value_type>(n) : value_type{}; }
+
+        void push(value_type const x)
+        {
+            auto const old_mean = mean();
+            ++n;
+            sum += x;
+            n_s += (x - old_mean) * (x - mean());
+        }
+
+        /**
+         * Add all the samples of another bucket, with the pairwise formula of Chan et al.
+         */
+        void merge(bucket_t const& other)
+        {
+            if (other.n == 0ul)
+                return;
+            if (n == 0ul)
+            {
+                *this = other;
+                return;
+            }
+            auto const delta = other.mean() - mean();
+            auto const total = n + other.n;
+            n_s += other.n_s
+                + delta * delta * static_cast<value_type>(n) * static_cast<value_type>(other.n)
+                    / static_cast<value_type>(total);
+            sum += other.sum;
+            n = total;
+        }
+    };
+
+    /**
+     * Each level keeps its completed buckets in a ring within the buffer shared by all levels.
+     */
+    struct level_t
+    {
+        std::chrono::steady_clock::duration bucket_size;
+        std::size_t first; // index of the ring in the shared buffer
+        std::size_t n_buckets; // capacity of the ring
+        std::size_t next = 0ul; // index of the next completed bucket in the ring
+        std::size_t n_completed = 0ul;
+        bucket_t current = {};
+        std::chrono::steady_clock::time_point current_begin = {};
+
+        std::chrono::steady_clock::time_point current_end() const { return current_begin + bucket_size; }
+    };
+
+    using bucket_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<bucket_t>;
+    using level_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<level_t>;
+
+    std::vector<level_t, level_allocator_t> cascade; // finest first
+    std::vector<bucket_t, bucket_allocator_t> buckets;
+    bool started = false;
+
+public:
+    /**
+     * Construct an empty estimator with the given levels, finest first.
+     * Throw `std::invalid_argument` unless there is at least one level, every level has at least one bucket,
+     * and the bucket size of every level is a positive multiple of the bucket size of the previous one.
+     */
+    explicit rollup_variance_estimator_t(
+        std::initializer_list<rollup_level_t> const levels,
+        allocator_type const& alloc = {})
+        : cascade(level_allocator_t(alloc))
+        , buckets(bucket_allocator_t(alloc))
+    {
+        if (levels.size() == 0ul)
+            throw std::invalid_argument("rollup_variance_estimator_t: no levels");
+        cascade.reserve(levels.size());
+        for (auto const& level: levels)
+        {
+            if (level.n_buckets == 0ul or level.bucket_size <= std::chrono::steady_clock::duration::zero())
+                throw std::invalid_argument("rollup_variance_estimator_t: empty level");
+            if (not cascade.empty() and level.bucket_size % cascade.back().bucket_size != level.bucket_size.zero())
+                throw std::invalid_argument("rollup_variance_estimator_t: bucket size not a multiple of previous level");
+            auto const first = cascade.empty() ? 0ul : cascade.back().first + cascade.back().n_buckets;
+            cascade.push_back(level_t{level.bucket_size, first, level.n_buckets});
+        }
+        buckets.resize(cascade.back().first + cascade.back().n_buckets);
+    }
+
+    /**
+     * Push a new sample and retrieve the variance over all the completed buckets of the finest level.
+     */
+    value_type add(value_type const value)
+    {
+        push(value);
+        return get();
+    }
+
+    /**
+     * Push a new sample.
+     */
+    void push(value_type const value)
+    {
+        push(value, std::chrono::steady_clock::now());
+    }
+
+    /**
+     * Push a new sample in the bucket of the finest level spanning the given timestamp,
+     * completing all buckets that end before it.
+     * Samples should be pushed in non-decreasing time order;
+     * a sample older than the current bucket of the finest level is counted in that bucket.
+     */
+    void push(value_type const value, std::chrono::steady_clock::time_point const timestamp)
+    {
+        if (not started or timestamp >= cascade.front().current_end()) [[unlikely]]
+            advance(timestamp);
+        cascade.front().current.push(value);
+    }
+
+    /**
+     * Complete all buckets that end before `now`, rolling each of them up into the next coarser level;
+     * time ranges without samples are recorded as empty buckets.
+     * Invocations to this function must happen in non-decreasing time order.
+     */
+    void advance(std::chrono::steady_clock::time_point const now)
+    {
+        if (not started)
+        {
+            for (auto& level: cascade)
+                level.current_begin = align(now, level.bucket_size);
+            started = true;
+            return;
+        }
+        for (std::size_t i = 0ul; i < cascade.size(); ++i)
+            advance(i, now);
+    }
+
+    /**
+     * Discard everything and reset as if just constructed, retaining the levels.
+     */
+    void reset()
+    {
+        for (auto& level: cascade)
+        {
+            level.next = 0ul;
+            level.n_completed = 0ul;
+            level.current = bucket_t{};
+        }
+        started = false;
+    }
+
+    /**
+     * Return the variance over all the completed buckets of the finest level.
+     */
+    value_type get() const { return variance(0ul, cascade.front().n_buckets); }
+
+    /**
+     * Return the number of samples in all the completed buckets of the finest level.
+     */
+    std::size_t size() const { return size(0ul, cascade.front().n_buckets); }
+
+    /**
+     * Return the number of samples in the last `n_buckets` completed buckets of the given level.
+     */
+    std::size_t size(std::size_t const level, std::size_t const n_buckets) const
+    {
+        return rollup(level, n_buckets).n;
+    }
+
+    /**
+     * Return the mean over the last `n_buckets` completed buckets of the given level,
+     * eg `mean(1, 60)` for the last hour with 1m buckets at level 1.
+     */
+    value_type mean(std::size_t const level, std::size_t const n_buckets) const
+    {
+        return rollup(level, n_buckets).mean();
+    }
+
+    /**
+     * Return the variance over the last `n_buckets` completed buckets of the given level.
+     */
+    value_type variance(std::size_t const level, std::size_t const n_buckets) const
+    {
+        auto const total = rollup(level, n_buckets);
+        return total.n > 0ul ? total.n_s / static_cast<value_type>(total.n) : value_type{};
+    }
+
+    /**
+     * Return the number of levels.
+     */
+    std::size_t levels() const { return cascade.size(); }
+
+    /**
+     * Return the size of the buckets of the given level.
+     */
+    std::chrono::steady_clock::duration bucket_size(std::size_t const level) const
+    {
+        return cascade[level].bucket_size;
+    }
+
+    /**
+     * Return the number of completed buckets kept by the given level.
+     */
+    std::size_t bucket_count(std::size_t const level) const { return cascade[level].n_buckets; }
+
+    /**
+     * Return the number of bytes used by this estimator, including all levels and their buckets.
+     */
+    std::size_t memory_usage() const
+    {
+        return sizeof(*this) + cascade.capacity() * sizeof(level_t) + buckets.capacity() * sizeof(bucket_t);
+    }
+
+    /**
+     * Return the allocator used for the levels and their buckets.
+     */
+    allocator_type get_allocator() const { return allocator_type(cascade.get_allocator()); }
+
+    /**
+     * Save the current state, including the current and completed buckets of all levels, to the given stream;
+     * see `Serializable`.
+     */
+    void save(std::ostream& out) const
+    {
+        using namespace serialization;
+        write_header<value_type>(out, kind_t::rollup_variance);
+        write(out, cascade.size());
+        for (auto const& level: cascade)
+        {
+            write(out, level.bucket_size);
+            write(out, level.n_buckets);
+        }
+        write(out, started);
+        for (auto const& level: cascade)
+        {
+            write(out, level.next);
+            write(out, level.n_completed);
+            write(out, level.current);
+            write(out, level.current_begin);
+        }
+        for (auto const& bucket: buckets)
+            write(out, bucket);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved levels must match the levels of this estimator.
+     */
+    void load(std::istream& in)
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type>(in, kind_t::rollup_variance))
+            return;
+        if (read<std::size_t>(in) != cascade.size())
+            return fail(in);
+        for (auto const& level: cascade)
+        {
+            auto const bucket_size = read<std::chrono::steady_clock::duration>(in);
+            auto const n_buckets = read<std::size_t>(in);
+            if (not in or bucket_size != level.bucket_size or n_buckets != level.n_buckets)
+                return fail(in);
+        }
+        started = read<bool>(in);
+        for (auto& level: cascade)
+        {
+            level.next = read<std::size_t>(in);
+            level.n_completed = read<std::size_t>(in);
+            level.current = read<bucket_t>(in);
+            level.current_begin = read<std::chrono::steady_clock::time_point>(in);
+            if (level.next >= level.n_buckets or level.n_completed > level.n_buckets)
+                fail(in);
+        }
+        for (auto& bucket: buckets)
+            bucket = read<bucket_t>(in);
+        if (not in)
+        {
+            reset();
+            fail(in);
+        }
+    }
+
+private:
+    static std::chrono::steady_clock::time_point align(
+        std::chrono::steady_clock::time_point const t,
+        std::chrono::steady_clock::duration const bucket_size)
+    {
+        return std::chrono::steady_clock::time_point(t.time_since_epoch() / bucket_size * bucket_size);
+    }
+
+    /**
+     * Complete the buckets of level `i` that end before `now`.
+     */
+    void advance(std::size_t const i, std::chrono::steady_clock::time_point const now)
+    {
+        auto& level = cascade[i];
+        if (now < level.current_end())
+            return;
+        auto const completed = level.current;
+        auto const completed_begin = level.current_begin;
+        complete(level, completed);
+        level.current = bucket_t{};
+        level.current_begin = level.current_end();
+        // fill the gap with empty buckets, at most a whole level of them
+        auto const n_empty = (now - level.current_begin) / level.bucket_size;
+        for (std::size_t k = 0ul; k < std::min(static_cast<std::size_t>(n_empty), level.n_buckets); ++k)
+            complete(level, bucket_t{});
+        level.current_begin += n_empty * level.bucket_size;
+        if (i + 1ul < cascade.size() and completed.n > 0ul)
+        {
+            // the coarser bucket spanning the completed one may not be the current one anymore
+            advance(i + 1ul, completed_begin);
+            cascade[i + 1ul].current.merge(completed);
+        }
+    }
+
+    /**
+     * Append a completed bucket to the ring of the given level, overwriting the oldest one if full.
+     */
+    void complete(level_t& level, bucket_t const& bucket)
+    {
+        buckets[level.first + level.next] = bucket;
+        level.next = level.next + 1ul == level.n_buckets ? 0ul : level.next + 1ul;
+        level.n_completed = std::min(level.n_completed + 1ul, level.n_buckets);
+    }
+
+    /**
+     * Merge the last `n_buckets` completed buckets of the given level.
+     */
+    bucket_t rollup(std::size_t const i, std::size_t const n_buckets) const
+    {
+        assert(i < cascade.size());
+        auto const& level = cascade[i];
+        bucket_t total;
+        auto const n = std::min(n_buckets, level.n_completed);
+        for (std::size_t k = 1ul; k <= n; ++k)
+            total.merge(buckets[level.first + (level.next + level.n_buckets - k) % level.n_buckets]);
+        return total;
+    }
+};
+// explicitly instantiated in livestats_lib for the most common sample types
+extern template class rollup_variance_estimator_t<double>;
+extern template class rollup_variance_estimator_t<float>;
+static_assert(Estimator<rollup_variance_estimator_t<double>>);
+
+namespace pmr {
+
+template <typename ValueType>
+using rollup_variance_estimator_t =
+    livestats::rollup_variance_estimator_t<ValueType, std::pmr::polymorphic_allocator<ValueType>>;
+
+} // namespace pmr
+
+} // namespace livestats
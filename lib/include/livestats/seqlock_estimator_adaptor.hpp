@@ -0,0 +1,145 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace livestats {
+
+/**
+ * An estimator adaptor that lets other threads, or other processes if placed in shared memory,
+ * take consistent snapshots of the underlying estimator without ever blocking the writer.
+ * There must be a single writer, which uses the usual estimator interface;
+ * readers call `snapshot()`, which retries until it copies the estimator while no update was in progress,
+ * or `try_snapshot()`, which gives up after a bounded number of attempts, eg if the writer process died mid-update.
+ *
+ * @tparam  EstimatorType   The underlying estimator being adapted; it must be trivially copyable,
+ *                          eg welford or static sliding (time) window estimators over primitive types.
+ */
+template <Estimator EstimatorType>
+requires std::is_trivially_copyable_v<EstimatorType>
+class seqlock_estimator_adaptor_t
+{
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "required to share the sequence across processes");
+
+    std::atomic<std::uint64_t> sequence = 0ul; // odd while an update is in progress
+    EstimatorType estimator;
+
+public:
+    using value_type = typename EstimatorType::value_type;
+
+    seqlock_estimator_adaptor_t() = default;
+
+    /**
+     * Construct the underlying estimator from the given arguments.
+     */
+    template <typename... Args>
+    explicit seqlock_estimator_adaptor_t(std::in_place_t, Args&&... args) : estimator(std::forward<Args>(args)...) { }
+
+    /**
+     * Update the underlying estimator with a new sample and return the new estimate.
+     */
+    value_type add(value_type const x)
+    {
+        push(x);
+        return get();
+    }
+
+    /**
+     * Update the underlying estimator with a new sample.
+     */
+    void push(value_type const x)
+    {
+        update([&] (EstimatorType& e) { e.push(x); });
+    }
+
+    /**
+     * Discard everything and reset as if default-constructed.
+     */
+    void reset()
+    {
+        update([] (EstimatorType& e) { e.reset(); });
+    }
+
+    /**
+     * Return the current estimate; only the writer can call this method.
+     */
+    value_type get() const { return estimator.get(); }
+
+    /**
+     * Return the number of samples in the underlying estimator; only the writer can call this method.
+     */
+    std::size_t size() const { return estimator.size(); }
+
+    /**
+     * Return the number of bytes used by this adaptor; trivially copyable estimators own no buffer.
+     */
+    std::size_t memory_usage() const { return sizeof(*this); }
+
+    /**
+     * Apply an arbitrary update to the underlying estimator, eg to call methods not exposed by this adaptor.
+     */
+    template <typename F>
+    void update(F&& f)
+    {
+        auto const seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1ul, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        f(estimator);
+        sequence.store(seq + 2ul, std::memory_order_release);
+    }
+
+    /**
+     * Default number of attempts of `try_snapshot()`: updates take nanoseconds,
+     * so this only runs out if the writer stopped in the middle of an update, after a few milliseconds.
+     */
+    static constexpr std::size_t default_max_attempts = 100'000ul;
+
+    /**
+     * Return a consistent copy of the underlying estimator; any thread or process can call this method.
+     * It never returns if the writer stopped in the middle of an update, eg if the writer process died:
+     * readers in other processes should use `try_snapshot()`.
+     */
+    EstimatorType snapshot() const
+    {
+        while (true)
+            if (auto const copy = try_snapshot())
+                return *copy;
+    }
+
+    /**
+     * Return a consistent copy of the underlying estimator, or an empty optional if none could be taken in
+     * `max_attempts` attempts because an update was always in progress; any thread or process can call this method.
+     * After a few attempts, it yields to other threads between attempts.
+     */
+    std::optional<EstimatorType> try_snapshot(std::size_t const max_attempts = default_max_attempts) const
+    {
+        constexpr std::size_t spin_attempts = 64ul;
+        std::array<std::byte, sizeof(EstimatorType)> copy;
+        for (std::size_t attempt = 0ul; attempt < max_attempts; ++attempt)
+        {
+            auto const seq = sequence.load(std::memory_order_acquire);
+            if (seq % 2ul == 0ul)
+            {
+                std::memcpy(copy.data(), &estimator, sizeof(EstimatorType));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == seq)
+                    return std::bit_cast<EstimatorType>(copy);
+            }
+            if (attempt >= spin_attempts)
+                std::this_thread::yield();
+        }
+        return std::nullopt;
+    }
+};
+static_assert(Estimator<seqlock_estimator_adaptor_t<estimator_archetype_t>>);
+
+} // namespace livestats
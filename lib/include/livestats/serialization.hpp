@@ -0,0 +1,129 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+namespace livestats {
+
+/**
+ * An estimator whose state can be checkpointed via `save()` and restored via `load()`.
+ * The binary format is versioned but uses the native byte order and type sizes,
+ * so it is meant to restore state across restarts of the same program on the same host.
+ * Time-based estimators save `std::chrono::steady_clock` timestamps,
+ * which are only meaningful until the host reboots.
+ * If the saved state is incompatible with the estimator, `load()` sets `failbit` on the stream
+ * and leaves the estimator reset.
+ */
+template <typename T>
+concept Serializable = requires(T estimator, T const& const_estimator, std::ostream& out, std::istream& in)
+{
+    { const_estimator.save(out) };
+    { estimator.load(in) };
+};
+
+namespace serialization {
+
+/**
+ * Version of the binary format; bump it whenever the layout saved by any estimator changes.
+ * - 2: the z-score outlier adaptor no longer saves a separate mean
+ *   when its variance estimator tracks one.
+ * - 3: time window sizes are saved in nanoseconds rather than milliseconds.
+ * - 4: the time window covariance estimator also saves its high watermark,
+ *   and time window estimators save the aggregate of each window as laid out in memory.
+ */
+inline constexpr std::uint16_t version = 4;
+
+/**
+ * Identifies the kind of estimator that saved some state.
+ */
+enum class kind_t : std::uint16_t
+{
+    naive_mean = 1,
+    welford_mean,
+    welford_variance,
+    sliding_window_mean,
+    sliding_window_variance,
+    static_sliding_window_mean,
+    static_sliding_window_variance,
+    sliding_time_window_mean,
+    sliding_time_window_variance,
+    zscore_outlier_adaptor,
+    sliding_window_median,
+    hampel_outlier_adaptor,
+    welford_covariance,
+    sliding_window_covariance,
+    sliding_time_window_covariance,
+    welford_covariance_matrix,
+    rollup_variance,
+    hyperloglog,
+    sliding_time_window_hyperloglog,
+    sliding_time_window_rate,
+    static_sliding_time_window_variance,
+};
+
+/**
+ * Precedes the state of each estimator.
+ */
+struct header_t
+{
+    kind_t kind;
+    std::uint16_t version;
+    std::uint16_t value_size;
+    std::uint16_t accumulator_size;
+};
+
+template <typename T>
+concept Trivial = std::is_trivially_copyable_v<T> and std::is_default_constructible_v<T>;
+
+template <Trivial T>
+void write(std::ostream& out, T const& x)
+{
+    out.write(reinterpret_cast<char const*>(&x), sizeof(T));
+}
+
+template <Trivial T>
+T read(std::istream& in)
+{
+    T x{};
+    in.read(reinterpret_cast<char*>(&x), sizeof(T));
+    return x;
+}
+
+template <typename ValueType, typename AccumulatorType = ValueType>
+void write_header(std::ostream& out, kind_t const kind)
+{
+    auto const value_size = static_cast<std::uint16_t>(sizeof(ValueType));
+    auto const accumulator_size = static_cast<std::uint16_t>(sizeof(AccumulatorType));
+    write(out, header_t{kind, version, value_size, accumulator_size});
+}
+
+/**
+ * Read a header and check that it was written by the same kind of estimator, with the same types and format.
+ * Return false, and set `failbit` on the stream, if it was not.
+ */
+template <typename ValueType, typename AccumulatorType = ValueType>
+bool read_header(std::istream& in, kind_t const kind)
+{
+    auto const header = read<header_t>(in);
+    if (in and header.kind == kind and header.version == version
+        and header.value_size == sizeof(ValueType) and header.accumulator_size == sizeof(AccumulatorType))
+    {
+        return true;
+    }
+    in.setstate(std::ios::failbit);
+    return false;
+}
+
+/**
+ * Set `failbit` on the stream; useful when some saved state does not match the estimator configuration.
+ */
+inline void fail(std::istream& in)
+{
+    in.setstate(std::ios::failbit);
+}
+
+} // namespace serialization
+} // namespace livestats
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "livestats/seqlock_estimator_adaptor.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace livestats {
+
+namespace shared_memory {
+
+inline constexpr std::size_t max_name_size = 63ul;
+
+/**
+ * Layout of the beginning of a shared memory segment, followed by `max_entries` entries and then the estimators.
+ * All positions are offsets from the beginning of the segment, so each process can map it at any address.
+ */
+struct segment_header_t
+{
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t max_entries;
+    std::uint64_t size; // in bytes, including this header
+    std::uint64_t used; // in bytes, only accessed by the writer
+    std::atomic<std::uint32_t> n_entries; // incremented once the last entry is fully constructed
+};
+
+/**
+ * Describes one named estimator in the shared memory segment.
+ */
+struct segment_entry_t
+{
+    char name[max_name_size + 1ul]; // null-terminated
+    std::uint64_t type_hash; // identifies the type of the estimator across processes, see `type_hash()`
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+/**
+ * Return a hash of the (ABI-specific, but process-independent) name of the given type.
+ */
+std::uint64_t type_hash(std::type_info const&);
+
+} // namespace shared_memory
+
+/**
+ * A POSIX shared memory segment in which a single writer process places named estimators,
+ * so that other processes can read them via `shared_memory_segment_reader_t` without any IPC or locking.
+ * Estimators are wrapped in `seqlock_estimator_adaptor_t`, so they must be trivially copyable;
+ * estimators that own a heap-allocated buffer, like the sliding time window ones, cannot be shared,
+ * but `static_sliding_time_window_variance_estimator_t` can.
+ */
+class shared_memory_segment_t
+{
+    std::string name;
+    std::byte* base = nullptr;
+    std::size_t size = 0ul;
+
+public:
+    /**
+     * Create the shared memory object `name`, eg "/livestats", replacing any existing one with the same name.
+     * The segment is `size` bytes in total and can contain at most `max_entries` estimators.
+     * Throw `std::system_error` if the segment cannot be created.
+     */
+    shared_memory_segment_t(std::string name, std::size_t size, std::size_t max_entries = 1024ul);
+
+    /**
+     * Unmap and remove the shared memory object; readers that are still attached keep their mapping.
+     */
+    ~shared_memory_segment_t();
+
+    shared_memory_segment_t(shared_memory_segment_t const&) = delete;
+    shared_memory_segment_t& operator=(shared_memory_segment_t const&) = delete;
+
+    /**
+     * Construct a new estimator in the segment from the given arguments and publish it under the given name.
+     * Throw `std::length_error` if the name is too long and `std::bad_alloc` if the segment is full.
+     */
+    template <typename EstimatorType, typename... Args>
+    seqlock_estimator_adaptor_t<EstimatorType>& emplace(std::string_view const name, Args&&... args)
+    {
+        using adaptor_t = seqlock_estimator_adaptor_t<EstimatorType>;
+        void* const p = allocate(name, shared_memory::type_hash(typeid(adaptor_t)), sizeof(adaptor_t), alignof(adaptor_t));
+        auto* const estimator = ::new (p) adaptor_t(std::in_place, std::forward<Args>(args)...);
+        publish();
+        return *estimator;
+    }
+
+private:
+    void* allocate(std::string_view name, std::uint64_t type_hash, std::size_t size, std::size_t alignment);
+    void publish();
+};
+
+/**
+ * Attaches read-only to a segment created by `shared_memory_segment_t`, possibly from another process.
+ * The segment is writable by another process, so everything read from it is checked against the bounds
+ * of the mapping: a stale or corrupt segment yields missing estimators, never out-of-bounds reads.
+ */
+class shared_memory_segment_reader_t
+{
+    std::byte const* base = nullptr;
+    std::size_t size = 0ul;
+    std::size_t max_entries = 0ul; // as validated when attaching
+
+public:
+    /**
+     * Attach to the shared memory object `name`.
+     * Throw `std::system_error` if it cannot be mapped or `std::runtime_error` if it is not a livestats segment.
+     */
+    explicit shared_memory_segment_reader_t(std::string const& name);
+
+    ~shared_memory_segment_reader_t();
+
+    shared_memory_segment_reader_t(shared_memory_segment_reader_t const&) = delete;
+    shared_memory_segment_reader_t& operator=(shared_memory_segment_reader_t const&) = delete;
+
+    /**
+     * Return the names of all estimators published so far, in order of publication.
+     */
+    std::vector<std::string_view> names() const;
+
+    /**
+     * Return a consistent copy of the estimator published under the given name,
+     * or an empty optional if there is no such estimator, it was published with a different type,
+     * or no consistent copy could be taken, eg because the writer process died in the middle of an update;
+     * see `seqlock_estimator_adaptor_t::try_snapshot()`.
+     */
+    template <typename EstimatorType>
+    std::optional<EstimatorType> snapshot(std::string_view const name) const
+    {
+        using adaptor_t = seqlock_estimator_adaptor_t<EstimatorType>;
+        auto const* const entry = find(name);
+        if (not entry or entry->type_hash != shared_memory::type_hash(typeid(adaptor_t))
+            or entry->size != sizeof(adaptor_t) or entry->offset % alignof(adaptor_t) != 0ul
+            or entry->offset > size or size - entry->offset < entry->size)
+        {
+            return std::nullopt;
+        }
+        return reinterpret_cast<adaptor_t const*>(base + entry->offset)->try_snapshot();
+    }
+
+private:
+    shared_memory::segment_entry_t const* find(std::string_view name) const;
+
+    /**
+     * Return the published entries, or none if the number of entries is corrupt.
+     */
+    std::span<shared_memory::segment_entry_t const> entries() const;
+};
+
+} // namespace livestats
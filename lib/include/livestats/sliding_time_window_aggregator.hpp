@@ -0,0 +1,197 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+#include "livestats/sliding_time_window_overflow_policy.hpp"
+#include "livestats/sliding_time_window_tags.hpp"
+
+#include "livestats/math/monoid.hpp"
+#include "livestats/math/sliding_aggregation.hpp"
+
+#include <boost/circular_buffer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <memory_resource>
+
+namespace livestats {
+
+/**
+ * Estimator to combine the samples of a sliding time window with any associative operation, eg their maximum,
+ * or the merge of per-sample histograms or sketches.
+ * Like `sliding_window_aggregator_t`, it never subtracts the samples leaving the window,
+ * and every update costs O(1) per sample pushed or evicted, see `math::sliding_aggregation_t`;
+ * that is the worst case only while the window fits in the preallocated capacity, or with
+ * `sliding_time_window_overflow_policy::drop_oldest`, otherwise growing the buffers costs O(N) once in a while.
+ *
+ * @tparam  Monoid          The operation and its identity, eg `math::max_monoid_t<double>`.
+ * @tparam  Window          The size of the sliding window, in milliseconds or as a duration, eg `250us`.
+ * @tparam  Allocator       The allocator used for the buffers of samples and timestamps.
+ */
+template <
+    math::Monoid Monoid,
+    sliding_time_window_size_t Window,
+    typename Allocator = std::allocator<typename Monoid::value_type>
+>
+class sliding_time_window_aggregator_t
+{
+public:
+    using value_type = typename Monoid::value_type;
+    using allocator_type = Allocator;
+
+private:
+    static constexpr auto window_size = Window.duration();
+
+    using timestamp_allocator_t =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<std::chrono::steady_clock::time_point>;
+
+    math::sliding_aggregation_t<Monoid, Allocator> window;
+    // `timestamps[i]` is the timestamp of the i-th oldest sample in the window
+    boost::circular_buffer<std::chrono::steady_clock::time_point, timestamp_allocator_t> timestamps;
+    sliding_time_window_overflow_policy overflow_policy = sliding_time_window_overflow_policy::grow;
+    std::size_t n_dropped = 0ul;
+
+public:
+    /**
+     * Construct an empty estimator whose buffers are preallocated to hold `capacity` samples; they grow as needed.
+     */
+    explicit sliding_time_window_aggregator_t(
+        std::size_t const capacity = 0ul,
+        Monoid const& monoid = {},
+        allocator_type const& alloc = {})
+        : window(capacity, monoid, alloc)
+        , timestamps(capacity, timestamp_allocator_t(alloc))
+    { }
+
+    /**
+     * Construct an empty estimator whose buffers are preallocated to hold `capacity` samples.
+     * Beyond that, the buffers either grow or drop the oldest samples early, depending on `policy`;
+     * if `capacity` is 0 the buffers always grow.
+     */
+    sliding_time_window_aggregator_t(
+        std::size_t const capacity,
+        sliding_time_window_overflow_policy const policy,
+        Monoid const& monoid = {},
+        allocator_type const& alloc = {})
+        : window(capacity, monoid, alloc)
+        , timestamps(capacity, timestamp_allocator_t(alloc))
+        , overflow_policy(policy)
+    { }
+
+    /**
+     * Push a new sample in the sliding window and retrieve the new aggregate.
+     */
+    value_type add(value_type const& sample)
+    {
+        push(sample);
+        return get();
+    }
+
+    /**
+     * Push a new sample in the sliding window.
+     */
+    void push(value_type const& sample)
+    {
+        push(sample, std::chrono::steady_clock::now());
+    }
+
+    /**
+     * Push a new sample in the sliding window and advance it to the given timestamp.
+     * Samples must be pushed in non-decreasing time order; older samples are discarded.
+     */
+    void push(value_type const& sample, std::chrono::steady_clock::time_point const timestamp)
+    {
+        if (not timestamps.empty() and timestamp < timestamps.back())
+            return;
+        if (timestamps.full()) [[unlikely]]
+        {
+            if (overflow_policy == sliding_time_window_overflow_policy::grow or timestamps.capacity() == 0ul)
+                timestamps.set_capacity(std::max(1ul, 2ul * timestamps.capacity()));
+            else
+            {
+                timestamps.pop_front();
+                window.pop_front();
+                ++n_dropped;
+            }
+        }
+        timestamps.push_back(timestamp);
+        window.push_back(sample);
+        advance(timestamp);
+    }
+
+    /**
+     * Update the sliding window by discarding samples older than `now` minus the window size.
+     * Invocations to this function must happen in non-decreasing time order.
+     */
+    void advance(std::chrono::steady_clock::time_point const now)
+    {
+        while (not timestamps.empty() and timestamps.front() < now - window_size)
+        {
+            timestamps.pop_front();
+            window.pop_front();
+        }
+    }
+
+    /**
+     * Discard everything and reset as if just constructed, retaining the capacity of the buffers.
+     */
+    void reset()
+    {
+        window.clear();
+        timestamps.clear();
+        n_dropped = 0ul;
+    }
+
+    /**
+     * Return the combination of all samples in the window, from the oldest to the latest, in O(1).
+     */
+    value_type get() const { return window.aggregate(); }
+
+    /**
+     * Return the total number of samples currently in the window.
+     */
+    std::size_t size() const { return window.size(); }
+
+    /**
+     * Return the number of samples dropped early because the buffers were full.
+     * This is always zero with `sliding_time_window_overflow_policy::grow`.
+     */
+    std::size_t size_dropped() const { return n_dropped; }
+
+    /**
+     * Return the earliest time at which `advance()` will discard some sample,
+     * or `std::chrono::steady_clock::time_point::max()` if the window is empty.
+     */
+    std::chrono::steady_clock::time_point next_expiry() const
+    {
+        if (timestamps.empty())
+            return std::chrono::steady_clock::time_point::max();
+        // samples are discarded once strictly older than the beginning of the window
+        return timestamps.front() + window_size + std::chrono::steady_clock::duration(1);
+    }
+
+    /**
+     * Return the number of bytes used by this estimator, including the capacity of the buffers.
+     */
+    std::size_t memory_usage() const
+    {
+        return sizeof(*this) - sizeof(window) + window.memory_usage()
+            + timestamps.capacity() * sizeof(std::chrono::steady_clock::time_point);
+    }
+
+    /**
+     * Return the allocator used for the buffers.
+     */
+    allocator_type get_allocator() const { return window.get_allocator(); }
+};
+static_assert(Estimator<sliding_time_window_aggregator_t<math::max_monoid_t<double>, 1ul>>);
+
+namespace pmr {
+
+template <math::Monoid Monoid, sliding_time_window_size_t Window>
+using sliding_time_window_aggregator_t = livestats::sliding_time_window_aggregator_t<
+    Monoid, Window, std::pmr::polymorphic_allocator<typename Monoid::value_type>>;
+
+} // namespace pmr
+
+} // namespace livestats
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+#include "livestats/instrumentation.hpp"
+#include "livestats/serialization.hpp"
+#include "livestats/sliding_time_window_sample_buffer.hpp"
+#include "livestats/sliding_time_window_tags.hpp"
+
+#include "livestats/math/co_moments.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace livestats {
+
+/**
+ * Estimator to compute the covariance of two sequences observed as pairs `(x, y)` over one or more sliding time windows,
+ * along with the correlation and the ordinary least squares regression of `y` on `x` in each window.
+ * Pairs are stored together in a single buffer shared by all windows.
+ *
+ * @tparam  ValueType       The type of samples; it must be signed, eg floating point.
+ * @tparam  Allocator       The allocator used for the sample buffer, rebound to the internal sample type.
+ * @tparam  Instrumentation The instrumentation policy notified on the hot path, eg `counting_instrumentation_t`;
+ *                          `no_instrumentation_t` costs nothing.
+ * @tparam  Window1         The size of the primary sliding window, in milliseconds or as a duration, eg `250us`.
+ * @tparam  WindowN         The size of secondary sliding windows.
+ */
+template <
+    typename ValueType,
+    typename Allocator,
+    typename Instrumentation,
+    sliding_time_window_size_t Window1,
+    sliding_time_window_size_t... WindowN
+>
+class basic_sliding_time_window_covariance_estimator_t
+    : public sliding_time_window_sample_buffer_t<
+        typename math::co_moments_t<ValueType>::pair_t, math::co_moments_t<ValueType>,
+        Allocator, Instrumentation, Window1, WindowN...>
+{
+    using base_t = sliding_time_window_sample_buffer_t<
+        typename math::co_moments_t<ValueType>::pair_t, math::co_moments_t<ValueType>,
+        Allocator, Instrumentation, Window1, WindowN...>;
+    using pair_t = typename math::co_moments_t<ValueType>::pair_t;
+
+    using base_t::primary_window;
+    using base_t::window;
+
+public:
+    using value_type = ValueType;
+    using allocator_type = Allocator;
+
+    using base_t::base_t;
+
+    /**
+     * Push a new pair in all sliding windows and retrieve the new covariance of the primary window.
+     */
+    value_type add(value_type const x, value_type const y)
+    {
+        push(x, y);
+        return get();
+    }
+
+    /**
+     * Push a new pair in all sliding windows.
+     */
+    void push(value_type const x, value_type const y)
+    {
+        push(x, y, std::chrono::steady_clock::now());
+    }
+
+    /**
+     * Push a new pair in all sliding windows and advance them all to the given timestamp;
+     * late pairs are handled as late samples by `sliding_time_window_sample_buffer_t::push()`.
+     */
+    void push(value_type const x, value_type const y, std::chrono::steady_clock::time_point const timestamp)
+    {
+        base_t::push(pair_t{x, y}, timestamp);
+    }
+
+    /**
+     * Push a batch of pairs in all sliding windows and advance them all to the latest timestamp,
+     * same as pushing each pair in turn with `push(x, y, timestamp)`, but faster:
+     * each run of in-order pairs is appended to the buffer and merged into the windows as a single block,
+     * and expired pairs are evicted once at the end of the run.
+     * `timestamps`, `xs` and `ys` must have the same size.
+     */
+    void push_range(
+        std::span<std::chrono::steady_clock::time_point const> const timestamps,
+        std::span<value_type const> const xs,
+        std::span<value_type const> const ys)
+    {
+        assert(timestamps.size() == xs.size() and timestamps.size() == ys.size());
+        base_t::push_range(
+            std::views::iota(0ul, std::min({timestamps.size(), xs.size(), ys.size()})),
+            [&] (std::size_t const i) { return timestamps[i]; },
+            [&] (std::size_t const i) { return pair_t{xs[i], ys[i]}; });
+    }
+
+    /**
+     * Push a batch of records in all sliding windows, as `push_range(timestamps, xs, ys)`,
+     * projecting the timestamp and the pair out of each record, eg via pointers to data members
+     * like `&quote_t::timestamp`, `&quote_t::bid` and `&quote_t::ask`, so that records need not be copied beforehand.
+     */
+    template <std::ranges::input_range Range, typename TimestampProjection, typename XProjection, typename YProjection>
+        requires std::convertible_to<
+                std::invoke_result_t<TimestampProjection&, std::ranges::range_reference_t<Range>>,
+                std::chrono::steady_clock::time_point>
+            and std::convertible_to<std::invoke_result_t<XProjection&, std::ranges::range_reference_t<Range>>, value_type>
+            and std::convertible_to<std::invoke_result_t<YProjection&, std::ranges::range_reference_t<Range>>, value_type>
+    void push_range(Range&& records, TimestampProjection timestamp_of, XProjection x_of, YProjection y_of)
+    {
+        auto const pair_of = [&] (auto const& record) {
+            return pair_t{
+                static_cast<value_type>(std::invoke(x_of, record)),
+                static_cast<value_type>(std::invoke(y_of, record))};
+        };
+        base_t::push_range(std::forward<Range>(records), std::move(timestamp_of), pair_of);
+    }
+
+    /**
+     * Return the current value of the covariance of the primary window.
+     */
+    value_type get() const { return get(primary_window); }
+
+    /**
+     * Return the covariance of the given time window.
+     */
+    template <sliding_time_window_size_t Window>
+    value_type get(sliding_time_window_tag_t<Window> const w) const { return window(w).covariance(); }
+
+    /**
+     * Return the covariance of the primary window, same as `get()`.
+     */
+    value_type covariance() const { return get(primary_window); }
+
+    /**
+     * Return the covariance of the given time window, same as `get(w)`.
+     */
+    template <sliding_time_window_size_t Window>
+    value_type covariance(sliding_time_window_tag_t<Window> const w) const { return window(w).covariance(); }
+
+    /**
+     * Return the Pearson correlation coefficient of the primary window, or 0 if either series has no variance.
+     */
+    value_type correlation() const { return correlation(primary_window); }
+
+    /**
+     * Return the Pearson correlation coefficient of the given time window, or 0 if either series has no variance.
+     */
+    template <sliding_time_window_size_t Window>
+    value_type correlation(sliding_time_window_tag_t<Window> const w) const { return window(w).correlation(); }
+
+    /**
+     * Return the slope of the least squares fit `y = slope*x + intercept` over the primary window.
+     */
+    value_type slope() const { return slope(primary_window); }
+
+    /**
+     * Return the slope of the least squares fit `y = slope*x + intercept` over the given time window.
+     */
+    template <sliding_time_window_size_t Window>
+    value_type slope(sliding_time_window_tag_t<Window> const w) const { return window(w).slope(); }
+
+    /**
+     * Return the intercept of the least squares fit `y = slope*x + intercept` over the primary window.
+     */
+    value_type intercept() const { return intercept(primary_window); }
+
+    /**
+     * Return the intercept of the least squares fit `y = slope*x + intercept` over the given time window.
+     */
+    template <sliding_time_window_size_t Window>
+    value_type intercept(sliding_time_window_tag_t<Window> const w) const { return window(w).intercept(); }
+
+    value_type mean_x() const { return mean_x(primary_window); }
+    value_type mean_y() const { return mean_y(primary_window); }
+
+    template <sliding_time_window_size_t Window>
+    value_type mean_x(sliding_time_window_tag_t<Window> const w) const { return window(w).mean_x; }
+
+    template <sliding_time_window_size_t Window>
+    value_type mean_y(sliding_time_window_tag_t<Window> const w) const { return window(w).mean_y; }
+
+    /**
+     * Save the current state, including all pairs in the internal buffer, to the given stream;
+     * see `Serializable`.
+     */
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type>
+    {
+        serialization::write_header<value_type>(out, serialization::kind_t::sliding_time_window_covariance);
+        this->save_samples(out);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved window sizes must match the window sizes of this estimator;
+     * the internal buffer grows if needed, regardless of the overflow policy.
+     */
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type>
+    {
+        this->reset();
+        if (serialization::read_header<value_type>(in, serialization::kind_t::sliding_time_window_covariance))
+            this->load_samples(in);
+    }
+};
+
+template <typename ValueType, sliding_time_window_size_t Window1, sliding_time_window_size_t... WindowN>
+using sliding_time_window_covariance_estimator_t =
+    basic_sliding_time_window_covariance_estimator_t<
+        ValueType, std::allocator<ValueType>, no_instrumentation_t, Window1, WindowN...>;
+static_assert(BivariateEstimator<sliding_time_window_covariance_estimator_t<double, 1ul>>);
+
+namespace pmr {
+
+template <typename ValueType, sliding_time_window_size_t Window1, sliding_time_window_size_t... WindowN>
+using sliding_time_window_covariance_estimator_t =
+    basic_sliding_time_window_covariance_estimator_t<
+        ValueType, std::pmr::polymorphic_allocator<ValueType>, no_instrumentation_t, Window1, WindowN...>;
+
+} // namespace pmr
+
+} // namespace livestats
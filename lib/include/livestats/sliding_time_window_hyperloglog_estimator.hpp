@@ -0,0 +1,262 @@
+#pragma once
+
+#include "livestats/hyperloglog_estimator.hpp"
+#include "livestats/serialization.hpp"
+#include "livestats/sliding_time_window_tags.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <numeric>
+#include <ostream>
+#include <vector>
+
+namespace livestats {
+
+/**
+ * Estimator to approximate the number of distinct keys, eg unique clients, over one or more sliding time windows,
+ * eg 1s, 10s and 60s, without storing the keys.
+ * Time is split into buckets spanning the greatest common divisor of the window sizes divided by `Subdivisions`,
+ * each with its own `hyperloglog_estimator_t`; each window of `m` buckets covers the current, partial bucket
+ * and the `m - 1` previous ones, so windows slide by whole buckets, and queries merge the sketches of those buckets
+ * on the fly.
+ * A window of size W thus covers between `W - bucket_duration()` and W of the most recent time,
+ * ie at least `1 - 1/Subdivisions` of the smallest window, eg 7/8 of the 1s window for 1s, 10s and 60s windows.
+ * Memory is proportional to the longest window divided by the bucket size.
+ *
+ * @tparam  Precision       The precision of each sketch, see `hyperloglog_estimator_t`.
+ * @tparam  Subdivisions    The number of buckets in the greatest common divisor of the window sizes.
+ * @tparam  Window1         The size of the primary sliding window, in milliseconds or as a duration, eg `250us`.
+ * @tparam  WindowN         The size of secondary sliding windows.
+ */
+template <
+    std::size_t Precision,
+    std::size_t Subdivisions,
+    sliding_time_window_size_t Window1,
+    sliding_time_window_size_t... WindowN
+>
+class basic_sliding_time_window_hyperloglog_estimator_t
+{
+    static_assert(Subdivisions > 0ul);
+
+public:
+    using value_type = double;
+    using sketch_type = hyperloglog_estimator_t<Precision>;
+
+private:
+    static constexpr auto primary_window = sliding_time_window_tag<Window1>;
+
+    static constexpr std::int64_t gcd_nanos = [] {
+        auto gcd = Window1.nanoseconds;
+        ((gcd = std::gcd(gcd, WindowN.nanoseconds)), ...);
+        return gcd;
+    }();
+    static_assert(gcd_nanos % static_cast<std::int64_t>(Subdivisions) == 0, "buckets must span whole nanoseconds");
+    static constexpr std::int64_t bucket_nanos = gcd_nanos / static_cast<std::int64_t>(Subdivisions);
+    static constexpr std::size_t n_buckets = std::max({Window1.nanoseconds, WindowN.nanoseconds...}) / bucket_nanos;
+    static constexpr auto bucket_size = std::chrono::nanoseconds(bucket_nanos);
+
+    std::vector<sketch_type> buckets; // bucket `i` is stored at `buckets[i % n_buckets]`
+    std::uint64_t current = 0ul; // index of the latest bucket since the epoch of the clock
+    bool started = false;
+
+public:
+    basic_sliding_time_window_hyperloglog_estimator_t()
+        : buckets(n_buckets)
+    { }
+
+    /**
+     * Add a key in all sliding windows and retrieve the new estimate of the primary window.
+     */
+    template <typename Key>
+    value_type add(Key const& key)
+    {
+        push(key);
+        return get();
+    }
+
+    /**
+     * Add a key in all sliding windows.
+     */
+    template <typename Key>
+    void push(Key const& key)
+    {
+        push(key, std::chrono::steady_clock::now());
+    }
+
+    /**
+     * Add a key in the bucket spanning the given timestamp, advancing all windows to it if more recent;
+     * a key older than the current bucket still counts in the windows spanning its own bucket,
+     * while a key older than the longest window is discarded.
+     */
+    template <typename Key>
+    void push(Key const& key, std::chrono::steady_clock::time_point const timestamp)
+    {
+        auto const bucket = bucket_of(timestamp);
+        if (not started or bucket > current)
+            advance(timestamp);
+        else if (current - bucket >= n_buckets)
+            return;
+        buckets[bucket % n_buckets].push(key);
+    }
+
+    /**
+     * Advance all sliding windows to the bucket spanning `now`, discarding the buckets that fall out of them.
+     * Invocations to this function must happen in non-decreasing time order.
+     */
+    void advance(std::chrono::steady_clock::time_point const now)
+    {
+        auto const bucket = bucket_of(now);
+        if (not started)
+        {
+            current = bucket;
+            started = true;
+            return;
+        }
+        if (bucket <= current)
+            return;
+        for (std::uint64_t i = 1ul; i <= std::min<std::uint64_t>(bucket - current, n_buckets); ++i)
+            buckets[(current + i) % n_buckets].reset();
+        current = bucket;
+    }
+
+    /**
+     * Discard everything and reset as if just constructed.
+     */
+    void reset()
+    {
+        for (auto& b: buckets)
+            b.reset();
+        started = false;
+    }
+
+    /**
+     * Return the estimate of the number of distinct keys in the primary window.
+     */
+    value_type get() const { return get(primary_window); }
+
+    /**
+     * Return the estimate of the number of distinct keys in the given window,
+     * merging the registers of its buckets in cache-sized chunks.
+     */
+    template <sliding_time_window_size_t Window>
+    value_type get(sliding_time_window_tag_t<Window> const w) const
+    {
+        constexpr auto chunk_size = std::min(64ul, sketch_type::register_count);
+        auto const n = buckets_in(w);
+        double harmonic_sum = 0.0;
+        std::size_t n_zeros = 0ul;
+        std::array<std::uint8_t, chunk_size> merged;
+        for (std::size_t first = 0ul; first < sketch_type::register_count; first += chunk_size)
+        {
+            merged.fill(0u);
+            for (std::size_t k = 0ul; k < n; ++k)
+            {
+                auto const registers = buckets[(current - k) % n_buckets].registers().subspan(first, chunk_size);
+                for (std::size_t j = 0ul; j < chunk_size; ++j)
+                    merged[j] = std::max(merged[j], registers[j]);
+            }
+            for (auto const r: merged)
+            {
+                harmonic_sum += sketch_type::inverse_power_of_two(r);
+                n_zeros += r == 0u;
+            }
+        }
+        return sketch_type::estimate(harmonic_sum, n_zeros);
+    }
+
+    /**
+     * Return the total number of keys, including duplicates, currently in the primary window.
+     */
+    std::size_t size() const { return size(primary_window); }
+
+    /**
+     * Return the total number of keys, including duplicates, currently in the given window.
+     */
+    template <sliding_time_window_size_t Window>
+    std::size_t size(sliding_time_window_tag_t<Window> const w) const
+    {
+        std::size_t total = 0ul;
+        for (std::size_t k = 0ul; k < buckets_in(w); ++k)
+            total += buckets[(current - k) % n_buckets].size();
+        return total;
+    }
+
+    /**
+     * Return the time span of each bucket, ie the step by which windows slide,
+     * and the largest part of a window that may not be covered.
+     */
+    static constexpr std::chrono::nanoseconds bucket_duration() { return bucket_size; }
+
+    /**
+     * Return the number of bytes used by this estimator, including all sketches.
+     */
+    std::size_t memory_usage() const { return sizeof(*this) + buckets.capacity() * sizeof(sketch_type); }
+
+    /**
+     * Save the current state, including the sketches of all buckets, to the given stream; see `Serializable`.
+     */
+    void save(std::ostream& out) const
+    {
+        using namespace serialization;
+        write_header<value_type>(out, kind_t::sliding_time_window_hyperloglog);
+        write(out, Precision);
+        write(out, bucket_size);
+        write(out, n_buckets);
+        write(out, started);
+        write(out, current);
+        for (auto const& b: buckets)
+            b.save(out);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved precision, bucket size and number of buckets must match those of this estimator.
+     */
+    void load(std::istream& in)
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type>(in, kind_t::sliding_time_window_hyperloglog))
+            return;
+        auto const precision = read<std::size_t>(in);
+        auto const saved_bucket_size = read<std::chrono::nanoseconds>(in);
+        auto const saved_n_buckets = read<std::size_t>(in);
+        if (not in or precision != Precision or saved_bucket_size != bucket_size or saved_n_buckets != n_buckets)
+            return fail(in);
+        started = read<bool>(in);
+        current = read<std::uint64_t>(in);
+        for (auto& b: buckets)
+            b.load(in);
+        if (not in)
+        {
+            reset();
+            fail(in);
+        }
+    }
+
+private:
+    static std::uint64_t bucket_of(std::chrono::steady_clock::time_point const t)
+    {
+        return static_cast<std::uint64_t>(t.time_since_epoch() / bucket_size);
+    }
+
+    template <sliding_time_window_size_t Window>
+    std::size_t buckets_in(sliding_time_window_tag_t<Window>) const
+    {
+        static_cast<void>(sliding_time_window_index<Window, Window1, WindowN...>());
+        return started ? static_cast<std::size_t>(Window.nanoseconds / bucket_nanos) : 0ul;
+    }
+};
+
+/**
+ * Estimator to approximate the number of distinct keys over one or more sliding time windows,
+ * with 8 buckets in the greatest common divisor of the window sizes.
+ */
+template <std::size_t Precision, sliding_time_window_size_t Window1, sliding_time_window_size_t... WindowN>
+using sliding_time_window_hyperloglog_estimator_t =
+    basic_sliding_time_window_hyperloglog_estimator_t<Precision, 8ul, Window1, WindowN...>;
+
+} // namespace livestats
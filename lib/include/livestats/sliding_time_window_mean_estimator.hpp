@@ -1,15 +1,16 @@
 #pragma once
 
 #include "livestats/estimator.hpp"
+#include "livestats/instrumentation.hpp"
+#include "livestats/serialization.hpp"
+#include "livestats/sliding_time_window_sample_buffer.hpp"
 #include "livestats/sliding_time_window_tags.hpp"
 
-#include <boost/hana.hpp>
+#include "livestats/math/running_sum.hpp"
 
-#include <algorithm>
-#include <cassert>
 #include <chrono>
-#include <deque>
-#include <optional>
+#include <memory>
+#include <memory_resource>
 
 namespace livestats {
 
@@ -18,95 +19,39 @@ namespace livestats {
  * It assumes the sum of all samples in each time window does not overflow.
  *
  * @tparam  ValueType       The type of samples, eg integer, floating point or vectorized numerical type.
- * @tparam  Milliseconds1   The size in milliseconds of the primary sliding window.
- * @tparam  MillisecondsN   The size in milliseconds of secondary sliding windows.
+ * @tparam  AccumulatorType The type of the running sum of each window; only samples are stored in the buffer.
+ * @tparam  Allocator       The allocator used for the sample buffer, rebound to the internal sample type.
+ * @tparam  Instrumentation The instrumentation policy notified on the hot path, eg `counting_instrumentation_t`;
+ *                          `no_instrumentation_t` costs nothing.
+ * @tparam  Window1         The size of the primary sliding window, in milliseconds or as a duration, eg `250us`.
+ * @tparam  WindowN         The size of secondary sliding windows.
  */
-template <typename ValueType, std::size_t Milliseconds1, std::size_t... MillisecondsN>
-class sliding_time_window_mean_estimator_t
+template <
+    typename ValueType,
+    typename AccumulatorType,
+    typename Allocator,
+    typename Instrumentation,
+    sliding_time_window_size_t Window1,
+    sliding_time_window_size_t... WindowN
+>
+class basic_sliding_time_window_mean_estimator_t
+    : public sliding_time_window_sample_buffer_t<
+        ValueType, math::running_sum_t<ValueType, AccumulatorType>, Allocator, Instrumentation, Window1, WindowN...>
 {
-public:
-    using value_type = ValueType;
+    using base_t = sliding_time_window_sample_buffer_t<
+        ValueType, math::running_sum_t<ValueType, AccumulatorType>, Allocator, Instrumentation, Window1, WindowN...>;
 
-private:
-    static constexpr auto primary_window = sliding_time_window_tag<Milliseconds1>;
+    using base_t::primary_window;
+    using base_t::window;
 
-    /**
-     * Each sample is associated with its timestamp.
-     */
-    struct sample_t
-    {
-        std::chrono::steady_clock::time_point timestamp; // steady_clock guarantees non-decreasing time order
-        value_type value;
-    };
+public:
+    using value_type = ValueType;
+    using accumulator_type = AccumulatorType;
+    using allocator_type = Allocator;
 
-    /**
-     * Each window contains the total sum and count of the samples in that window,
-     * along with an iterator pointing to the beginning of the window.
-     */
-    class window_t
-    {
-        std::size_t n = 0ul;
-        value_type sum = {};
-        std::optional<typename std::deque<sample_t>::const_iterator> begin = std::nullopt; // empty if `n == 0`
-
-    public:
-
-        value_type get() const { return n > 0ul ? sum / n : value_type{}; }
-
-        std::size_t size() const { return n; }
-
-        void push(typename std::deque<sample_t>::const_iterator const samples_begin, value_type const value)
-        {
-            ++n;
-            sum += value;
-            if (not begin)
-                begin = samples_begin;
-        }
-
-        /**
-         * Advance the beginning of the sliding window dropping all samples older than the given timestamp.
-         * Return the new start of the sliding window or the end iterator if the window is now empty.
-         */
-        typename std::deque<sample_t>::const_iterator
-        drop_before(
-            std::chrono::steady_clock::time_point const t0,
-            typename std::deque<sample_t>::const_iterator const end)
-        {
-            if (n == 0ul)
-                return end;
-            assert(begin.has_value()); // set by push()
-            auto& it = *begin;
-            while (it->timestamp < t0)
-            {
-                if (--n == 0ul)
-                {
-                    reset();
-                    return end;
-                }
-                sum -= it->value;
-                ++it;
-                assert(it != end);
-            }
-            return it;
-        }
-
-        void reset()
-        {
-            n = 0ul;
-            sum = value_type{};
-            begin.reset();
-        }
-    };
-
-    using window_map_t = decltype(boost::hana::make_map( // associate a window to each duration
-        boost::hana::make_pair(sliding_time_window_tag<Milliseconds1>, window_t{}),
-        boost::hana::make_pair(sliding_time_window_tag<MillisecondsN>, window_t{})...
-    ));
-
-    std::deque<sample_t> samples;
-    window_map_t windows;
+    using base_t::base_t;
+    using base_t::push;
 
-public:
     /**
      * Push a new sample in all sliding windows and retrieve the new mean of the primary window.
      */
@@ -116,58 +61,6 @@ public:
         return get();
     }
 
-    /**
-     * Push a new sample in all sliding windows.
-     */
-    void push(value_type const value)
-    {
-        push(value, std::chrono::steady_clock::now());
-    }
-
-    /**
-     * Push a new sample in all sliding windows and advance them all to the given timestamp.
-     * Samples must be pushed in non-decreasing time order;
-     * if the given timestamp is older than the current latest sample,
-     * the new sample will be discarded and this function performs nothing.
-     */
-    void push(value_type const value, std::chrono::steady_clock::time_point const timestamp)
-    {
-        if (samples.empty() or samples.back().timestamp <= timestamp)
-        {
-            samples.push_back(sample_t{timestamp, value});
-            boost::hana::unpack(
-                boost::hana::keys(windows),
-                [&] (auto... w) { (windows[w].push(samples.begin(), value), ...); });
-            advance(timestamp);
-        }
-    }
-
-    /**
-     * Update all sliding windows by discarding samples that fall outside of each window when compared to `now`.
-     * Invocations to this function must happen in non-decreasing time order;
-     * if `now` is older than the current latest sample, this function performs nothing.
-     */
-    void advance(std::chrono::steady_clock::time_point const now)
-    {
-        if (samples.empty() or now < samples.back().timestamp)
-            return;
-        auto const new_begin = boost::hana::unpack(boost::hana::keys(windows),
-            [&] <std::size_t... Millis> (sliding_time_window_tag_t<Millis>... w)
-            {
-                return std::min({windows[w].drop_before(now - std::chrono::milliseconds(Millis), samples.end())...});
-            });
-        samples.erase(samples.begin(), new_begin);
-    }
-
-    /**
-     * Discard everything and reset as if default-constructed.
-     */
-    void reset()
-    {
-        samples.clear();
-        boost::hana::unpack(boost::hana::keys(windows), [&] (auto... w) { (windows[w].reset(), ...); });
-    }
-
     /**
      * Return the current value of the mean of the primary window.
      */
@@ -176,35 +69,55 @@ public:
     /**
      * Return the mean of the given time window
      */
-    template <std::size_t Millis>
-    value_type get(sliding_time_window_tag_t<Millis> const w) const
+    template <sliding_time_window_size_t Window>
+    value_type get(sliding_time_window_tag_t<Window> const w) const
     {
-        return windows[w].get();
+        return static_cast<value_type>(window(w).mean());
     }
 
     /**
-     * Return the total number of samples currently in the primary window.
+     * Save the current state, including all samples in the internal buffer, to the given stream;
+     * see `Serializable`.
      */
-    std::size_t size() const { return size(primary_window); }
-
-    /**
-     * Return the total number of samples currently in the given window.
-     */
-    template <std::size_t Millis>
-    std::size_t size(sliding_time_window_tag_t<Millis> const w) const
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
     {
-        return windows[w].size();
+        serialization::write_header<value_type, accumulator_type>(out, serialization::kind_t::sliding_time_window_mean);
+        this->save_samples(out);
     }
 
     /**
-     * Return the total number of samples currently stored in the internal buffer.
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved window sizes must match the window sizes of this estimator;
+     * the internal buffer grows if needed, regardless of the overflow policy.
      */
-    std::size_t sample_buffer_size() const
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
     {
-        return samples.size();
+        this->reset();
+        if (serialization::read_header<value_type, accumulator_type>(in, serialization::kind_t::sliding_time_window_mean))
+            this->load_samples(in);
     }
 };
+
+/**
+ * Estimator to compute the mean of one or more sliding time windows, accumulating sums in `ValueType` itself.
+ */
+template <typename ValueType, sliding_time_window_size_t Window1, sliding_time_window_size_t... WindowN>
+using sliding_time_window_mean_estimator_t =
+    basic_sliding_time_window_mean_estimator_t<
+        ValueType, ValueType, std::allocator<ValueType>, no_instrumentation_t, Window1, WindowN...>;
 static_assert(Estimator<sliding_time_window_mean_estimator_t<double, 1ul>>);
 
+namespace pmr {
+
+template <typename ValueType, sliding_time_window_size_t Window1, sliding_time_window_size_t... WindowN>
+using sliding_time_window_mean_estimator_t =
+    basic_sliding_time_window_mean_estimator_t<
+        ValueType, ValueType, std::pmr::polymorphic_allocator<ValueType>, no_instrumentation_t,
+        Window1, WindowN...>;
+
+} // namespace pmr
+
 
 } // namespace livestats
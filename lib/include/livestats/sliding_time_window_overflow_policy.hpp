@@ -0,0 +1,14 @@
+#pragma once
+
+namespace livestats {
+
+/**
+ * What a sliding time window estimator does when its sample buffer is full and a new sample arrives.
+ */
+enum class sliding_time_window_overflow_policy
+{
+    grow,           // reallocate the buffer with twice the capacity; windows remain exact
+    drop_oldest,    // drop the oldest sample from all windows early, without allocating
+};
+
+} // namespace livestats
@@ -0,0 +1,351 @@
+#pragma once
+
+#include "livestats/serialization.hpp"
+#include "livestats/sliding_time_window_tags.hpp"
+
+#include <boost/circular_buffer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <type_traits>
+
+namespace livestats {
+
+/**
+ * Estimator to compute the rate of events, eg messages per second, over one or more sliding time windows,
+ * along with the mean and variance of the time between consecutive events, ie their jitter.
+ * Only the timestamps of events are stored, half the footprint of a `sliding_time_window_mean_estimator_t`
+ * of doubles; inter-arrival times are accumulated in exact integer nanoseconds, so they never drift.
+ *
+ * @tparam  Allocator       The allocator used for the timestamp buffer.
+ * @tparam  Window1         The size of the primary sliding window, in milliseconds or as a duration, eg `250us`.
+ * @tparam  WindowN         The size of secondary sliding windows.
+ */
+template <typename Allocator, sliding_time_window_size_t Window1, sliding_time_window_size_t... WindowN>
+class basic_sliding_time_window_rate_estimator_t
+{
+public:
+    using value_type = double;
+    using allocator_type = Allocator;
+
+private:
+    static constexpr auto primary_window = sliding_time_window_tag<Window1>;
+
+    using timestamp_allocator_t =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<std::chrono::steady_clock::time_point>;
+    using timestamp_buffer_t = boost::circular_buffer<std::chrono::steady_clock::time_point, timestamp_allocator_t>;
+    using squares_t = unsigned __int128;
+
+    /**
+     * Each window contains the count of events and the sum of the squared gaps between consecutive events;
+     * the sum of the gaps is the time between the oldest and the latest event.
+     * All windows end at the latest event, so each window begins `size()` events before the end of the buffer.
+     */
+    class window_t
+    {
+        std::size_t n = 0ul;
+        squares_t sum_squared_gaps = 0u;
+
+    public:
+        std::size_t size() const { return n; }
+
+        squares_t squared_gaps() const { return sum_squared_gaps; }
+
+        /**
+         * Add the latest event, `gap` nanoseconds after the previous one.
+         */
+        void push(std::uint64_t const gap)
+        {
+            if (n++ > 0ul)
+                sum_squared_gaps += squares_t(gap) * gap;
+        }
+
+        /**
+         * Advance the beginning of the sliding window dropping all events older than the given timestamp.
+         * Return the number of events left in the window.
+         */
+        std::size_t drop_before(std::chrono::steady_clock::time_point const t0, timestamp_buffer_t const& timestamps)
+        {
+            while (n > 0ul)
+            {
+                auto const oldest = timestamps[timestamps.size() - n];
+                if (oldest >= t0)
+                    break;
+                if (--n > 0ul)
+                {
+                    auto const gap = nanoseconds(timestamps[timestamps.size() - n] - oldest);
+                    sum_squared_gaps -= squares_t(gap) * gap;
+                }
+            }
+            return n;
+        }
+
+        void reset()
+        {
+            n = 0ul;
+            sum_squared_gaps = 0u;
+        }
+    };
+
+    static constexpr std::array<std::chrono::nanoseconds, 1ul + sizeof...(WindowN)> window_sizes{
+        Window1.duration(),
+        WindowN.duration()...
+    };
+
+    timestamp_buffer_t timestamps;
+    std::array<window_t, window_sizes.size()> windows; // `windows[i]` spans `window_sizes[i]`
+
+public:
+    basic_sliding_time_window_rate_estimator_t() = default;
+
+    /**
+     * Construct an empty estimator whose timestamp buffer is preallocated to hold `capacity` events;
+     * it grows as needed.
+     */
+    explicit basic_sliding_time_window_rate_estimator_t(std::size_t const capacity, allocator_type const& alloc = {})
+        : timestamps(capacity, timestamp_allocator_t(alloc))
+    { }
+
+    /**
+     * Record an event now.
+     */
+    void push()
+    {
+        push(std::chrono::steady_clock::now());
+    }
+
+    /**
+     * Record an event at the given timestamp and advance all windows to it.
+     * Events must be pushed in non-decreasing time order; older events are discarded.
+     */
+    void push(std::chrono::steady_clock::time_point const timestamp)
+    {
+        if (not timestamps.empty() and timestamp < timestamps.back())
+            return;
+        auto const gap = timestamps.empty() ? 0ul : nanoseconds(timestamp - timestamps.back());
+        if (timestamps.full()) [[unlikely]]
+            timestamps.set_capacity(std::max(1ul, 2ul * timestamps.capacity()));
+        timestamps.push_back(timestamp);
+        for (auto& w: windows)
+            w.push(gap);
+        advance(timestamp);
+    }
+
+    /**
+     * Update all sliding windows by discarding events that fall outside of each window when compared to `now`.
+     * Invocations to this function must happen in non-decreasing time order;
+     * if `now` is older than the latest event, this function performs nothing.
+     */
+    void advance(std::chrono::steady_clock::time_point const now)
+    {
+        if (timestamps.empty() or now < timestamps.back())
+            return;
+        std::size_t n = 0ul; // number of events still in at least one window
+        for (std::size_t i = 0ul; i < windows.size(); ++i)
+            n = std::max(n, windows[i].drop_before(now - window_sizes[i], timestamps));
+        timestamps.erase_begin(timestamps.size() - n);
+    }
+
+    /**
+     * Discard everything and reset as if just constructed, retaining the capacity of the internal buffer.
+     */
+    void reset()
+    {
+        timestamps.clear();
+        for (auto& w: windows)
+            w.reset();
+    }
+
+    /**
+     * Return the number of events per second in the primary window.
+     */
+    value_type get() const { return get(primary_window); }
+
+    /**
+     * Return the number of events per second in the given window.
+     */
+    template <sliding_time_window_size_t Window>
+    value_type get(sliding_time_window_tag_t<Window> const w) const
+    {
+        return static_cast<value_type>(size(w)) / std::chrono::duration<value_type>(Window.duration()).count();
+    }
+
+    /**
+     * Return the number of events currently in the primary window.
+     */
+    std::size_t size() const { return size(primary_window); }
+
+    /**
+     * Return the number of events currently in the given window.
+     */
+    template <sliding_time_window_size_t Window>
+    std::size_t size(sliding_time_window_tag_t<Window> const w) const
+    {
+        return window(w).size();
+    }
+
+    /**
+     * Return the mean time between consecutive events in the primary window, or zero with fewer than two events.
+     */
+    std::chrono::duration<double> mean_interarrival() const { return mean_interarrival(primary_window); }
+
+    /**
+     * Return the mean time between consecutive events in the given window, or zero with fewer than two events.
+     */
+    template <sliding_time_window_size_t Window>
+    std::chrono::duration<double> mean_interarrival(sliding_time_window_tag_t<Window> const w) const
+    {
+        auto const n = size(w);
+        if (n < 2ul)
+            return std::chrono::duration<double>::zero();
+        return (timestamps.back() - timestamps[timestamps.size() - n]) / static_cast<double>(n - 1ul);
+    }
+
+    /**
+     * Return the variance, in seconds squared, of the time between consecutive events in the primary window,
+     * or zero with fewer than two events.
+     */
+    double interarrival_variance() const { return interarrival_variance(primary_window); }
+
+    /**
+     * Return the variance, in seconds squared, of the time between consecutive events in the given window,
+     * or zero with fewer than two events.
+     */
+    template <sliding_time_window_size_t Window>
+    double interarrival_variance(sliding_time_window_tag_t<Window> const w) const
+    {
+        auto const n = size(w);
+        if (n < 2ul)
+            return 0.0;
+        // n*sum(g^2) - sum(g)^2 is computed exactly, then scaled
+        auto const n_gaps = static_cast<squares_t>(n - 1ul);
+        auto const sum_gaps = static_cast<squares_t>(nanoseconds(timestamps.back() - timestamps[timestamps.size() - n]));
+        auto const numerator = n_gaps * window(w).squared_gaps() - sum_gaps * sum_gaps;
+        auto const denominator = static_cast<double>(n_gaps) * static_cast<double>(n_gaps);
+        return static_cast<double>(numerator) / denominator * 1e-18;
+    }
+
+    /**
+     * Return the earliest time at which `advance()` will discard some event,
+     * or `std::chrono::steady_clock::time_point::max()` if all windows are empty.
+     */
+    std::chrono::steady_clock::time_point next_expiry() const
+    {
+        auto expiry = std::chrono::steady_clock::time_point::max();
+        for (std::size_t i = 0ul; i < windows.size(); ++i)
+            if (windows[i].size() > 0ul)
+            {
+                // events are discarded once strictly older than the beginning of the window
+                auto const oldest = timestamps[timestamps.size() - windows[i].size()];
+                expiry = std::min(expiry, oldest + window_sizes[i] + std::chrono::steady_clock::duration(1));
+            }
+        return expiry;
+    }
+
+    /**
+     * Return the total number of timestamps currently stored in the internal buffer.
+     */
+    std::size_t sample_buffer_size() const { return timestamps.size(); }
+
+    /**
+     * Return the number of bytes used by this estimator, including the capacity of the timestamp buffer.
+     */
+    std::size_t memory_usage() const
+    {
+        return sizeof(*this) + timestamps.capacity() * sizeof(std::chrono::steady_clock::time_point);
+    }
+
+    /**
+     * Return the allocator used for the timestamp buffer.
+     */
+    allocator_type get_allocator() const { return allocator_type(timestamps.get_allocator()); }
+
+    /**
+     * Save the current state, including all timestamps in the internal buffer, to the given stream;
+     * see `Serializable`.
+     */
+    void save(std::ostream& out) const
+    {
+        using namespace serialization;
+        write_header<std::chrono::steady_clock::time_point, squares_t>(out, kind_t::sliding_time_window_rate);
+        write(out, window_sizes);
+        write(out, timestamps.size());
+        for (auto const t: timestamps)
+            write(out, t);
+        for (auto const& w: windows)
+            write(out, w);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved window sizes must match the window sizes of this estimator;
+     * the internal buffer grows if needed.
+     */
+    void load(std::istream& in)
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<std::chrono::steady_clock::time_point, squares_t>(in, kind_t::sliding_time_window_rate))
+            return;
+        auto const saved_window_sizes = read<std::remove_const_t<decltype(window_sizes)>>(in);
+        auto const n = read<std::size_t>(in);
+        if (not in or saved_window_sizes != window_sizes)
+            return fail(in);
+        for (std::size_t i = 0ul; i < n; ++i)
+        {
+            auto const timestamp = read<std::chrono::steady_clock::time_point>(in);
+            if (not in)
+                break;
+            // grow as timestamps are actually read, since a corrupt count must not allocate a huge buffer
+            if (timestamps.full())
+                timestamps.set_capacity(std::min(n, std::max(1ul, 2ul * timestamps.capacity())));
+            timestamps.push_back(timestamp);
+        }
+        for (auto& w: windows)
+            w = read<window_t>(in);
+        auto const valid = [this] (window_t const& w) { return w.size() <= timestamps.size(); };
+        if (not in or not std::all_of(windows.begin(), windows.end(), valid))
+        {
+            reset();
+            fail(in);
+        }
+    }
+
+private:
+    static std::uint64_t nanoseconds(std::chrono::steady_clock::duration const d)
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    }
+
+    template <sliding_time_window_size_t Window>
+    window_t const& window(sliding_time_window_tag_t<Window>) const
+    {
+        return windows[sliding_time_window_index<Window, Window1, WindowN...>()];
+    }
+};
+
+/**
+ * Estimator to compute the rate of events over one or more sliding time windows.
+ */
+template <sliding_time_window_size_t Window1, sliding_time_window_size_t... WindowN>
+using sliding_time_window_rate_estimator_t =
+    basic_sliding_time_window_rate_estimator_t<
+        std::allocator<std::chrono::steady_clock::time_point>, Window1, WindowN...>;
+
+namespace pmr {
+
+template <sliding_time_window_size_t Window1, sliding_time_window_size_t... WindowN>
+using sliding_time_window_rate_estimator_t =
+    basic_sliding_time_window_rate_estimator_t<
+        std::pmr::polymorphic_allocator<std::chrono::steady_clock::time_point>, Window1, WindowN...>;
+
+} // namespace pmr
+
+} // namespace livestats
@@ -0,0 +1,493 @@
+#pragma once
+
+#include "livestats/serialization.hpp"
+#include "livestats/sliding_time_window_overflow_policy.hpp"
+#include "livestats/sliding_time_window_tags.hpp"
+
+#include <boost/circular_buffer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <concepts>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+namespace livestats {
+
+/**
+ * The running aggregate of the samples in one sliding time window, eg their count and sum:
+ * samples are pushed as they arrive and popped oldest first as they expire,
+ * and the aggregate of a block of more recent samples can be merged at once.
+ */
+template <typename Window, typename Value>
+concept SlidingTimeWindowAggregate = std::default_initializable<Window>
+    and requires(Window window, Window const& other, Value const value)
+{
+    { other.size() } -> std::same_as<std::size_t>;
+    { window.push(value) };
+    { window.pop(value) };
+    { window.merge(other) };
+    { window.reset() };
+};
+
+/**
+ * Base of the sliding time window estimators, holding the buffer of timestamped samples shared by all windows
+ * and everything that does not depend on the statistics computed over each window:
+ * insertion of late samples within the reorder horizon, eviction of expired samples,
+ * the overflow policy of a preallocated buffer and saving the samples.
+ * Estimators derive from it and only provide the aggregate of each window and the statistics derived from it.
+ *
+ * @tparam  Value           The type stored with each timestamp, eg a sample or a pair of samples.
+ * @tparam  Aggregate       The running aggregate of each window; see `SlidingTimeWindowAggregate`.
+ * @tparam  Allocator       The allocator used for the sample buffer, rebound to the internal sample type.
+ * @tparam  Instrumentation The instrumentation policy notified on the hot path, eg `counting_instrumentation_t`;
+ *                          `no_instrumentation_t` costs nothing.
+ * @tparam  Window1         The size of the primary sliding window, in milliseconds or as a duration, eg `250us`.
+ * @tparam  WindowN         The size of secondary sliding windows.
+ */
+template <
+    typename Value,
+    SlidingTimeWindowAggregate<Value> Aggregate,
+    typename Allocator,
+    typename Instrumentation,
+    sliding_time_window_size_t Window1,
+    sliding_time_window_size_t... WindowN
+>
+class sliding_time_window_sample_buffer_t
+{
+public:
+    using allocator_type = Allocator;
+
+protected:
+    using aggregate_t = Aggregate;
+
+    static constexpr auto primary_window = sliding_time_window_tag<Window1>;
+
+    /**
+     * Each sample is associated with its timestamp.
+     */
+    struct sample_t
+    {
+        std::chrono::steady_clock::time_point timestamp; // steady_clock guarantees non-decreasing time order
+        Value value;
+    };
+
+    using sample_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<sample_t>;
+    using sample_buffer_t = boost::circular_buffer<sample_t, sample_allocator_t>;
+
+    static constexpr std::array<std::chrono::nanoseconds, 1ul + sizeof...(WindowN)> window_sizes{
+        Window1.duration(),
+        WindowN.duration()...
+    };
+
+    sample_buffer_t samples;
+    // `windows[i]` spans `window_sizes[i]`; all windows end at the latest sample,
+    // so each window begins `size()` samples before the end of the buffer
+    std::array<Aggregate, window_sizes.size()> windows;
+    sliding_time_window_overflow_policy overflow_policy = sliding_time_window_overflow_policy::grow;
+    std::size_t max_sample_buffer_size = 0ul;
+    std::size_t n_dropped = 0ul;
+    std::size_t n_late = 0ul;
+    std::chrono::steady_clock::duration horizon = std::chrono::steady_clock::duration::zero();
+    std::chrono::steady_clock::time_point last_advance = {}; // the end of all windows
+    [[no_unique_address]] Instrumentation probes;
+
+public:
+    sliding_time_window_sample_buffer_t() = default;
+
+    /**
+     * Construct an empty estimator whose sample buffer allocates via the given allocator.
+     */
+    explicit sliding_time_window_sample_buffer_t(allocator_type const& alloc)
+        : samples(sample_allocator_t(alloc))
+    { }
+
+    /**
+     * Construct an empty estimator whose sample buffer is preallocated to hold `capacity` samples,
+     * so that no allocation happens as long as the windows never contain more than `capacity` samples.
+     * Beyond that, the buffer either grows or drops the oldest samples early, depending on `policy`;
+     * if `capacity` is 0 the buffer always grows.
+     */
+    explicit sliding_time_window_sample_buffer_t(
+        std::size_t const capacity,
+        sliding_time_window_overflow_policy const policy = sliding_time_window_overflow_policy::grow,
+        allocator_type const& alloc = {})
+        : samples(capacity, sample_allocator_t(alloc))
+        , overflow_policy(policy)
+    { }
+
+    /**
+     * Push a new sample in all sliding windows.
+     */
+    void push(Value const value)
+    {
+        push(value, std::chrono::steady_clock::now());
+    }
+
+    /**
+     * Push a new sample in all sliding windows and advance them all to the given timestamp.
+     * Samples should be pushed in non-decreasing time order;
+     * a sample older than the current latest sample by at most `reorder_horizon()` is inserted in time order
+     * into the windows that still span its timestamp, without advancing them,
+     * while an older sample, or one no window spans anymore, is discarded and counted by `size_late()`.
+     */
+    void push(Value const value, std::chrono::steady_clock::time_point const timestamp)
+    {
+        if (samples.empty() or samples.back().timestamp <= timestamp)
+        {
+            if (samples.full()) [[unlikely]]
+                make_room();
+            samples.push_back(sample_t{timestamp, value});
+            max_sample_buffer_size = std::max(max_sample_buffer_size, samples.size());
+            probes.on_push(samples.size());
+            for (auto& w: windows)
+                w.push(value);
+            advance(timestamp);
+        }
+        else if (timestamp + horizon >= samples.back().timestamp)
+            insert_late(value, timestamp);
+        else
+        {
+            ++n_late;
+            probes.on_discard();
+        }
+    }
+
+    /**
+     * Push a batch of samples in all sliding windows and advance them all to the latest timestamp,
+     * same as pushing each sample in turn with `push(value, timestamp)`, but faster:
+     * each run of in-order samples is appended to the buffer and added to the windows as a single block,
+     * and expired samples are evicted once at the end of the run.
+     * `timestamps` and `values` must have the same size.
+     */
+    void push_range(
+        std::span<std::chrono::steady_clock::time_point const> const timestamps,
+        std::span<Value const> const values)
+    {
+        assert(timestamps.size() == values.size());
+        push_range(
+            std::views::iota(0ul, std::min(timestamps.size(), values.size())),
+            [&] (std::size_t const i) { return timestamps[i]; },
+            [&] (std::size_t const i) { return values[i]; });
+    }
+
+    /**
+     * Push a batch of records in all sliding windows, as `push_range(timestamps, values)`,
+     * projecting the timestamp and the value out of each record, eg via pointers to data members
+     * like `&tick_t::timestamp` and `&tick_t::price`, so that records need not be copied beforehand.
+     */
+    template <std::ranges::input_range Range, typename TimestampProjection, typename ValueProjection>
+        requires std::convertible_to<
+                std::invoke_result_t<TimestampProjection&, std::ranges::range_reference_t<Range>>,
+                std::chrono::steady_clock::time_point>
+            and std::convertible_to<
+                std::invoke_result_t<ValueProjection&, std::ranges::range_reference_t<Range>>,
+                Value>
+    void push_range(Range&& records, TimestampProjection timestamp_of, ValueProjection value_of)
+    {
+        aggregate_t block; // samples appended to the buffer but not yet added to the windows
+        for (auto&& record: records)
+        {
+            std::chrono::steady_clock::time_point const timestamp = std::invoke(timestamp_of, record);
+            Value const value = std::invoke(value_of, record);
+            if (samples.empty() or samples.back().timestamp <= timestamp) [[likely]]
+            {
+                if (samples.full()) [[unlikely]]
+                {
+                    // evict as `push()` would have done before deciding whether the buffer must make room
+                    flush(block);
+                    if (samples.full())
+                        make_room();
+                }
+                samples.push_back(sample_t{timestamp, value});
+                probes.on_push(samples.size());
+                block.push(value);
+            }
+            else
+            {
+                flush(block);
+                push(value, timestamp);
+            }
+        }
+        flush(block);
+    }
+
+    /**
+     * Update all sliding windows by discarding samples that fall outside of each window when compared to `now`.
+     * Invocations to this function must happen in non-decreasing time order;
+     * if `now` is older than the current latest sample, this function performs nothing.
+     */
+    void advance(std::chrono::steady_clock::time_point const now)
+    {
+        if (samples.empty() or now < samples.back().timestamp)
+            return;
+        std::size_t n = 0ul; // number of samples still in at least one window
+        std::size_t n_evicted = 0ul; // number of samples removed from any window
+        for (std::size_t i = 0ul; i < windows.size(); ++i)
+        {
+            auto& w = windows[i];
+            auto const t0 = now - window_sizes[i];
+            while (w.size() > 0ul)
+            {
+                auto const& oldest = samples[samples.size() - w.size()];
+                if (oldest.timestamp >= t0)
+                    break;
+                w.pop(oldest.value);
+                ++n_evicted;
+            }
+            n = std::max(n, w.size());
+        }
+        samples.erase_begin(samples.size() - n);
+        last_advance = std::max(last_advance, now);
+        probes.on_advance(n_evicted);
+    }
+
+    /**
+     * Discard everything and reset as if just constructed, retaining the capacity of the internal buffer.
+     */
+    void reset()
+    {
+        samples.clear();
+        for (auto& w: windows)
+            w.reset();
+        max_sample_buffer_size = 0ul;
+        n_dropped = 0ul;
+        n_late = 0ul;
+        last_advance = {};
+    }
+
+    /**
+     * Return the total number of samples currently in the primary window.
+     */
+    std::size_t size() const { return size(primary_window); }
+
+    /**
+     * Return the total number of samples currently in the given window.
+     */
+    template <sliding_time_window_size_t Window>
+    std::size_t size(sliding_time_window_tag_t<Window> const w) const
+    {
+        return window(w).size();
+    }
+
+    /**
+     * Return the earliest time at which `advance()` will discard some sample,
+     * or `std::chrono::steady_clock::time_point::max()` if all windows are empty.
+     */
+    std::chrono::steady_clock::time_point next_expiry() const
+    {
+        auto expiry = std::chrono::steady_clock::time_point::max();
+        for (std::size_t i = 0ul; i < windows.size(); ++i)
+            if (windows[i].size() > 0ul)
+            {
+                // samples are discarded once strictly older than the beginning of the window
+                auto const& oldest = samples[samples.size() - windows[i].size()];
+                expiry = std::min(expiry, oldest.timestamp + window_sizes[i] + std::chrono::steady_clock::duration(1));
+            }
+        return expiry;
+    }
+
+    /**
+     * Return the total number of samples currently stored in the internal buffer.
+     */
+    std::size_t sample_buffer_size() const
+    {
+        return samples.size();
+    }
+
+    /**
+     * Return the number of samples that the internal buffer can store before it needs to grow or drop samples.
+     */
+    std::size_t capacity() const { return samples.capacity(); }
+
+    /**
+     * Return the largest number of samples stored in the internal buffer so far.
+     */
+    std::size_t high_watermark() const { return max_sample_buffer_size; }
+
+    /**
+     * Return the number of samples dropped early because the internal buffer was full.
+     * This is always zero with `sliding_time_window_overflow_policy::grow`.
+     */
+    std::size_t size_dropped() const { return n_dropped; }
+
+    /**
+     * Return how much older than the latest sample a new sample can be and still be inserted in time order.
+     */
+    std::chrono::steady_clock::duration reorder_horizon() const { return horizon; }
+
+    /**
+     * Change how much older than the latest sample a new sample can be and still be inserted in time order,
+     * eg a few milliseconds to merge feeds from several sources that arrive slightly out of order;
+     * zero, the default, discards all samples older than the latest one.
+     * Late samples cost O(number of more recent samples) to insert, while in-order samples cost the same as before.
+     */
+    void set_reorder_horizon(std::chrono::steady_clock::duration const reorder_horizon)
+    {
+        horizon = reorder_horizon;
+    }
+
+    /**
+     * Return the number of samples discarded because older than the latest sample by more than `reorder_horizon()`
+     * or, within the horizon, older than the beginning of every window.
+     */
+    std::size_t size_late() const { return n_late; }
+
+    /**
+     * Return the instrumentation policy, eg to read its counters.
+     */
+    Instrumentation const& instrumentation() const { return probes; }
+
+    /**
+     * Return the number of bytes used by this estimator, including the capacity of the sample buffer;
+     * estimators deriving from this class add no data member of their own.
+     */
+    std::size_t memory_usage() const { return sizeof(*this) + samples.capacity() * sizeof(sample_t); }
+
+    /**
+     * Return the allocator used for the sample buffer.
+     */
+    allocator_type get_allocator() const { return allocator_type(samples.get_allocator()); }
+
+protected:
+    template <sliding_time_window_size_t Window>
+    Aggregate const& window(sliding_time_window_tag_t<Window>) const
+    {
+        return windows[sliding_time_window_index<Window, Window1, WindowN...>()];
+    }
+
+    /**
+     * Save the window sizes, the samples in the internal buffer, the aggregate of each window and the counters,
+     * ie the state that follows the header written by the estimator.
+     */
+    void save_samples(std::ostream& out) const
+        requires serialization::Trivial<Value> and serialization::Trivial<Aggregate>
+    {
+        using namespace serialization;
+        write(out, window_sizes);
+        write(out, samples.size());
+        for (auto const& sample: samples)
+        {
+            write(out, sample.timestamp);
+            write(out, sample.value);
+        }
+        for (auto const& w: windows)
+            write(out, w);
+        write(out, max_sample_buffer_size);
+        write(out, n_dropped);
+    }
+
+    /**
+     * Restore the state saved via `save_samples()` into this estimator, which must have just been reset.
+     * The saved window sizes must match the window sizes of this estimator;
+     * the internal buffer grows if needed, regardless of the overflow policy.
+     * If the saved state is incompatible, set `failbit` on the stream and leave the estimator reset.
+     */
+    void load_samples(std::istream& in)
+        requires serialization::Trivial<Value> and serialization::Trivial<Aggregate>
+    {
+        using namespace serialization;
+        auto const saved_window_sizes = read<std::remove_const_t<decltype(window_sizes)>>(in);
+        auto const n = read<std::size_t>(in);
+        if (not in or saved_window_sizes != window_sizes)
+            return fail(in);
+        for (std::size_t i = 0ul; i < n; ++i)
+        {
+            auto const timestamp = read<std::chrono::steady_clock::time_point>(in);
+            auto const value = read<Value>(in);
+            if (not in)
+                break;
+            // grow as samples are actually read, since a corrupt count must not allocate a huge buffer
+            if (samples.full())
+                samples.set_capacity(std::min(n, std::max(1ul, 2ul * samples.capacity())));
+            samples.push_back(sample_t{timestamp, value});
+        }
+        for (auto& w: windows)
+            w = read<Aggregate>(in);
+        max_sample_buffer_size = read<std::size_t>(in);
+        n_dropped = read<std::size_t>(in);
+        auto const valid = [&] (Aggregate const& w) { return w.size() <= samples.size(); };
+        if (not in or not std::all_of(windows.begin(), windows.end(), valid))
+        {
+            reset();
+            fail(in);
+        }
+        else if (not samples.empty())
+            last_advance = samples.back().timestamp;
+    }
+
+private:
+    static constexpr auto longest_window = *std::max_element(window_sizes.begin(), window_sizes.end());
+
+    /**
+     * Add the block of samples at the end of the buffer to all windows, then advance them to the latest sample.
+     */
+    void flush(Aggregate& block)
+    {
+        if (block.size() == 0ul)
+            return;
+        max_sample_buffer_size = std::max(max_sample_buffer_size, samples.size());
+        for (auto& w: windows)
+            w.merge(block);
+        block.reset();
+        advance(samples.back().timestamp);
+    }
+
+    void make_room()
+    {
+        if (overflow_policy == sliding_time_window_overflow_policy::grow or samples.capacity() == 0ul)
+        {
+            samples.set_capacity(std::max(1ul, 2ul * samples.capacity()));
+            probes.on_allocation(samples.capacity());
+        }
+        else
+        {
+            // the oldest sample is in all windows that span the whole buffer
+            auto const& oldest = samples.front();
+            for (auto& w: windows)
+                if (w.size() == samples.size())
+                    w.pop(oldest.value);
+            samples.pop_front();
+            ++n_dropped;
+        }
+    }
+
+    /**
+     * Insert a sample older than the latest one at its position in time order, and add it to the windows
+     * that contain that position, ie whose beginning is not more recent than the sample.
+     */
+    void insert_late(Value const value, std::chrono::steady_clock::time_point const timestamp)
+    {
+        if (timestamp < last_advance - longest_window)
+        {
+            // no window spans it anymore: discarded as if beyond the horizon
+            ++n_late;
+            probes.on_discard();
+            return;
+        }
+        if (samples.full()) [[unlikely]]
+            make_room();
+        auto position = samples.end();
+        while (position != samples.begin() and std::prev(position)->timestamp > timestamp)
+            --position;
+        auto const n_after = static_cast<std::size_t>(samples.end() - position);
+        samples.insert(position, sample_t{timestamp, value});
+        max_sample_buffer_size = std::max(max_sample_buffer_size, samples.size());
+        probes.on_push(samples.size());
+        for (std::size_t i = 0ul; i < windows.size(); ++i)
+        {
+            // windows are suffixes of the buffer, so they contain the sample if they contain an older one
+            auto const n = windows[i].size();
+            if (n_after < n or (n_after == n and timestamp >= last_advance - window_sizes[i]))
+                windows[i].push(value);
+        }
+    }
+};
+
+} // namespace livestats
@@ -1,11 +1,71 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <type_traits>
 
 namespace livestats {
 
-template <std::size_t Millis> using sliding_time_window_tag_t = std::integral_constant<std::size_t, Millis>;
-template <std::size_t Millis> inline constexpr auto sliding_time_window_tag = sliding_time_window_tag_t<Millis>{};
+/**
+ * The size of a sliding time window, given as a template argument of time window estimators:
+ * either a number of milliseconds, eg `50`, or any `std::chrono::duration`, eg `std::chrono::microseconds(250)`
+ * or `250us`, down to nanoseconds.
+ * It is a structural type, so window sizes remain compile-time constants however short they are.
+ */
+struct sliding_time_window_size_t
+{
+    std::int64_t nanoseconds; // public, as required of template arguments
 
-} // namespace livestats
+    constexpr sliding_time_window_size_t(std::size_t const milliseconds)
+        : nanoseconds(static_cast<std::int64_t>(milliseconds) * 1'000'000)
+    { }
+
+    template <typename Rep, typename Period>
+    constexpr sliding_time_window_size_t(std::chrono::duration<Rep, Period> const size)
+        : nanoseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(size).count())
+    { }
+
+    constexpr std::chrono::nanoseconds duration() const { return std::chrono::nanoseconds(nanoseconds); }
+
+    friend constexpr bool operator==(sliding_time_window_size_t, sliding_time_window_size_t) = default;
+};
+
+template <sliding_time_window_size_t Window>
+using sliding_time_window_tag_t = std::integral_constant<sliding_time_window_size_t, Window>;
 
+/**
+ * Selects a window of the given size, in milliseconds or as a duration, eg `sliding_time_window_tag<50>`.
+ */
+template <sliding_time_window_size_t Window>
+inline constexpr auto sliding_time_window_tag = sliding_time_window_tag_t<Window>{};
+
+/**
+ * Selects a window of the given size in microseconds, eg `sliding_time_window_tag_us<250>`.
+ */
+template <std::int64_t Micros>
+inline constexpr auto sliding_time_window_tag_us = sliding_time_window_tag<std::chrono::microseconds(Micros)>;
+
+/**
+ * Selects a window of the given size in nanoseconds, eg `sliding_time_window_tag_ns<500>`.
+ */
+template <std::int64_t Nanos>
+inline constexpr auto sliding_time_window_tag_ns = sliding_time_window_tag<std::chrono::nanoseconds(Nanos)>;
+
+/**
+ * Return the position of the window of size `Window` in the list of windows `WindowN`.
+ * It is a compile-time error if `Window` does not appear exactly once in the list.
+ */
+template <sliding_time_window_size_t Window, sliding_time_window_size_t... WindowN>
+consteval std::size_t sliding_time_window_index()
+{
+    constexpr std::array<sliding_time_window_size_t, sizeof...(WindowN)> windows{WindowN...};
+    constexpr auto count = ((WindowN == Window ? 1ul : 0ul) + ... + 0ul);
+    static_assert(count == 1ul, "the requested sliding time window must appear exactly once");
+    std::size_t i = 0ul;
+    while (windows[i] != Window)
+        ++i;
+    return i;
+}
+
+} // namespace livestats
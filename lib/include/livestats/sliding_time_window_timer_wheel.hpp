@@ -0,0 +1,412 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace livestats {
+
+/**
+ * A time window estimator that can be advanced to a given time and knows when it next needs to be advanced,
+ * eg `sliding_time_window_mean_estimator_t` and `sliding_time_window_variance_estimator_t`.
+ */
+template <typename T>
+concept TimeWindowEstimator = Estimator<T> and requires(
+    T estimator, T const& const_estimator, typename T::value_type const value, std::chrono::steady_clock::time_point t)
+{
+    { estimator.push(value, t) };
+    { estimator.advance(t) };
+    { const_estimator.next_expiry() } -> std::same_as<std::chrono::steady_clock::time_point>;
+};
+
+/**
+ * A mutex that does nothing, for timer wheels only used by a single thread.
+ */
+struct null_mutex_t
+{
+    void lock() { }
+    bool try_lock() { return true; }
+    void unlock() { }
+};
+
+/**
+ * Advances many time window estimators as time goes by,
+ * so that samples are discarded even from estimators that stop receiving new samples (eg idle keys),
+ * without visiting every estimator at every tick.
+ * Each registered estimator is scheduled at its `next_expiry()` in a hierarchical timer wheel:
+ * 4 levels of 64 slots, where level `k` slots span `64^k` ticks of the configured resolution,
+ * so that `tick(now)` only visits the estimators that have samples to discard
+ * plus, amortized, a few cascading operations per estimator; empty slots are skipped via occupancy bitmaps.
+ * Expiries beyond the range of the wheel (about 4.6 hours with a 1ms resolution) are re-scheduled when reached.
+ * Estimators are not owned by the wheel and must outlive their registration.
+ *
+ * All member functions lock the given mutex, so that `tick()` can run from a background thread
+ * (see `run_in_background()`) while other threads push samples through the wheel;
+ * other threads reading the registered estimators directly must hold `lock()` meanwhile.
+ *
+ * @tparam  EstimatorType   The type of time window estimators being advanced.
+ * @tparam  Mutex           The mutex protecting the wheel and its estimators; `null_mutex_t` for single-threaded use.
+ */
+template <TimeWindowEstimator EstimatorType, typename Mutex = null_mutex_t>
+class sliding_time_window_timer_wheel_t
+{
+public:
+    using estimator_type = EstimatorType;
+    using value_type = typename EstimatorType::value_type;
+    using clock_type = std::chrono::steady_clock;
+    using handle_t = std::uint32_t;
+
+private:
+    using tick_t = std::uint64_t;
+
+    static constexpr handle_t nil = std::numeric_limits<handle_t>::max();
+    static constexpr int level_bits = 6;
+    static constexpr std::size_t n_slots = 1ul << level_bits;
+    static constexpr int n_levels = 4;
+    static constexpr tick_t span = tick_t{1} << (level_bits * n_levels); // ticks covered by the whole wheel
+
+    struct node_t
+    {
+        EstimatorType* estimator = nullptr; // nullptr for free nodes
+        tick_t expiry = 0ul;
+        handle_t prev = nil;
+        handle_t next = nil;
+        std::uint8_t level = 0u;
+        std::uint8_t slot = 0u;
+        bool scheduled = false;
+    };
+
+    clock_type::time_point origin;
+    clock_type::duration resolution;
+    tick_t current = 0ul; // next tick to process
+    std::vector<node_t> nodes;
+    handle_t free_nodes = nil;
+    std::size_t n = 0ul;
+    std::array<std::array<handle_t, n_slots>, n_levels> slots;
+    std::array<std::uint64_t, n_levels> occupied{};
+    mutable Mutex mutex;
+
+public:
+    /**
+     * Construct an empty wheel.
+     *
+     * @param   resolution  The duration of a tick: estimators are advanced at most that late.
+     * @param   origin      The time of the first tick; no estimator is advanced earlier.
+     */
+    explicit sliding_time_window_timer_wheel_t(
+        clock_type::duration const resolution = std::chrono::milliseconds(1),
+        clock_type::time_point const origin = clock_type::now()
+    )
+        : origin(origin)
+        , resolution(resolution)
+    {
+        assert(resolution > clock_type::duration::zero());
+        for (auto& level: slots)
+            level.fill(nil);
+    }
+
+    sliding_time_window_timer_wheel_t(sliding_time_window_timer_wheel_t const&) = delete;
+    sliding_time_window_timer_wheel_t& operator=(sliding_time_window_timer_wheel_t const&) = delete;
+
+    /**
+     * Register an estimator, schedule it at its next expiry and return a handle to refer to it.
+     */
+    handle_t add(EstimatorType& estimator)
+    {
+        std::scoped_lock const guard(mutex);
+        handle_t h = free_nodes;
+        if (h != nil)
+            free_nodes = nodes[h].next;
+        else
+        {
+            assert(nodes.size() < nil);
+            h = static_cast<handle_t>(nodes.size());
+            nodes.emplace_back();
+        }
+        nodes[h] = node_t{&estimator};
+        ++n;
+        schedule(h, tick_t{0});
+        return h;
+    }
+
+    /**
+     * Unregister the estimator with the given handle, which becomes invalid.
+     */
+    void remove(handle_t const h)
+    {
+        std::scoped_lock const guard(mutex);
+        assert(h < nodes.size() and nodes[h].estimator);
+        if (nodes[h].scheduled)
+            unlink(h);
+        nodes[h] = node_t{};
+        nodes[h].next = free_nodes;
+        free_nodes = h;
+        --n;
+    }
+
+    /**
+     * Push a new sample with the given timestamp into the estimator with the given handle,
+     * scheduling it if it was empty, or re-scheduling it if the sample makes it expire earlier,
+     * eg a late sample within the reorder horizon that becomes the oldest sample of a window.
+     */
+    void push(handle_t const h, value_type const value, clock_type::time_point const timestamp)
+    {
+        std::scoped_lock const guard(mutex);
+        assert(h < nodes.size() and nodes[h].estimator);
+        auto& node = nodes[h];
+        node.estimator->push(value, timestamp);
+        if (not node.scheduled)
+            schedule(h, tick_t{0});
+        else if (std::max(tick_of(node.estimator->next_expiry()), current) < node.expiry)
+        {
+            unlink(h);
+            schedule(h, tick_t{0});
+        }
+    }
+
+    /**
+     * Re-schedule the estimator with the given handle at its next expiry;
+     * needed only after pushing samples into a registered estimator without going through `push()`.
+     */
+    void reschedule(handle_t const h)
+    {
+        std::scoped_lock const guard(mutex);
+        assert(h < nodes.size() and nodes[h].estimator);
+        if (nodes[h].scheduled)
+            unlink(h);
+        schedule(h, tick_t{0});
+    }
+
+    /**
+     * Advance all estimators whose next expiry is at or before the tick containing `now`,
+     * and re-schedule them at their new expiry. Return the number of estimators advanced.
+     * Invocations to this function must happen in non-decreasing time order.
+     */
+    std::size_t tick(clock_type::time_point const now)
+    {
+        std::scoped_lock const guard(mutex);
+        if (now < origin)
+            return 0ul;
+        auto const target = static_cast<tick_t>((now - origin) / resolution);
+        std::size_t n_advanced = 0ul;
+        while (current <= target)
+        {
+            auto const slot = static_cast<std::size_t>(current & (n_slots - 1ul));
+            if (occupied[0] & (std::uint64_t{1} << slot))
+            {
+                auto h = detach(0, slot);
+                handle_t deferred = nil;
+                while (h != nil)
+                {
+                    auto const next = nodes[h].next;
+                    nodes[h].scheduled = false;
+                    if (nodes[h].expiry <= current)
+                    {
+                        nodes[h].estimator->advance(now);
+                        schedule(h, target + 1ul);
+                        ++n_advanced;
+                    }
+                    else
+                    {
+                        // expiry beyond the range of the wheel, only reachable from the next rotation
+                        nodes[h].next = deferred;
+                        deferred = h;
+                    }
+                    h = next;
+                }
+                ++current;
+                cascade();
+                for (h = deferred; h != nil;)
+                {
+                    auto const next = nodes[h].next;
+                    place(h);
+                    h = next;
+                }
+            }
+            else
+            {
+                current = std::min(next_event(), target + 1ul);
+                cascade();
+            }
+        }
+        return n_advanced;
+    }
+
+    /**
+     * Start a thread calling `tick(clock_type::now())` every `period`, until the returned thread is destroyed.
+     * The wheel must outlive the returned thread.
+     */
+    std::jthread run_in_background(clock_type::duration const period)
+    {
+        static_assert(not std::same_as<Mutex, null_mutex_t>, "a timer wheel shared with a thread needs a mutex");
+        return std::jthread([this, period] (std::stop_token const stop)
+        {
+            std::mutex sleep_mutex;
+            std::condition_variable_any wakeup;
+            std::unique_lock sleep_lock(sleep_mutex);
+            while (not stop.stop_requested())
+            {
+                tick(clock_type::now());
+                wakeup.wait_for(sleep_lock, stop, period, [] { return false; });
+            }
+        });
+    }
+
+    /**
+     * Lock the wheel and its estimators, eg to read the estimators while a background thread runs `tick()`.
+     * Member functions of the wheel must not be called while holding the lock.
+     */
+    std::unique_lock<Mutex> lock() const { return std::unique_lock<Mutex>(mutex); }
+
+    /**
+     * Return the number of registered estimators.
+     */
+    std::size_t size() const
+    {
+        std::scoped_lock const guard(mutex);
+        return n;
+    }
+
+    /**
+     * Return the number of registered estimators currently scheduled, ie with samples to discard eventually.
+     */
+    std::size_t size_scheduled() const
+    {
+        std::scoped_lock const guard(mutex);
+        std::size_t count = 0ul;
+        for (auto const& node: nodes)
+            count += node.scheduled;
+        return count;
+    }
+
+private:
+    /**
+     * Schedule the given node at the tick of its estimator's next expiry, or at `earliest` if later.
+     * Estimators with nothing to expire are not scheduled.
+     */
+    void schedule(handle_t const h, tick_t const earliest)
+    {
+        auto& node = nodes[h];
+        auto const expiry = node.estimator->next_expiry();
+        if (expiry == clock_type::time_point::max())
+            return;
+        node.expiry = std::max({tick_of(expiry), earliest, current});
+        place(h);
+    }
+
+    /**
+     * Return the first tick starting at or after the given time.
+     */
+    tick_t tick_of(clock_type::time_point const t) const
+    {
+        if (t <= origin)
+            return 0ul;
+        auto const d = t - origin;
+        return static_cast<tick_t>(d / resolution) + (d % resolution != clock_type::duration::zero());
+    }
+
+    /**
+     * Link the given node in the slot of the lowest level whose range contains its expiry,
+     * ie the highest group of bits where the expiry differs from the current tick.
+     */
+    void place(handle_t const h)
+    {
+        auto& node = nodes[h];
+        auto t = node.expiry;
+        if ((t ^ current) >> (level_bits * n_levels))
+            t = current | (span - 1ul); // beyond this rotation: park at its end
+        auto const diff = t ^ current;
+        auto const level = diff == 0ul ? 0 : (static_cast<int>(std::bit_width(diff)) - 1) / level_bits;
+        auto const slot = static_cast<std::size_t>((t >> (level * level_bits)) & (n_slots - 1ul));
+        node.level = static_cast<std::uint8_t>(level);
+        node.slot = static_cast<std::uint8_t>(slot);
+        node.scheduled = true;
+        node.prev = nil;
+        node.next = slots[level][slot];
+        if (node.next != nil)
+            nodes[node.next].prev = h;
+        slots[level][slot] = h;
+        occupied[level] |= std::uint64_t{1} << slot;
+    }
+
+    void unlink(handle_t const h)
+    {
+        auto& node = nodes[h];
+        if (node.prev != nil)
+            nodes[node.prev].next = node.next;
+        else
+        {
+            slots[node.level][node.slot] = node.next;
+            if (node.next == nil)
+                occupied[node.level] &= ~(std::uint64_t{1} << node.slot);
+        }
+        if (node.next != nil)
+            nodes[node.next].prev = node.prev;
+        node.scheduled = false;
+    }
+
+    /**
+     * Empty the given slot and return the list of nodes it contained.
+     */
+    handle_t detach(int const level, std::size_t const slot)
+    {
+        auto const h = slots[level][slot];
+        slots[level][slot] = nil;
+        occupied[level] &= ~(std::uint64_t{1} << slot);
+        return h;
+    }
+
+    /**
+     * Once the current tick reaches the beginning of a slot of the upper levels,
+     * move the nodes of that slot down to the lower levels.
+     */
+    void cascade()
+    {
+        for (int level = n_levels - 1; level > 0; --level)
+        {
+            if (current & ((tick_t{1} << (level * level_bits)) - 1ul))
+                continue;
+            auto const slot = static_cast<std::size_t>((current >> (level * level_bits)) & (n_slots - 1ul));
+            for (auto h = detach(level, slot); h != nil;)
+            {
+                auto const next = nodes[h].next;
+                place(h);
+                h = next;
+            }
+        }
+    }
+
+    /**
+     * Return the first tick after the current one where a slot must be processed or cascaded.
+     */
+    tick_t next_event() const
+    {
+        for (int level = 0; level < n_levels; ++level)
+        {
+            auto const shift = level * level_bits;
+            auto const index = static_cast<int>((current >> shift) & (n_slots - 1ul));
+            // slots strictly after the current one, within the current rotation of this level
+            auto const later = index + 1 < static_cast<int>(n_slots) ? occupied[level] >> (index + 1) << (index + 1) : 0ul;
+            if (later)
+            {
+                auto const rotation = current & ~((tick_t{1} << (shift + level_bits)) - 1ul);
+                return rotation | (static_cast<tick_t>(std::countr_zero(later)) << shift);
+            }
+        }
+        return (current | (span - 1ul)) + 1ul; // nothing left in this rotation of the wheel
+    }
+};
+
+} // namespace livestats
@@ -1,17 +1,22 @@
 #pragma once
 
 #include "livestats/estimator.hpp"
+#include "livestats/instrumentation.hpp"
+#include "livestats/serialization.hpp"
+#include "livestats/sliding_time_window_sample_buffer.hpp"
 #include "livestats/sliding_time_window_tags.hpp"
 
-#include "livestats/math/non_negative.hpp"
-
-#include <boost/hana.hpp>
+#include "livestats/math/moments.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <chrono>
-#include <deque>
-#include <optional>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <vector>
 
 namespace livestats {
 
@@ -20,107 +25,104 @@ namespace livestats {
  * It assumes the sum of all samples in each time window does not overflow.
  *
  * @tparam  ValueType       The type of samples, eg integer, floating point or vectorized numerical type.
- * @tparam  Milliseconds1   The size in milliseconds of the primary sliding window.
- * @tparam  MillisecondsN   The size in milliseconds of secondary sliding windows.
+ * @tparam  AccumulatorType The type of the running sum and "unscaled variance" of each window;
+ *                          only samples are stored in the buffer.
+ * @tparam  Allocator       The allocator used for the sample buffer, rebound to the internal sample type.
+ * @tparam  Instrumentation The instrumentation policy notified on the hot path, eg `counting_instrumentation_t`;
+ *                          `no_instrumentation_t` costs nothing.
+ * @tparam  Window1         The size of the primary sliding window, in milliseconds or as a duration, eg `250us`.
+ * @tparam  WindowN         The size of secondary sliding windows.
  */
-template <typename ValueType, std::size_t Milliseconds1, std::size_t... MillisecondsN>
-class sliding_time_window_variance_estimator_t
+template <
+    typename ValueType,
+    typename AccumulatorType,
+    typename Allocator,
+    typename Instrumentation,
+    sliding_time_window_size_t Window1,
+    sliding_time_window_size_t... WindowN
+>
+class basic_sliding_time_window_variance_estimator_t
+    : public sliding_time_window_sample_buffer_t<
+        ValueType, math::moments_t<ValueType, AccumulatorType>, Allocator, Instrumentation, Window1, WindowN...>
 {
+    using base_t = sliding_time_window_sample_buffer_t<
+        ValueType, math::moments_t<ValueType, AccumulatorType>, Allocator, Instrumentation, Window1, WindowN...>;
+
+    using typename base_t::aggregate_t;
+    using typename base_t::sample_t;
+    using typename base_t::sample_buffer_t;
+    using base_t::primary_window;
+    using base_t::window_sizes;
+    using base_t::samples;
+    using base_t::windows;
+    using base_t::max_sample_buffer_size;
+    using base_t::n_dropped;
+    using base_t::n_late;
+    using base_t::last_advance;
+    using base_t::probes;
+    using base_t::window;
+
 public:
     using value_type = ValueType;
-
-private:
-    static constexpr auto primary_window = sliding_time_window_tag<Milliseconds1>;
+    using accumulator_type = AccumulatorType;
+    using allocator_type = Allocator;
 
     /**
-     * Each sample is associated with its timestamp.
+     * The count, mean and variance of each window at some point in time, without the samples,
+     * eg to combine the windows of several shards via `merge_windows()`.
      */
-    struct sample_t
+    class summary_t
     {
-        std::chrono::steady_clock::time_point timestamp; // steady_clock guarantees non-decreasing time order
-        value_type value;
-    };
+        friend class basic_sliding_time_window_variance_estimator_t;
 
-    /**
-     * Each window contains the total count, sum and "unscaled variance" of the samples in that window,
-     * along with an iterator pointing to the beginning of the window.
-     */
-    class window_t
-    {
-        std::size_t n = 0ul;
-        value_type sum = {};
-        value_type n_s = {};
-        std::optional<typename std::deque<sample_t>::const_iterator> begin = std::nullopt; // empty if `n == 0`
+        std::array<aggregate_t, window_sizes.size()> windows;
 
     public:
+        /**
+         * Combine the windows of another summary, taken at the same time, into the windows of this one.
+         */
+        summary_t& merge(summary_t const& other)
+        {
+            for (std::size_t i = 0ul; i < windows.size(); ++i)
+                windows[i].merge(other.windows[i]);
+            return *this;
+        }
 
-        value_type mean() const { return n > 0ul ? sum / n : value_type{}; }
-        value_type variance() const { return n > 0ul ? n_s / n : value_type{}; }
-        std::size_t size() const { return n; }
+        value_type get() const { return get(primary_window); }
 
-        void push(typename std::deque<sample_t>::const_iterator const samples_begin, value_type const value)
+        template <sliding_time_window_size_t Window>
+        value_type get(sliding_time_window_tag_t<Window> const w) const
         {
-            auto const old_mean = mean();
-            ++n;
-            sum += value;
-            auto const new_mean = mean();
-            math::non_negative::plus_equal_a_minus_b_times_c_minus_d(n_s, value, old_mean, value, new_mean);
-            if (not begin)
-                begin = samples_begin;
+            return static_cast<value_type>(window(w).variance());
         }
 
-        /**
-         * Advance the beginning of the sliding window dropping all samples older than the given timestamp.
-         * Return the new start of the sliding window or the end iterator if the window is now empty.
-         */
-        typename std::deque<sample_t>::const_iterator
-        drop_before(
-            std::chrono::steady_clock::time_point const t0,
-            typename std::deque<sample_t>::const_iterator const end)
+        value_type mean() const { return mean(primary_window); }
+
+        template <sliding_time_window_size_t Window>
+        value_type mean(sliding_time_window_tag_t<Window> const w) const
+        {
+            return static_cast<value_type>(window(w).mean());
+        }
+
+        std::size_t size() const { return size(primary_window); }
+
+        template <sliding_time_window_size_t Window>
+        std::size_t size(sliding_time_window_tag_t<Window> const w) const
         {
-            if (n == 0ul)
-                return end;
-            assert(begin.has_value()); // set by push()
-            auto& it = *begin;
-            while (it->timestamp < t0)
-            {
-                auto const old_mean = mean();
-                if (--n == 0ul)
-                {
-                    reset();
-                    return end;
-                }
-                auto const x = it->value;
-                sum -= x;
-                auto const new_mean = mean();
-                if (n == 1ul)
-                    n_s = value_type{};
-                else
-                    math::non_negative::minus_equal_a_minus_b_times_c_minus_d(n_s, x, old_mean, x, new_mean);
-                ++it;
-                assert(it != end);
-            }
-            return it;
+            return window(w).size();
         }
 
-        void reset()
+    private:
+        template <sliding_time_window_size_t Window>
+        aggregate_t const& window(sliding_time_window_tag_t<Window>) const
         {
-            n = 0ul;
-            sum = value_type{};
-            n_s  = value_type{};
-            begin.reset();
+            return windows[sliding_time_window_index<Window, Window1, WindowN...>()];
         }
     };
 
-    using window_map_t = decltype(boost::hana::make_map( // associate a window to each duration
-        boost::hana::make_pair(sliding_time_window_tag<Milliseconds1>, window_t{}),
-        boost::hana::make_pair(sliding_time_window_tag<MillisecondsN>, window_t{})...
-    ));
+    using base_t::base_t;
+    using base_t::push;
 
-    std::deque<sample_t> samples;
-    window_map_t windows;
-
-public:
     /**
      * Push a new sample in all sliding windows and retrieve the new variance of the primary window.
      */
@@ -131,109 +133,192 @@ public:
     }
 
     /**
-     * Push a new sample in all sliding windows.
+     * Return the current value of the variance of the primary window.
      */
-    void push(value_type const value)
-    {
-        push(value, std::chrono::steady_clock::now());
-    }
+    value_type get() const { return get(primary_window); }
 
     /**
-     * Push a new sample in all sliding windows and advance them all to the given timestamp.
-     * Samples must be pushed in non-decreasing time order;
-     * if the given timestamp is older than the current latest sample,
-     * the new sample will be discarded and this function performs nothing.
+     * Return the variance of the given time window
      */
-    void push(value_type const value, std::chrono::steady_clock::time_point const timestamp)
+    template <sliding_time_window_size_t Window>
+    value_type get(sliding_time_window_tag_t<Window> const w) const
     {
-        if (samples.empty() or samples.back().timestamp <= timestamp)
-        {
-            samples.push_back(sample_t{timestamp, value});
-            boost::hana::unpack(
-                boost::hana::keys(windows),
-                [&] (auto... w) { (windows[w].push(samples.begin(), value), ...); });
-            advance(timestamp);
-        }
+        return static_cast<value_type>(window(w).variance());
     }
 
     /**
-     * Update all sliding windows by discarding samples that fall outside of each window when compared to `now`.
-     * Invocations to this function must happen in non-decreasing time order;
-     * if `now` is older than the current latest sample, this function performs nothing.
+     * Return the mean of the primary window.
      */
-    void advance(std::chrono::steady_clock::time_point const now)
-    {
-        if (samples.empty() or now < samples.back().timestamp)
-            return;
-        auto const new_begin = boost::hana::unpack(boost::hana::keys(windows),
-            [&] <std::size_t... Millis> (sliding_time_window_tag_t<Millis>... w)
-            {
-                return std::min({windows[w].drop_before(now - std::chrono::milliseconds(Millis), samples.end())...});
-            });
-        samples.erase(samples.begin(), new_begin);
-    }
+    value_type mean() const { return mean(primary_window); }
 
     /**
-     * Discard everything and reset as if default-constructed.
+     * Return the mean of the given time window
      */
-    void reset()
+    template <sliding_time_window_size_t Window>
+    value_type mean(sliding_time_window_tag_t<Window> const w) const
     {
-        samples.clear();
-        boost::hana::unpack(boost::hana::keys(windows), [&] (auto... w) { (windows[w].reset(), ...); });
+        return static_cast<value_type>(window(w).mean());
     }
 
     /**
-     * Return the current value of the variance of the primary window.
+     * Return the count, mean and variance of all windows as they currently are.
      */
-    value_type get() const { return get(primary_window); }
-
-    /**
-     * Return the variance of the given time window
-     */
-    template <std::size_t Millis>
-    value_type get(sliding_time_window_tag_t<Millis> const w) const
+    summary_t summary() const
     {
-        return windows[w].variance();
+        summary_t result;
+        result.windows = windows;
+        return result;
     }
 
     /**
-     * Return the mean of the primary window.
+     * Advance the windows of two estimators, eg owned by different ingest threads, to `now`,
+     * and return their combined count, mean and variance over each window, in O(number of windows)
+     * once the expired samples are evicted; `now` must not be older than the latest sample of either estimator.
+     * More shards can be combined by merging the summary of each one, advanced to the same time.
      */
-    value_type mean() const { return mean(primary_window); }
+    friend summary_t merge_windows(
+        basic_sliding_time_window_variance_estimator_t& a,
+        basic_sliding_time_window_variance_estimator_t& b,
+        std::chrono::steady_clock::time_point const now)
+    {
+        a.advance(now);
+        b.advance(now);
+        return a.summary().merge(b.summary());
+    }
 
     /**
-     * Return the mean of the given time window
+     * Add all the samples of other estimators, eg owned by different ingest threads, to this one,
+     * as if they had all been pushed here in time order, so that the merged estimator can keep evolving.
+     * The sample buffers are merged by timestamp in O(total samples * log(number of estimators)),
+     * and all windows are recomputed as of the most recent `advance()` of any of them.
+     * The internal buffer grows if needed, regardless of the overflow policy;
+     * the counts of dropped and late samples are summed.
      */
-    template <std::size_t Millis>
-    value_type mean(sliding_time_window_tag_t<Millis> const w) const
+    void merge(std::span<basic_sliding_time_window_variance_estimator_t const* const> const shards)
     {
-        return windows[w].mean();
+        assert(std::find(shards.begin(), shards.end(), this) == shards.end());
+        sample_buffer_t const own(samples.begin(), samples.end(), samples.get_allocator());
+        auto total = own.size();
+        for (auto const* shard: shards)
+        {
+            total += shard->samples.size();
+            max_sample_buffer_size = std::max(max_sample_buffer_size, shard->max_sample_buffer_size);
+            n_dropped += shard->n_dropped;
+            n_late += shard->n_late;
+            last_advance = std::max(last_advance, shard->last_advance);
+        }
+
+        // k-way merge of the sample buffers, in a min-heap of the next sample of each estimator;
+        // ties are broken by the position of the estimator, this one first, so the merge is stable
+        struct source_t
+        {
+            typename sample_buffer_t::const_iterator next;
+            typename sample_buffer_t::const_iterator end;
+            std::size_t index;
+        };
+        std::vector<source_t> heap;
+        heap.reserve(1ul + shards.size());
+        if (not own.empty())
+            heap.push_back(source_t{own.begin(), own.end(), 0ul});
+        for (std::size_t i = 0ul; i < shards.size(); ++i)
+            if (not shards[i]->samples.empty())
+                heap.push_back(source_t{shards[i]->samples.begin(), shards[i]->samples.end(), 1ul + i});
+        auto const later = [] (source_t const& lhs, source_t const& rhs) {
+            return lhs.next->timestamp != rhs.next->timestamp
+                ? lhs.next->timestamp > rhs.next->timestamp
+                : lhs.index > rhs.index;
+        };
+        std::make_heap(heap.begin(), heap.end(), later);
+
+        samples.clear();
+        if (total > samples.capacity())
+        {
+            samples.set_capacity(total);
+            probes.on_allocation(samples.capacity());
+        }
+        while (not heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            auto& source = heap.back();
+            samples.push_back(*source.next);
+            if (++source.next == source.end)
+                heap.pop_back();
+            else
+                std::push_heap(heap.begin(), heap.end(), later);
+        }
+        max_sample_buffer_size = std::max(max_sample_buffer_size, samples.size());
+
+        // each window holds the samples not older than its beginning, and the buffer the samples of any window
+        std::size_t n = 0ul;
+        for (std::size_t i = 0ul; i < windows.size(); ++i)
+        {
+            auto const t0 = last_advance - window_sizes[i];
+            auto const first = std::partition_point(samples.begin(), samples.end(),
+                [t0] (sample_t const& sample) { return sample.timestamp < t0; });
+            windows[i].reset();
+            for (auto it = first; it != samples.end(); ++it)
+                windows[i].push(it->value);
+            n = std::max(n, windows[i].size());
+        }
+        samples.erase_begin(samples.size() - n);
     }
 
     /**
-     * Return the total number of samples currently in the primary window.
+     * Add all the samples of another estimator to this one; see `merge(shards)`.
      */
-    std::size_t size() const { return size(primary_window); }
+    void merge(basic_sliding_time_window_variance_estimator_t const& other)
+    {
+        std::array<basic_sliding_time_window_variance_estimator_t const*, 1ul> const shards{&other};
+        merge(shards);
+    }
 
     /**
-     * Return the total number of samples currently in the given window.
+     * Save the current state, including all samples in the internal buffer, to the given stream;
+     * see `Serializable`.
      */
-    template <std::size_t Millis>
-    std::size_t size(sliding_time_window_tag_t<Millis> const w) const
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
     {
-        return windows[w].size();
+        serialization::write_header<value_type, accumulator_type>(
+            out, serialization::kind_t::sliding_time_window_variance);
+        this->save_samples(out);
     }
 
     /**
-     * Return the total number of samples currently stored in the internal buffer.
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved window sizes must match the window sizes of this estimator;
+     * the internal buffer grows if needed, regardless of the overflow policy.
      */
-    std::size_t sample_buffer_size() const
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
     {
-        return samples.size();
+        this->reset();
+        if (serialization::read_header<value_type, accumulator_type>(
+                in, serialization::kind_t::sliding_time_window_variance))
+            this->load_samples(in);
     }
 };
+
+/**
+ * Estimator to compute variance (and mean) of one or more sliding time windows,
+ * accumulating sums in `ValueType` itself.
+ */
+template <typename ValueType, sliding_time_window_size_t Window1, sliding_time_window_size_t... WindowN>
+using sliding_time_window_variance_estimator_t =
+    basic_sliding_time_window_variance_estimator_t<
+        ValueType, ValueType, std::allocator<ValueType>, no_instrumentation_t, Window1, WindowN...>;
 static_assert(Estimator<sliding_time_window_variance_estimator_t<double, 1ul>>);
 
+namespace pmr {
+
+template <typename ValueType, sliding_time_window_size_t Window1, sliding_time_window_size_t... WindowN>
+using sliding_time_window_variance_estimator_t =
+    basic_sliding_time_window_variance_estimator_t<
+        ValueType, ValueType, std::pmr::polymorphic_allocator<ValueType>, no_instrumentation_t,
+        Window1, WindowN...>;
+
+} // namespace pmr
+
 
 } // namespace livestats
 
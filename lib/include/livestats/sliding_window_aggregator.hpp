@@ -0,0 +1,106 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+
+#include "livestats/math/monoid.hpp"
+#include "livestats/math/sliding_aggregation.hpp"
+
+#include <memory>
+#include <memory_resource>
+
+namespace livestats {
+
+/**
+ * Estimator to combine the last N samples with any associative operation, eg their maximum,
+ * or the merge of per-sample histograms or sketches.
+ * Unlike the other sliding window estimators, it never subtracts the sample leaving the window,
+ * so it supports operations without an inverse and does not accumulate rounding errors;
+ * every update costs O(1) in the worst case, see `math::sliding_aggregation_t`,
+ * since the buffer is preallocated to N samples and never grows.
+ *
+ * @tparam  Monoid      The operation and its identity, eg `math::max_monoid_t<double>`.
+ * @tparam  Allocator   The allocator used for the window buffer.
+ */
+template <math::Monoid Monoid, typename Allocator = std::allocator<typename Monoid::value_type>>
+class sliding_window_aggregator_t
+{
+public:
+    using value_type = typename Monoid::value_type;
+    using allocator_type = Allocator;
+
+private:
+    math::sliding_aggregation_t<Monoid, Allocator> window;
+    std::size_t window_size;
+
+public:
+    explicit sliding_window_aggregator_t(
+        std::size_t const window_size,
+        Monoid const& monoid = {},
+        allocator_type const& alloc = {})
+        : window(window_size, monoid, alloc)
+        , window_size(window_size)
+    { }
+
+    /**
+     * Update the aggregate with a new sample and return the new aggregate.
+     */
+    value_type add(value_type const& sample)
+    {
+        push(sample);
+        return get();
+    }
+
+    /**
+     * Update the aggregate with a new sample.
+     */
+    void push(value_type const& sample)
+    {
+        if (full()) [[likely]]
+            window.pop_front();
+        window.push_back(sample);
+    }
+
+    /**
+     * Discard everything and reset as if just constructed.
+     */
+    void reset() { window.clear(); }
+
+    /**
+     * Return the combination of all samples in the window, from the oldest to the latest, in O(1).
+     */
+    value_type get() const { return window.aggregate(); }
+
+    /**
+     * Return the total number of samples currently in the window.
+     */
+    std::size_t size() const { return window.size(); }
+
+    /**
+     * Return true if the sliding window contains exactly N samples; false otherwise.
+     */
+    bool full() const { return window.size() == window_size; }
+
+    /**
+     * Return the number of bytes used by this estimator, including the capacity of the window buffer.
+     */
+    std::size_t memory_usage() const { return sizeof(*this) - sizeof(window) + window.memory_usage(); }
+
+    /**
+     * Return the allocator used for the window buffer.
+     */
+    allocator_type get_allocator() const { return window.get_allocator(); }
+};
+// explicitly instantiated in livestats_lib for the most common operations
+extern template class sliding_window_aggregator_t<math::max_monoid_t<double>>;
+extern template class sliding_window_aggregator_t<math::min_monoid_t<double>>;
+static_assert(Estimator<sliding_window_aggregator_t<math::max_monoid_t<double>>>);
+
+namespace pmr {
+
+template <math::Monoid Monoid>
+using sliding_window_aggregator_t = livestats::sliding_window_aggregator_t<
+    Monoid, std::pmr::polymorphic_allocator<typename Monoid::value_type>>;
+
+} // namespace pmr
+
+} // namespace livestats
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
+
+#include "livestats/math/co_moments.hpp"
+
+#include <boost/circular_buffer.hpp>
+
+#include <cassert>
+#include <memory>
+#include <memory_resource>
+
+namespace livestats {
+
+/**
+ * Estimator to compute the covariance of two sequences over a sliding window with at most N pairs `(x, y)`,
+ * along with the correlation and the ordinary least squares regression of `y` on `x`.
+ * Pairs are stored together in a single buffer; each update adds the new pair to the running co-moments
+ * and removes the pair leaving the window, in O(1).
+ *
+ * @tparam  ValueType   The type of samples; it must be signed, eg floating point.
+ * @tparam  Allocator   The allocator used for the window buffer, rebound to the internal pair type.
+ */
+template <typename ValueType, typename Allocator = std::allocator<ValueType>>
+class sliding_window_covariance_estimator_t
+{
+public:
+    using value_type = ValueType;
+    using allocator_type = Allocator;
+
+private:
+    struct sample_t
+    {
+        value_type x;
+        value_type y;
+    };
+    using sample_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<sample_t>;
+
+    boost::circular_buffer<sample_t, sample_allocator_t> samples;
+    math::co_moments_t<ValueType> moments;
+
+public:
+    explicit sliding_window_covariance_estimator_t(std::size_t const window_size, allocator_type const& alloc = {})
+        : samples(window_size, sample_allocator_t(alloc))
+    { }
+
+    /**
+     * Update the estimate with a new pair and return the new covariance.
+     */
+    value_type add(value_type const x, value_type const y)
+    {
+        push(x, y);
+        return get();
+    }
+
+    /**
+     * Update the estimate with a new pair.
+     */
+    void push(value_type const x, value_type const y)
+    {
+        if (full()) [[likely]]
+            moments.pop(samples.front().x, samples.front().y);
+        samples.push_back(sample_t{x, y});
+        moments.push(x, y);
+    }
+
+    /**
+     * Discard everything and reset as if just constructed.
+     */
+    void reset()
+    {
+        samples.clear();
+        moments.reset();
+    }
+
+    /**
+     * Return the current value of the covariance, without performing any computation.
+     */
+    value_type get() const { return moments.covariance(); }
+
+    /**
+     * Return the total number of pairs currently in the window.
+     */
+    std::size_t size() const { return samples.size(); }
+
+    /**
+     * Return the number of bytes used by this estimator, including the capacity of the pair buffer.
+     */
+    std::size_t memory_usage() const { return sizeof(*this) + samples.capacity() * sizeof(sample_t); }
+
+    /**
+     * Return true if the sliding window contains exactly N pairs; false otherwise.
+     */
+    bool full() const { return samples.full(); }
+
+    /**
+     * Return the covariance of `x` and `y` in the current window, same as `get()`.
+     */
+    value_type covariance() const { return moments.covariance(); }
+
+    /**
+     * Return the Pearson correlation coefficient of `x` and `y` in the current window,
+     * or 0 if either has no variance.
+     */
+    value_type correlation() const { return moments.correlation(); }
+
+    /**
+     * Return the slope of the least squares fit `y = slope*x + intercept` over the current window.
+     */
+    value_type slope() const { return moments.slope(); }
+
+    /**
+     * Return the intercept of the least squares fit `y = slope*x + intercept` over the current window.
+     */
+    value_type intercept() const { return moments.intercept(); }
+
+    value_type mean_x() const { return moments.mean_x; }
+    value_type mean_y() const { return moments.mean_y; }
+    value_type variance_x() const { return moments.variance_x(); }
+    value_type variance_y() const { return moments.variance_y(); }
+
+    /**
+     * Return the allocator used for the window buffer.
+     */
+    allocator_type get_allocator() const { return allocator_type(samples.get_allocator()); }
+
+    /**
+     * Save the current state to the given stream; see `Serializable`.
+     */
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type>
+    {
+        using namespace serialization;
+        write_header<value_type>(out, kind_t::sliding_window_covariance);
+        write(out, samples.capacity());
+        write(out, samples.size());
+        for (auto const& sample: samples)
+            write(out, sample);
+        write(out, moments);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved window size must match the window size of this estimator.
+     */
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type>
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type>(in, kind_t::sliding_window_covariance))
+            return;
+        auto const window_size = read<std::size_t>(in);
+        auto const n = read<std::size_t>(in);
+        if (not in or window_size != samples.capacity() or n > window_size)
+            return fail(in);
+        for (std::size_t i = 0ul; i < n; ++i)
+            samples.push_back(read<sample_t>(in));
+        moments = read<math::co_moments_t<value_type>>(in);
+        if (not in or moments.n != samples.size())
+        {
+            reset();
+            fail(in);
+        }
+    }
+};
+// explicitly instantiated in livestats_lib for the most common sample types
+extern template class sliding_window_covariance_estimator_t<double>;
+extern template class sliding_window_covariance_estimator_t<float>;
+static_assert(BivariateEstimator<sliding_window_covariance_estimator_t<double>>);
+
+namespace pmr {
+
+template <typename ValueType>
+using sliding_window_covariance_estimator_t =
+    livestats::sliding_window_covariance_estimator_t<ValueType, std::pmr::polymorphic_allocator<ValueType>>;
+
+} // namespace pmr
+
+} // namespace livestats
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
 
 #include <boost/circular_buffer.hpp>
 
 #include <cassert>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
 
 namespace livestats {
 
@@ -12,18 +16,29 @@ namespace livestats {
  * Estimator to compute the mean of a sliding window with at most N samples.
  * It assumes the sum of all samples in the current slidiing window does not overflow.
  *
- * @tparam  ValueType   The type of samples, eg integer, floating point or vectorized numerical type.
+ * @tparam  ValueType       The type of samples, eg integer, floating point or vectorized numerical type.
+ * @tparam  AccumulatorType The type of the running sum; only samples are stored in the window,
+ *                          so eg `std::uint32_t` samples can be accumulated in `__int128` without overflow.
+ * @tparam  Allocator       The allocator used for the window buffer.
  */
-template <typename ValueType>
+template <
+    typename ValueType,
+    typename AccumulatorType = ValueType,
+    typename Allocator = std::allocator<ValueType>
+>
 class sliding_window_mean_estimator_t
 {
-    boost::circular_buffer<ValueType> samples;
-    ValueType sum = ValueType{};
+    boost::circular_buffer<ValueType, Allocator> samples;
+    AccumulatorType sum = AccumulatorType{};
 
 public:
     using value_type = ValueType;
+    using accumulator_type = AccumulatorType;
+    using allocator_type = Allocator;
 
-    explicit sliding_window_mean_estimator_t(std::size_t const window_size) : samples(window_size) { }
+    explicit sliding_window_mean_estimator_t(std::size_t const window_size, allocator_type const& alloc = {})
+        : samples(window_size, alloc)
+    { }
 
     /**
      * Update the estimate with a new sample and return the new estimate.
@@ -51,19 +66,24 @@ public:
     void reset()
     {
         samples.clear();
-        sum = value_type{};
+        sum = accumulator_type{};
     }
 
     /**
      * Return the current value of the mean.
      */
-    value_type get() const { return samples.size() ? sum / samples.size() : value_type{}; }
+    value_type get() const { return samples.size() ? static_cast<value_type>(sum / samples.size()) : value_type{}; }
 
     /**
      * Return the total number of samples currently in the window.
      */
     std::size_t size() const { return samples.size(); }
 
+    /**
+     * Return the number of bytes used by this estimator, including the capacity of the sample buffer.
+     */
+    std::size_t memory_usage() const { return sizeof(*this) + samples.capacity() * sizeof(ValueType); }
+
     /**
      * Return true if the sliding window contains exactly N samples; false otherwise.
      */
@@ -79,9 +99,67 @@ public:
         return samples.front();
     }
 
-    value_type get_sum() const { return sum; }
+    /**
+     * Return the sum of all samples in the current window.
+     */
+    accumulator_type get_sum() const { return sum; }
+
+    /**
+     * Return the allocator used for the window buffer.
+     */
+    allocator_type get_allocator() const { return samples.get_allocator(); }
+
+    /**
+     * Save the current state to the given stream; see `Serializable`.
+     */
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
+    {
+        using namespace serialization;
+        write_header<value_type, accumulator_type>(out, kind_t::sliding_window_mean);
+        write(out, samples.capacity());
+        write(out, samples.size());
+        for (auto const& x: samples)
+            write(out, x);
+        write(out, sum);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved window size must match the window size of this estimator.
+     */
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type, accumulator_type>(in, kind_t::sliding_window_mean))
+            return;
+        auto const window_size = read<std::size_t>(in);
+        auto const n = read<std::size_t>(in);
+        if (not in or window_size != samples.capacity() or n > window_size)
+            return fail(in);
+        for (std::size_t i = 0ul; i < n; ++i)
+            samples.push_back(read<value_type>(in));
+        sum = read<accumulator_type>(in);
+        if (not in)
+            reset();
+    }
 };
+// explicitly instantiated in livestats_lib for the most common sample types
+extern template class sliding_window_mean_estimator_t<double>;
+extern template class sliding_window_mean_estimator_t<float>;
+extern template class sliding_window_mean_estimator_t<std::int64_t>;
+extern template class sliding_window_mean_estimator_t<std::uint64_t>;
 static_assert(Estimator<sliding_window_mean_estimator_t<double>>);
 
+namespace pmr {
+
+template <typename ValueType, typename AccumulatorType = ValueType>
+using sliding_window_mean_estimator_t =
+    livestats::sliding_window_mean_estimator_t<ValueType, AccumulatorType, std::pmr::polymorphic_allocator<ValueType>>;
+
+} // namespace pmr
+
 
 } // namespace livestats
@@ -0,0 +1,374 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace livestats {
+
+/**
+ * Estimator to compute the median of a sliding window with at most N samples,
+ * along with other order statistics such as the median absolute deviation.
+ * Samples are kept both in arrival order, in a ring of N slots, and in value order, in a treap indexed by subtree size;
+ * all nodes are allocated at construction so pushing never allocates.
+ * Pushing a sample and querying the median or the k-th smallest sample cost O(log N) on average,
+ * while `median_absolute_deviation()` costs O(log² N).
+ *
+ * @tparam  ValueType   The type of samples, eg integer or floating point; it must be totally ordered.
+ * @tparam  Allocator   The allocator used for the window buffer.
+ */
+template <typename ValueType, typename Allocator = std::allocator<ValueType>>
+class sliding_window_median_estimator_t
+{
+    using index_t = std::uint32_t;
+    static constexpr index_t nil = std::numeric_limits<index_t>::max();
+
+    struct node_t
+    {
+        ValueType value;
+        index_t left;
+        index_t right;
+        index_t size;
+        index_t priority;
+    };
+    using node_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<node_t>;
+
+    std::vector<node_t, node_allocator_t> nodes; // one per slot of the ring
+    index_t root = nil;
+    index_t n = 0u;
+    index_t next = 0u; // slot of the next sample
+
+public:
+    using value_type = ValueType;
+    using allocator_type = Allocator;
+
+    explicit sliding_window_median_estimator_t(std::size_t const window_size, allocator_type const& alloc = {})
+        : nodes(window_size, node_t{}, node_allocator_t(alloc))
+    {
+        assert(window_size > 0ul and window_size < nil);
+        // priorities only need to be independent from the values, so each slot gets a fixed pseudo-random one
+        for (std::size_t i = 0ul; i < nodes.size(); ++i)
+        {
+            auto z = (i + 1ul) * 0x9e3779b97f4a7c15ull;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            nodes[i].priority = static_cast<index_t>(z ^ (z >> 31));
+        }
+    }
+
+    /**
+     * Update the estimate with a new sample and return the new estimate.
+     */
+    value_type add(value_type const sample)
+    {
+        push(sample);
+        return get();
+    }
+
+    /**
+     * Update the estimate with a new sample.
+     */
+    void push(value_type const sample)
+    {
+        if (full()) [[likely]]
+            root = erase(root, next);
+        else
+            ++n;
+        auto& node = nodes[next];
+        node.value = sample;
+        node.left = nil;
+        node.right = nil;
+        node.size = 1u;
+        root = insert(root, next);
+        next = next + 1u == nodes.size() ? 0u : next + 1u;
+    }
+
+    /**
+     * Discard everything and reset as if default-constructed.
+     */
+    void reset()
+    {
+        root = nil;
+        n = 0u;
+        next = 0u;
+    }
+
+    /**
+     * Return the median of the current window, ie the average of the two middle samples if the size is even.
+     */
+    value_type get() const
+    {
+        if (n == 0u)
+            return value_type{};
+        return n % 2u ? nth(n / 2u) : midpoint(nth(n / 2u - 1u), nth(n / 2u));
+    }
+
+    /**
+     * Return the total number of samples currently in the window.
+     */
+    std::size_t size() const { return n; }
+
+    /**
+     * Return the number of bytes used by this estimator, including the capacity of the sample buffer.
+     */
+    std::size_t memory_usage() const { return sizeof(*this) + nodes.capacity() * sizeof(node_t); }
+
+    /**
+     * Return true if the sliding window contains exactly N samples; false otherwise.
+     */
+    bool full() const { return n == nodes.size(); }
+
+    /**
+     * Return the maximum number of samples in the window.
+     */
+    std::size_t capacity() const { return nodes.size(); }
+
+    /**
+     * Return the k-th smallest sample in the current window, starting from 0.
+     * Calling this method when `k >= size()` is undefined behaviour.
+     */
+    value_type nth(std::size_t k) const
+    {
+        assert(k < size());
+        auto t = root;
+        for (;;)
+        {
+            auto const left_size = subtree_size(nodes[t].left);
+            if (k < left_size)
+                t = nodes[t].left;
+            else if (k == left_size)
+                return nodes[t].value;
+            else
+            {
+                k -= left_size + 1u;
+                t = nodes[t].right;
+            }
+        }
+    }
+
+    /**
+     * Return the number of samples in the current window strictly less than the given value.
+     */
+    std::size_t count_less(value_type const x) const
+    {
+        std::size_t count = 0ul;
+        for (auto t = root; t != nil;)
+        {
+            if (nodes[t].value < x)
+            {
+                count += subtree_size(nodes[t].left) + 1u;
+                t = nodes[t].right;
+            }
+            else
+                t = nodes[t].left;
+        }
+        return count;
+    }
+
+    /**
+     * Return the median absolute deviation from the median of the current window,
+     * ie the median of `|x - get()|` over all samples `x` in the window.
+     */
+    value_type median_absolute_deviation() const
+    {
+        if (n == 0u)
+            return value_type{};
+        auto const median = get();
+        // deviations of the samples below the median, from the closest, and of the others, ascending
+        auto const n_below = count_less(median);
+        auto const n_above = n - n_below;
+        auto const below = [&] (std::size_t const i) { return static_cast<value_type>(median - nth(n_below - 1u - i)); };
+        auto const above = [&] (std::size_t const i) { return static_cast<value_type>(nth(n_below + i) - median); };
+        // k-th smallest deviation: binary search the number of deviations taken from below
+        auto const kth = [&] (std::size_t const k)
+        {
+            std::size_t lo = k + 1ul > n_above ? k + 1ul - n_above : 0ul;
+            std::size_t hi = std::min<std::size_t>(k + 1ul, n_below);
+            while (lo < hi)
+            {
+                auto const i = lo + (hi - lo) / 2ul;
+                if (below(i) < above(k - i))
+                    lo = i + 1ul;
+                else
+                    hi = i;
+            }
+            auto const j = k + 1ul - lo;
+            if (lo == 0ul)
+                return above(j - 1ul);
+            if (j == 0ul)
+                return below(lo - 1ul);
+            return std::max(below(lo - 1ul), above(j - 1ul));
+        };
+        return n % 2u ? kth(n / 2u) : midpoint(kth(n / 2u - 1u), kth(n / 2u));
+    }
+
+    /**
+     * Return the i-th oldest sample in the current window, starting from 0.
+     * Calling this method when `i >= size()` is undefined behaviour.
+     */
+    value_type sample(std::size_t const i) const
+    {
+        assert(i < size());
+        auto const slot = next + nodes.size() - n + i;
+        return nodes[slot < nodes.size() ? slot : slot - nodes.size()].value;
+    }
+
+    /**
+     * Return the allocator used for the window buffer.
+     */
+    allocator_type get_allocator() const { return allocator_type(nodes.get_allocator()); }
+
+    /**
+     * Save the current state to the given stream; see `Serializable`.
+     */
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type>
+    {
+        using namespace serialization;
+        write_header<value_type>(out, kind_t::sliding_window_median);
+        write(out, capacity());
+        write(out, size());
+        for (std::size_t i = 0ul; i < size(); ++i)
+            write(out, sample(i));
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved window size must match the window size of this estimator.
+     */
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type>
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type>(in, kind_t::sliding_window_median))
+            return;
+        auto const window_size = read<std::size_t>(in);
+        auto const saved_n = read<std::size_t>(in);
+        if (not in or window_size != capacity() or saved_n > window_size)
+            return fail(in);
+        for (std::size_t i = 0ul; i < saved_n; ++i)
+            push(read<value_type>(in));
+        if (not in)
+            reset();
+    }
+
+private:
+    static value_type midpoint(value_type const a, value_type const b)
+    {
+        // a <= b, so this neither overflows nor underflows unsigned types
+        return static_cast<value_type>(a + (b - a) / 2);
+    }
+
+    index_t subtree_size(index_t const t) const { return t == nil ? 0u : nodes[t].size; }
+
+    void update(index_t const t)
+    {
+        nodes[t].size = subtree_size(nodes[t].left) + subtree_size(nodes[t].right) + 1u;
+    }
+
+    /**
+     * Order nodes by value, breaking ties by slot so that every node has a unique position.
+     */
+    bool less(index_t const a, index_t const b) const
+    {
+        return nodes[a].value < nodes[b].value or (not (nodes[b].value < nodes[a].value) and a < b);
+    }
+
+    /**
+     * Split the given subtree into the nodes ordered before `key` and the others.
+     */
+    std::pair<index_t, index_t> split(index_t const t, index_t const key)
+    {
+        if (t == nil)
+            return {nil, nil};
+        if (less(t, key))
+        {
+            auto const [l, r] = split(nodes[t].right, key);
+            nodes[t].right = l;
+            update(t);
+            return {t, r};
+        }
+        auto const [l, r] = split(nodes[t].left, key);
+        nodes[t].left = r;
+        update(t);
+        return {l, t};
+    }
+
+    /**
+     * Merge two subtrees, all nodes in `a` being ordered before all nodes in `b`.
+     */
+    index_t merge(index_t const a, index_t const b)
+    {
+        if (a == nil)
+            return b;
+        if (b == nil)
+            return a;
+        if (nodes[a].priority > nodes[b].priority)
+        {
+            nodes[a].right = merge(nodes[a].right, b);
+            update(a);
+            return a;
+        }
+        nodes[b].left = merge(a, nodes[b].left);
+        update(b);
+        return b;
+    }
+
+    index_t insert(index_t const t, index_t const key)
+    {
+        if (t == nil)
+            return key;
+        if (nodes[key].priority > nodes[t].priority)
+        {
+            auto const [l, r] = split(t, key);
+            nodes[key].left = l;
+            nodes[key].right = r;
+            update(key);
+            return key;
+        }
+        if (less(key, t))
+            nodes[t].left = insert(nodes[t].left, key);
+        else
+            nodes[t].right = insert(nodes[t].right, key);
+        update(t);
+        return t;
+    }
+
+    index_t erase(index_t const t, index_t const key)
+    {
+        assert(t != nil);
+        if (t == key)
+            return merge(nodes[t].left, nodes[t].right);
+        if (less(key, t))
+            nodes[t].left = erase(nodes[t].left, key);
+        else
+            nodes[t].right = erase(nodes[t].right, key);
+        update(t);
+        return t;
+    }
+};
+// explicitly instantiated in livestats_lib for the most common sample types
+extern template class sliding_window_median_estimator_t<double>;
+extern template class sliding_window_median_estimator_t<float>;
+extern template class sliding_window_median_estimator_t<std::int64_t>;
+extern template class sliding_window_median_estimator_t<std::uint64_t>;
+static_assert(Estimator<sliding_window_median_estimator_t<double>>);
+
+namespace pmr {
+
+template <typename ValueType>
+using sliding_window_median_estimator_t =
+    livestats::sliding_window_median_estimator_t<ValueType, std::pmr::polymorphic_allocator<ValueType>>;
+
+} // namespace pmr
+
+} // namespace livestats
@@ -1,11 +1,15 @@
 #pragma once
 
 #include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
 #include "livestats/sliding_window_mean_estimator.hpp"
 
 #include "livestats/math/non_negative.hpp"
 
 #include <cassert>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
 #include <type_traits>
 
 namespace livestats {
@@ -13,18 +17,28 @@ namespace livestats {
 /**
  * Estimator to compute the variance of a sliding window with at most N samples.
  *
- * @tparam  ValueType   The type of samples, eg integer, floating point or vectorized numerical type.
+ * @tparam  ValueType       The type of samples, eg integer, floating point or vectorized numerical type.
+ * @tparam  AccumulatorType The type of the running sum and "unscaled variance"; only samples are stored in the window.
+ * @tparam  Allocator       The allocator used for the window buffer.
  */
-template <typename ValueType>
+template <
+    typename ValueType,
+    typename AccumulatorType = ValueType,
+    typename Allocator = std::allocator<ValueType>
+>
 class sliding_window_variance_estimator_t
 {
-    sliding_window_mean_estimator_t<ValueType> mean;
-    ValueType n_s = ValueType{};
+    sliding_window_mean_estimator_t<ValueType, AccumulatorType, Allocator> mean_estimator;
+    AccumulatorType n_s = AccumulatorType{};
 
 public:
     using value_type = ValueType;
+    using accumulator_type = AccumulatorType;
+    using allocator_type = Allocator;
 
-    explicit sliding_window_variance_estimator_t(std::size_t const window_size) : mean(window_size) { }
+    explicit sliding_window_variance_estimator_t(std::size_t const window_size, allocator_type const& alloc = {})
+        : mean_estimator(window_size, alloc)
+    { }
 
     /**
      * Update the estimate with a new sample and return the new estimate.
@@ -38,19 +52,22 @@ public:
     /**
      * Update the estimate with a new sample.
      */
-    void push(value_type const x)
+    void push(value_type const sample)
     {
+        accumulator_type const x = sample;
         if (full()) [[likely]]
         {
-            auto const oldest = mean.oldest();
-            auto const old_mean = mean.get();
-            auto const new_mean = mean.add(x);
+            accumulator_type const oldest = mean_estimator.oldest();
+            auto const old_mean = accumulated_mean();
+            mean_estimator.push(sample);
+            auto const new_mean = accumulated_mean();
             math::non_negative::plus_equal_a_minus_b_times_c_minus_d(n_s, x, oldest, x + oldest, new_mean + old_mean);
         }
         else
         {
-            auto const old_mean = mean.get();
-            auto const new_mean = mean.add(x);
+            auto const old_mean = accumulated_mean();
+            mean_estimator.push(sample);
+            auto const new_mean = accumulated_mean();
             math::non_negative::plus_equal_a_minus_b_times_c_minus_d(n_s, x, old_mean, x, new_mean);
         }
     }
@@ -60,8 +77,8 @@ public:
      */
     void reset()
     {
-        mean.reset();
-        n_s = value_type{};
+        mean_estimator.reset();
+        n_s = accumulator_type{};
     }
 
     /**
@@ -72,12 +89,22 @@ public:
     /**
      * Return the total number of samples currently in the window.
      */
-    std::size_t size() const { return mean.size(); }
+    std::size_t size() const { return mean_estimator.size(); }
+
+    /**
+     * Return the number of bytes used by this estimator, including the capacity of the sample buffer.
+     */
+    std::size_t memory_usage() const { return sizeof(*this) - sizeof(mean_estimator) + mean_estimator.memory_usage(); }
+
+    /**
+     * Return the mean of the current window, as tracked to compute the variance.
+     */
+    value_type mean() const { return mean_estimator.get(); }
 
     /**
      * Return true if the sliding window contains exactly N samples; false otherwise.
      */
-    bool full() const { return mean.full(); }
+    bool full() const { return mean_estimator.full(); }
 
     /**
      * Return the oldest sample in the current window.
@@ -86,10 +113,68 @@ public:
     value_type oldest() const
     {
         assert(size() > 0ul);
-        return mean.oldest();
+        return mean_estimator.oldest();
+    }
+
+    /**
+     * Return the allocator used for the window buffer.
+     */
+    allocator_type get_allocator() const { return mean_estimator.get_allocator(); }
+
+    /**
+     * Save the current state to the given stream; see `Serializable`.
+     */
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
+    {
+        using namespace serialization;
+        write_header<value_type, accumulator_type>(out, kind_t::sliding_window_variance);
+        mean_estimator.save(out);
+        write(out, n_s);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved window size must match the window size of this estimator.
+     */
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type, accumulator_type>(in, kind_t::sliding_window_variance))
+            return;
+        mean_estimator.load(in);
+        auto const saved_n_s = read<accumulator_type>(in);
+        if (in)
+            n_s = saved_n_s;
+        else
+            reset();
+    }
+
+private:
+    /**
+     * Return the mean of the current window in the (possibly wider) accumulator type.
+     */
+    accumulator_type accumulated_mean() const
+    {
+        return size() ? static_cast<accumulator_type>(mean_estimator.get_sum() / size()) : accumulator_type{};
     }
 };
+// explicitly instantiated in livestats_lib for the most common sample types
+extern template class sliding_window_variance_estimator_t<double>;
+extern template class sliding_window_variance_estimator_t<float>;
+extern template class sliding_window_variance_estimator_t<std::int64_t>;
+extern template class sliding_window_variance_estimator_t<std::uint64_t>;
 static_assert(Estimator<sliding_window_variance_estimator_t<double>>);
 
+namespace pmr {
+
+template <typename ValueType, typename AccumulatorType = ValueType>
+using sliding_window_variance_estimator_t =
+    livestats::sliding_window_variance_estimator_t<ValueType, AccumulatorType, std::pmr::polymorphic_allocator<ValueType>>;
+
+} // namespace pmr
+
 
 } // namespace livestats
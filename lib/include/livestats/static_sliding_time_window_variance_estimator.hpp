@@ -0,0 +1,311 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
+#include "livestats/sliding_time_window_tags.hpp"
+
+#include "livestats/math/moments.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+
+namespace livestats {
+
+/**
+ * Estimator to compute variance (and mean) of one or more sliding time windows holding at most N samples in total,
+ * where N is known at compile time.
+ * Like `static_sliding_window_variance_estimator_t`, samples are stored inline and this estimator never allocates,
+ * so it is trivially copyable over primitive types and can be embedded by value, eg in arrays or in shared memory
+ * via `seqlock_estimator_adaptor_t`; readers of a snapshot call `advance()` on their copy to expire old samples.
+ * When the buffer is full, the oldest sample is dropped early from all windows, as with
+ * `sliding_time_window_overflow_policy::drop_oldest`; samples older than the latest one are discarded.
+ * It assumes the sum of all samples in each time window does not overflow.
+ *
+ * @tparam  ValueType       The type of samples, eg integer, floating point or vectorized numerical type.
+ * @tparam  AccumulatorType The type of the running sum and "unscaled variance" of each window;
+ *                          only samples are stored in the buffer.
+ * @tparam  N               The maximum number of samples in the buffer, ie in the longest window.
+ * @tparam  Window1         The size of the primary sliding window, in milliseconds or as a duration, eg `250us`.
+ * @tparam  WindowN         The size of secondary sliding windows.
+ */
+template <
+    typename ValueType,
+    typename AccumulatorType,
+    std::size_t N,
+    sliding_time_window_size_t Window1,
+    sliding_time_window_size_t... WindowN
+>
+class basic_static_sliding_time_window_variance_estimator_t
+{
+    static_assert(N > 0ul, "the sample buffer must contain at least one sample");
+
+public:
+    using value_type = ValueType;
+    using accumulator_type = AccumulatorType;
+
+private:
+    using aggregate_t = math::moments_t<ValueType, AccumulatorType>;
+
+    struct sample_t
+    {
+        std::chrono::steady_clock::time_point timestamp;
+        ValueType value;
+    };
+
+    static constexpr auto primary_window = sliding_time_window_tag<Window1>;
+
+    static constexpr std::array<std::chrono::nanoseconds, 1ul + sizeof...(WindowN)> window_sizes{
+        Window1.duration(),
+        WindowN.duration()...
+    };
+
+    // ring buffer of the samples in any window, oldest first from `first`;
+    // each window spans the last `windows[i].size()` of them
+    std::array<sample_t, N> samples = {};
+    std::size_t first = 0ul;
+    std::size_t n = 0ul;
+    std::array<aggregate_t, window_sizes.size()> windows = {};
+    std::size_t n_dropped = 0ul;
+
+public:
+    /**
+     * Push a new sample in all sliding windows and retrieve the new variance of the primary window.
+     */
+    value_type add(value_type const value)
+    {
+        push(value);
+        return get();
+    }
+
+    /**
+     * Push a new sample in all sliding windows.
+     */
+    void push(value_type const value)
+    {
+        push(value, std::chrono::steady_clock::now());
+    }
+
+    /**
+     * Push a new sample in all sliding windows and advance them all to the given timestamp.
+     * Samples must be pushed in non-decreasing time order; older samples are discarded.
+     * If the buffer is full, the oldest sample is first dropped from all windows and counted by `size_dropped()`.
+     */
+    void push(value_type const value, std::chrono::steady_clock::time_point const timestamp)
+    {
+        if (n > 0ul and timestamp < at(n - 1ul).timestamp)
+            return;
+        if (n == N) [[unlikely]]
+        {
+            // the oldest sample is in all windows that span the whole buffer
+            for (auto& w: windows)
+                if (w.size() == n)
+                    w.pop(at(0ul).value);
+            first = wrap(first + 1ul);
+            --n;
+            ++n_dropped;
+        }
+        samples[wrap(first + n)] = sample_t{timestamp, value};
+        ++n;
+        for (auto& w: windows)
+            w.push(value);
+        advance(timestamp);
+    }
+
+    /**
+     * Update all sliding windows by discarding samples that fall outside of each window when compared to `now`.
+     * Invocations to this function must happen in non-decreasing time order;
+     * if `now` is older than the current latest sample, this function performs nothing.
+     */
+    void advance(std::chrono::steady_clock::time_point const now)
+    {
+        if (n == 0ul or now < at(n - 1ul).timestamp)
+            return;
+        std::size_t n_kept = 0ul; // number of samples still in at least one window
+        for (std::size_t i = 0ul; i < windows.size(); ++i)
+        {
+            auto& w = windows[i];
+            auto const t0 = now - window_sizes[i];
+            while (w.size() > 0ul)
+            {
+                auto const& oldest = at(n - w.size());
+                if (oldest.timestamp >= t0)
+                    break;
+                w.pop(oldest.value);
+            }
+            n_kept = std::max(n_kept, w.size());
+        }
+        first = wrap(first + n - n_kept);
+        n = n_kept;
+    }
+
+    /**
+     * Discard everything and reset as if default-constructed.
+     */
+    void reset()
+    {
+        first = 0ul;
+        n = 0ul;
+        for (auto& w: windows)
+            w.reset();
+        n_dropped = 0ul;
+    }
+
+    /**
+     * Return the current value of the variance of the primary window.
+     */
+    value_type get() const { return get(primary_window); }
+
+    /**
+     * Return the variance of the given time window
+     */
+    template <sliding_time_window_size_t Window>
+    value_type get(sliding_time_window_tag_t<Window> const w) const
+    {
+        return static_cast<value_type>(window(w).variance());
+    }
+
+    /**
+     * Return the mean of the primary window.
+     */
+    value_type mean() const { return mean(primary_window); }
+
+    /**
+     * Return the mean of the given time window
+     */
+    template <sliding_time_window_size_t Window>
+    value_type mean(sliding_time_window_tag_t<Window> const w) const
+    {
+        return static_cast<value_type>(window(w).mean());
+    }
+
+    /**
+     * Return the total number of samples currently in the primary window.
+     */
+    std::size_t size() const { return size(primary_window); }
+
+    /**
+     * Return the total number of samples currently in the given window.
+     */
+    template <sliding_time_window_size_t Window>
+    std::size_t size(sliding_time_window_tag_t<Window> const w) const
+    {
+        return window(w).size();
+    }
+
+    /**
+     * Return the earliest time at which `advance()` will discard some sample,
+     * or `std::chrono::steady_clock::time_point::max()` if all windows are empty.
+     */
+    std::chrono::steady_clock::time_point next_expiry() const
+    {
+        auto expiry = std::chrono::steady_clock::time_point::max();
+        for (std::size_t i = 0ul; i < windows.size(); ++i)
+            if (windows[i].size() > 0ul)
+            {
+                // samples are discarded once strictly older than the beginning of the window
+                auto const oldest = at(n - windows[i].size()).timestamp;
+                expiry = std::min(expiry, oldest + window_sizes[i] + std::chrono::steady_clock::duration(1));
+            }
+        return expiry;
+    }
+
+    /**
+     * Return the total number of samples currently stored in the internal buffer.
+     */
+    std::size_t sample_buffer_size() const { return n; }
+
+    /**
+     * Return the maximum number of samples in the internal buffer, ie N.
+     */
+    static constexpr std::size_t capacity() { return N; }
+
+    /**
+     * Return the number of samples dropped early because the internal buffer was full.
+     */
+    std::size_t size_dropped() const { return n_dropped; }
+
+    /**
+     * Return the number of bytes used by this estimator; samples are stored inline.
+     */
+    std::size_t memory_usage() const { return sizeof(*this); }
+
+    /**
+     * Save the current state, including all samples in the internal buffer, to the given stream;
+     * see `Serializable`.
+     */
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
+    {
+        using namespace serialization;
+        write_header<value_type, accumulator_type>(out, kind_t::static_sliding_time_window_variance);
+        write(out, window_sizes);
+        write(out, n);
+        for (std::size_t i = 0ul; i < n; ++i)
+        {
+            write(out, at(i).timestamp);
+            write(out, at(i).value);
+        }
+        write(out, windows);
+        write(out, n_dropped);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved window sizes must match the window sizes of this estimator, and the saved samples must fit in N.
+     */
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type, accumulator_type>(in, kind_t::static_sliding_time_window_variance))
+            return;
+        auto const saved_window_sizes = read<std::remove_const_t<decltype(window_sizes)>>(in);
+        auto const saved_n = read<std::size_t>(in);
+        if (not in or saved_window_sizes != window_sizes or saved_n > N)
+            return fail(in);
+        for (; n < saved_n; ++n)
+        {
+            samples[n].timestamp = read<std::chrono::steady_clock::time_point>(in);
+            samples[n].value = read<value_type>(in);
+        }
+        windows = read<decltype(windows)>(in);
+        n_dropped = read<std::size_t>(in);
+        auto const valid = [this] (aggregate_t const& w) { return w.size() <= n; };
+        if (not in or not std::all_of(windows.begin(), windows.end(), valid))
+        {
+            reset();
+            fail(in);
+        }
+    }
+
+private:
+    static constexpr std::size_t wrap(std::size_t const i) { return i < N ? i : i - N; }
+
+    /**
+     * Return the i-th oldest sample in the buffer.
+     */
+    sample_t const& at(std::size_t const i) const { return samples[wrap(first + i)]; }
+
+    template <sliding_time_window_size_t Window>
+    aggregate_t const& window(sliding_time_window_tag_t<Window>) const
+    {
+        return windows[sliding_time_window_index<Window, Window1, WindowN...>()];
+    }
+};
+
+/**
+ * Estimator to compute variance (and mean) of one or more sliding time windows holding at most N samples,
+ * accumulating sums in `ValueType` itself.
+ */
+template <typename ValueType, std::size_t N, sliding_time_window_size_t Window1, sliding_time_window_size_t... WindowN>
+using static_sliding_time_window_variance_estimator_t =
+    basic_static_sliding_time_window_variance_estimator_t<ValueType, ValueType, N, Window1, WindowN...>;
+static_assert(Estimator<static_sliding_time_window_variance_estimator_t<double, 1ul, 1ul>>);
+static_assert(MeanVarianceEstimator<static_sliding_time_window_variance_estimator_t<double, 1ul, 1ul>>);
+static_assert(std::is_trivially_copyable_v<static_sliding_time_window_variance_estimator_t<double, 1ul, 1ul>>);
+
+} // namespace livestats
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+namespace livestats {
+
+/**
+ * Estimator to compute the mean of a sliding window with at most N samples, where N is known at compile time.
+ * Samples are stored inline, so this estimator never allocates and can be embedded by value, eg in arrays
+ * or in shared memory; if N is a power of two, positions in the window are computed with a bit mask.
+ * It assumes the sum of all samples in the current slidiing window does not overflow.
+ *
+ * @tparam  ValueType       The type of samples, eg integer, floating point or vectorized numerical type.
+ * @tparam  N               The maximum number of samples in the sliding window.
+ * @tparam  AccumulatorType The type of the running sum; only samples are stored in the window.
+ */
+template <typename ValueType, std::size_t N, typename AccumulatorType = ValueType>
+class static_sliding_window_mean_estimator_t
+{
+    static_assert(N > 0ul, "the sliding window must contain at least one sample");
+
+    std::array<ValueType, N> samples = {};
+    std::size_t n = 0ul; // number of samples in the window
+    std::size_t next = 0ul; // position of the next sample, which is also the position of the oldest one when full
+    AccumulatorType sum = AccumulatorType{};
+
+public:
+    using value_type = ValueType;
+    using accumulator_type = AccumulatorType;
+
+    /**
+     * Update the estimate with a new sample and return the new estimate.
+     */
+    value_type add(value_type const sample)
+    {
+        push(sample);
+        return get();
+    }
+
+    /**
+     * Update the estimate with a new sample.
+     */
+    void push(value_type const sample)
+    {
+        if (full()) [[likely]]
+            sum -= samples[next];
+        else
+            ++n;
+        samples[next] = sample;
+        sum += sample;
+        next = wrap(next + 1ul);
+    }
+
+    /**
+     * Discard everything and reset as if default-constructed.
+     */
+    void reset()
+    {
+        n = 0ul;
+        next = 0ul;
+        sum = accumulator_type{};
+    }
+
+    /**
+     * Return the current value of the mean.
+     */
+    value_type get() const { return n ? static_cast<value_type>(sum / n) : value_type{}; }
+
+    /**
+     * Return the total number of samples currently in the window.
+     */
+    std::size_t size() const { return n; }
+
+    /**
+     * Return the number of bytes used by this estimator; samples are stored inline.
+     */
+    std::size_t memory_usage() const { return sizeof(*this); }
+
+    /**
+     * Return the maximum number of samples in the window, ie N.
+     */
+    static constexpr std::size_t capacity() { return N; }
+
+    /**
+     * Return true if the sliding window contains exactly N samples; false otherwise.
+     */
+    bool full() const { return n == N; }
+
+    /**
+     * Return the oldest sample in the current window.
+     * Calling this method when `size() == 0` is undefined behaviour.
+     */
+    value_type oldest() const
+    {
+        assert(size() > 0ul);
+        return samples[wrap(next + N - n)];
+    }
+
+    /**
+     * Return the sum of all samples in the current window.
+     */
+    accumulator_type get_sum() const { return sum; }
+
+    /**
+     * Save the current state to the given stream; see `Serializable`.
+     */
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
+    {
+        using namespace serialization;
+        write_header<value_type, accumulator_type>(out, kind_t::static_sliding_window_mean);
+        write(out, N);
+        write(out, n);
+        for (std::size_t i = 0ul; i < n; ++i)
+            write(out, samples[wrap(next + N - n + i)]);
+        write(out, sum);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved window size must match N.
+     */
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type, accumulator_type>(in, kind_t::static_sliding_window_mean))
+            return;
+        auto const window_size = read<std::size_t>(in);
+        auto const saved_n = read<std::size_t>(in);
+        if (not in or window_size != N or saved_n > N)
+            return fail(in);
+        for (std::size_t i = 0ul; i < saved_n; ++i)
+            samples[i] = read<value_type>(in);
+        auto const saved_sum = read<accumulator_type>(in);
+        if (in)
+        {
+            n = saved_n;
+            next = wrap(saved_n);
+            sum = saved_sum;
+        }
+    }
+
+private:
+    /**
+     * Map a position in `[0, 2N)` back into `[0, N)`.
+     */
+    static constexpr std::size_t wrap(std::size_t const i)
+    {
+        if constexpr (std::has_single_bit(N))
+            return i & (N - 1ul);
+        else
+            return i < N ? i : i - N;
+    }
+};
+static_assert(Estimator<static_sliding_window_mean_estimator_t<double, 1ul>>);
+
+
+} // namespace livestats
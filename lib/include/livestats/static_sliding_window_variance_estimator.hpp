@@ -0,0 +1,156 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
+#include "livestats/static_sliding_window_mean_estimator.hpp"
+
+#include "livestats/math/non_negative.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+namespace livestats {
+
+/**
+ * Estimator to compute the variance of a sliding window with at most N samples, where N is known at compile time.
+ * Like `static_sliding_window_mean_estimator_t`, samples are stored inline and this estimator never allocates.
+ *
+ * @tparam  ValueType       The type of samples, eg integer, floating point or vectorized numerical type.
+ * @tparam  N               The maximum number of samples in the sliding window.
+ * @tparam  AccumulatorType The type of the running sum and "unscaled variance"; only samples are stored in the window.
+ */
+template <typename ValueType, std::size_t N, typename AccumulatorType = ValueType>
+class static_sliding_window_variance_estimator_t
+{
+    static_sliding_window_mean_estimator_t<ValueType, N, AccumulatorType> mean_estimator;
+    AccumulatorType n_s = AccumulatorType{};
+
+public:
+    using value_type = ValueType;
+    using accumulator_type = AccumulatorType;
+
+    /**
+     * Update the estimate with a new sample and return the new estimate.
+     */
+    value_type add(value_type const x)
+    {
+        push(x);
+        return get();
+    }
+
+    /**
+     * Update the estimate with a new sample.
+     */
+    void push(value_type const sample)
+    {
+        accumulator_type const x = sample;
+        if (full()) [[likely]]
+        {
+            accumulator_type const oldest = mean_estimator.oldest();
+            auto const old_mean = accumulated_mean();
+            mean_estimator.push(sample);
+            auto const new_mean = accumulated_mean();
+            math::non_negative::plus_equal_a_minus_b_times_c_minus_d(n_s, x, oldest, x + oldest, new_mean + old_mean);
+        }
+        else
+        {
+            auto const old_mean = accumulated_mean();
+            mean_estimator.push(sample);
+            auto const new_mean = accumulated_mean();
+            math::non_negative::plus_equal_a_minus_b_times_c_minus_d(n_s, x, old_mean, x, new_mean);
+        }
+    }
+
+    /**
+     * Discard everything and reset as if default-constructed.
+     */
+    void reset()
+    {
+        mean_estimator.reset();
+        n_s = accumulator_type{};
+    }
+
+    /**
+     * Return the current value of the variance.
+     */
+    value_type get() const { return size() ? static_cast<value_type>(n_s / size()) : value_type{}; }
+
+    /**
+     * Return the total number of samples currently in the window.
+     */
+    std::size_t size() const { return mean_estimator.size(); }
+
+    /**
+     * Return the number of bytes used by this estimator; samples are stored inline.
+     */
+    std::size_t memory_usage() const { return sizeof(*this); }
+
+    /**
+     * Return the mean of the current window, as tracked to compute the variance.
+     */
+    value_type mean() const { return mean_estimator.get(); }
+
+    /**
+     * Return the maximum number of samples in the window, ie N.
+     */
+    static constexpr std::size_t capacity() { return N; }
+
+    /**
+     * Return true if the sliding window contains exactly N samples; false otherwise.
+     */
+    bool full() const { return mean_estimator.full(); }
+
+    /**
+     * Return the oldest sample in the current window.
+     * Calling this method when `size() == 0` is undefined behaviour.
+     */
+    value_type oldest() const
+    {
+        assert(size() > 0ul);
+        return mean_estimator.oldest();
+    }
+
+    /**
+     * Save the current state to the given stream; see `Serializable`.
+     */
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
+    {
+        using namespace serialization;
+        write_header<value_type, accumulator_type>(out, kind_t::static_sliding_window_variance);
+        mean_estimator.save(out);
+        write(out, n_s);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved window size must match N.
+     */
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type> and serialization::Trivial<accumulator_type>
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type, accumulator_type>(in, kind_t::static_sliding_window_variance))
+            return;
+        mean_estimator.load(in);
+        auto const saved_n_s = read<accumulator_type>(in);
+        if (in)
+            n_s = saved_n_s;
+        else
+            reset();
+    }
+
+private:
+    /**
+     * Return the mean of the current window in the (possibly wider) accumulator type.
+     */
+    accumulator_type accumulated_mean() const
+    {
+        return size() ? static_cast<accumulator_type>(mean_estimator.get_sum() / size()) : accumulator_type{};
+    }
+};
+static_assert(Estimator<static_sliding_window_variance_estimator_t<double, 1ul>>);
+
+
+} // namespace livestats
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
+
+#include "livestats/math/co_moments.hpp"
+
+namespace livestats {
+
+/**
+ * Incrementally computes the covariance of two sequences observed as pairs `(x, y)`,
+ * along with the correlation and the ordinary least squares regression of `y` on `x`,
+ * by updating running means and co-moments with each new pair.
+ * Two estimators, eg filled by different threads, can be combined via `merge()`.
+ *
+ * @tparam  ValueType   The type of samples; it must be signed, eg floating point.
+ */
+template <typename ValueType>
+class welford_covariance_estimator_t
+{
+    math::co_moments_t<ValueType> moments;
+
+public:
+    using value_type = ValueType;
+
+    /**
+     * Update the estimate with a new pair and return the new covariance.
+     */
+    value_type add(value_type const x, value_type const y)
+    {
+        push(x, y);
+        return get();
+    }
+
+    /**
+     * Update the estimate with a new pair.
+     */
+    void push(value_type const x, value_type const y) { moments.push(x, y); }
+
+    /**
+     * Update the estimate with all the pairs observed by another estimator.
+     */
+    void merge(welford_covariance_estimator_t const& other) { moments.merge(other.moments); }
+
+    /**
+     * Discard everything and reset as if default-constructed.
+     */
+    void reset() { moments.reset(); }
+
+    /**
+     * Return the current value of the covariance, without performing any computation.
+     */
+    value_type get() const { return moments.covariance(); }
+
+    /**
+     * Return the total number of pairs observed so far.
+     */
+    std::size_t size() const { return moments.n; }
+
+    /**
+     * Return the number of bytes used by this estimator, which owns no buffer.
+     */
+    std::size_t memory_usage() const { return sizeof(*this); }
+
+    /**
+     * Return the covariance of `x` and `y`, same as `get()`.
+     */
+    value_type covariance() const { return moments.covariance(); }
+
+    /**
+     * Return the Pearson correlation coefficient of `x` and `y`, or 0 if either has no variance.
+     */
+    value_type correlation() const { return moments.correlation(); }
+
+    /**
+     * Return the slope of the least squares fit `y = slope*x + intercept`, eg the beta of `y` relative to `x`.
+     */
+    value_type slope() const { return moments.slope(); }
+
+    /**
+     * Return the intercept of the least squares fit `y = slope*x + intercept`.
+     */
+    value_type intercept() const { return moments.intercept(); }
+
+    value_type mean_x() const { return moments.mean_x; }
+    value_type mean_y() const { return moments.mean_y; }
+    value_type variance_x() const { return moments.variance_x(); }
+    value_type variance_y() const { return moments.variance_y(); }
+
+    /**
+     * Save the current state to the given stream; see `Serializable`.
+     */
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type>
+    {
+        serialization::write_header<value_type>(out, serialization::kind_t::welford_covariance);
+        serialization::write(out, moments);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     */
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type>
+    {
+        reset();
+        if (not serialization::read_header<value_type>(in, serialization::kind_t::welford_covariance))
+            return;
+        auto const saved = serialization::read<math::co_moments_t<value_type>>(in);
+        if (in)
+            moments = saved;
+    }
+};
+// explicitly instantiated in livestats_lib for the most common sample types
+extern template class welford_covariance_estimator_t<double>;
+extern template class welford_covariance_estimator_t<float>;
+static_assert(BivariateEstimator<welford_covariance_estimator_t<double>>);
+
+} // namespace livestats
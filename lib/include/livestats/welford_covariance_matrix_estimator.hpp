@@ -0,0 +1,330 @@
+#pragma once
+
+#include "livestats/serialization.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace livestats {
+
+/**
+ * Incrementally computes the covariance matrix of a sequence of D-dimensional observations,
+ * eg the returns of D series sampled together; it is the matrix generalisation of `welford_variance_estimator_t`.
+ * It keeps the running mean of each dimension and the co-moments of each pair of dimensions,
+ * stored as the packed upper triangle of the symmetric matrix, row by row, so that every update is
+ * a sequence of contiguous, vectorizable multiply-adds over the rows of the triangle.
+ * Each observation is a rank-1 update in O(D^2); `push_block()` folds several observations at once as a rank-k update,
+ * reusing each row of the triangle while it is in cache, and `merge()` combines estimators filled by different shards.
+ *
+ * @tparam  ValueType   The type of samples; it must be floating point.
+ * @tparam  Dimensions  The number of dimensions D, or `std::dynamic_extent` to give it at construction.
+ *                      With a compile-time D, the state is stored inline, so large matrices should not live on the stack.
+ * @tparam  Allocator   The allocator used for the state with a runtime D; unused otherwise.
+ */
+template <
+    std::floating_point ValueType,
+    std::size_t Dimensions = std::dynamic_extent,
+    typename Allocator = std::allocator<ValueType>
+>
+class welford_covariance_matrix_estimator_t
+{
+public:
+    using value_type = ValueType;
+    using allocator_type = Allocator;
+
+    /**
+     * Number of observations folded together by each rank-k update of `push_block()`.
+     */
+    static constexpr std::size_t block_size = 8ul;
+
+private:
+    static constexpr bool dynamic = Dimensions == std::dynamic_extent;
+
+    template <std::size_t N>
+    using buffer_t = std::conditional_t<dynamic, std::vector<value_type, allocator_type>, std::array<value_type, N>>;
+
+    static constexpr std::size_t packed_size(std::size_t const d) { return d * (d + 1ul) / 2ul; }
+
+    std::size_t n = 0ul;
+    buffer_t<dynamic ? 0ul : Dimensions> means;
+    buffer_t<dynamic ? 0ul : packed_size(Dimensions)> co_moments; // packed upper triangle, row by row
+    // one centered observation per row, plus the difference of means; only used within a single update
+    buffer_t<dynamic ? 0ul : (block_size + 1ul) * Dimensions> scratch;
+
+public:
+    welford_covariance_matrix_estimator_t()
+        requires (not dynamic)
+        : means{}, co_moments{}, scratch{}
+    { }
+
+    explicit welford_covariance_matrix_estimator_t(std::size_t const dimensions, allocator_type const& alloc = {})
+        requires dynamic
+        : means(dimensions, value_type{}, alloc)
+        , co_moments(packed_size(dimensions), value_type{}, alloc)
+        , scratch((block_size + 1ul) * dimensions, value_type{}, alloc)
+    { }
+
+    /**
+     * Update the estimate with a new observation of `dimensions()` values.
+     */
+    void push(std::span<value_type const> const x)
+    {
+        assert(x.size() == dimensions());
+        auto const d = dimensions();
+        auto* const delta = scratch.data();
+        ++n;
+        auto const inv_n = value_type{1} / static_cast<value_type>(n);
+        for (std::size_t i = 0ul; i < d; ++i)
+        {
+            delta[i] = x[i] - means[i];
+            means[i] += delta[i] * inv_n;
+        }
+        // (x_i - old mean_i) * (x_j - new mean_j) == (n - 1)/n * delta_i * delta_j
+        auto const weight = static_cast<value_type>(n - 1ul) * inv_n;
+        auto* row = co_moments.data();
+        for (std::size_t i = 0ul; i < d; row += d - i, ++i)
+        {
+            auto const a = weight * delta[i];
+            for (std::size_t j = i; j < d; ++j)
+                row[j - i] += a * delta[j];
+        }
+    }
+
+    /**
+     * Update the estimate with a block of observations stored one after the other,
+     * ie a row-major matrix with `dimensions()` columns.
+     * Every `block_size` observations are centered on their own mean and folded into the co-moments at once,
+     * which is faster than pushing them one by one and numerically equivalent.
+     */
+    void push_block(std::span<value_type const> const observations)
+    {
+        auto const d = dimensions();
+        assert(d > 0ul and observations.size() % d == 0ul);
+        for (std::size_t first = 0ul; first < observations.size(); first += block_size * d)
+        {
+            auto const k = std::min(block_size, (observations.size() - first) / d);
+            fold(observations.subspan(first, k * d), k);
+        }
+    }
+
+    /**
+     * Update the estimate with all the observations of another estimator with the same number of dimensions.
+     */
+    void merge(welford_covariance_matrix_estimator_t const& other)
+    {
+        assert(other.dimensions() == dimensions());
+        if (other.n == 0ul)
+            return;
+        auto const d = dimensions();
+        auto* const delta = scratch.data();
+        auto const total = n + other.n;
+        auto const ratio = static_cast<value_type>(other.n) / static_cast<value_type>(total);
+        auto const weight = static_cast<value_type>(n) * ratio;
+        for (std::size_t i = 0ul; i < d; ++i)
+        {
+            delta[i] = other.means[i] - means[i];
+            means[i] += delta[i] * ratio;
+        }
+        auto* row = co_moments.data();
+        auto const* other_row = other.co_moments.data();
+        for (std::size_t i = 0ul; i < d; row += d - i, other_row += d - i, ++i)
+        {
+            auto const a = weight * delta[i];
+            for (std::size_t j = i; j < d; ++j)
+                row[j - i] += other_row[j - i] + a * delta[j];
+        }
+        n = total;
+    }
+
+    /**
+     * Discard everything and reset as if just constructed.
+     */
+    void reset()
+    {
+        n = 0ul;
+        std::fill(means.begin(), means.end(), value_type{});
+        std::fill(co_moments.begin(), co_moments.end(), value_type{});
+    }
+
+    /**
+     * Return the total number of observations so far.
+     */
+    std::size_t size() const { return n; }
+
+    /**
+     * Return the number of dimensions of each observation.
+     */
+    std::size_t dimensions() const { return means.size(); }
+
+    /**
+     * Return the current mean of each dimension.
+     */
+    std::span<value_type const> mean() const { return means; }
+
+    /**
+     * Return the current mean of the given dimension.
+     */
+    value_type mean(std::size_t const i) const { return means[i]; }
+
+    /**
+     * Return the current covariance of the given pair of dimensions, in any order.
+     */
+    value_type covariance(std::size_t const i, std::size_t const j) const
+    {
+        return n > 0ul ? co_moments[index(i, j)] / static_cast<value_type>(n) : value_type{};
+    }
+
+    /**
+     * Return the current variance of the given dimension.
+     */
+    value_type variance(std::size_t const i) const { return covariance(i, i); }
+
+    /**
+     * Return the Pearson correlation coefficient of the given pair of dimensions,
+     * or 0 if either of them has no variance.
+     */
+    value_type correlation(std::size_t const i, std::size_t const j) const
+    {
+        auto const denominator = std::sqrt(co_moments[index(i, i)] * co_moments[index(j, j)]);
+        return denominator > value_type{} ? co_moments[index(i, j)] / denominator : value_type{};
+    }
+
+    /**
+     * Write the full covariance matrix, row-major, to the given span of `dimensions()^2` values.
+     */
+    void covariance_matrix(std::span<value_type> const out) const
+    {
+        auto const d = dimensions();
+        assert(out.size() == d * d);
+        auto const inv_n = n > 0ul ? value_type{1} / static_cast<value_type>(n) : value_type{};
+        auto const* row = co_moments.data();
+        for (std::size_t i = 0ul; i < d; row += d - i, ++i)
+            for (std::size_t j = i; j < d; ++j)
+                out[i * d + j] = out[j * d + i] = row[j - i] * inv_n;
+    }
+
+    /**
+     * Return the number of bytes used by this estimator, including its state with a runtime D.
+     */
+    std::size_t memory_usage() const
+    {
+        if constexpr (dynamic)
+            return sizeof(*this) + (means.capacity() + co_moments.capacity() + scratch.capacity()) * sizeof(value_type);
+        else
+            return sizeof(*this);
+    }
+
+    /**
+     * Return the allocator used for the state.
+     */
+    allocator_type get_allocator() const
+        requires dynamic
+    {
+        return means.get_allocator();
+    }
+
+    /**
+     * Save the current state to the given stream; see `Serializable`.
+     */
+    void save(std::ostream& out) const
+    {
+        using namespace serialization;
+        write_header<value_type>(out, kind_t::welford_covariance_matrix);
+        write(out, dimensions());
+        write(out, n);
+        for (auto const x: means)
+            write(out, x);
+        for (auto const x: co_moments)
+            write(out, x);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     * The saved number of dimensions must match the number of dimensions of this estimator.
+     */
+    void load(std::istream& in)
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type>(in, kind_t::welford_covariance_matrix))
+            return;
+        auto const d = read<std::size_t>(in);
+        if (not in or d != dimensions())
+            return fail(in);
+        n = read<std::size_t>(in);
+        for (auto& x: means)
+            x = read<value_type>(in);
+        for (auto& x: co_moments)
+            x = read<value_type>(in);
+        if (not in)
+            reset();
+    }
+
+private:
+    std::size_t index(std::size_t i, std::size_t j) const
+    {
+        if (i > j)
+            std::swap(i, j);
+        return i * dimensions() - i * (i - 1ul) / 2ul + (j - i);
+    }
+
+    /**
+     * Fold `k` observations into the state as a single rank-k update, via the pairwise formula of Chan et al.
+     */
+    void fold(std::span<value_type const> const block, std::size_t const k)
+    {
+        auto const d = dimensions();
+        auto* const centered = scratch.data();
+        auto* const delta = centered + k * d;
+        auto const inv_k = value_type{1} / static_cast<value_type>(k);
+        for (std::size_t j = 0ul; j < d; ++j)
+        {
+            auto block_mean = value_type{};
+            for (std::size_t r = 0ul; r < k; ++r)
+                block_mean += block[r * d + j];
+            block_mean *= inv_k;
+            for (std::size_t r = 0ul; r < k; ++r)
+                centered[r * d + j] = block[r * d + j] - block_mean;
+            delta[j] = block_mean - means[j];
+        }
+        auto const total = n + k;
+        auto const ratio = static_cast<value_type>(k) / static_cast<value_type>(total);
+        auto const weight = static_cast<value_type>(n) * ratio;
+        for (std::size_t j = 0ul; j < d; ++j)
+            means[j] += delta[j] * ratio;
+        // the difference of means is one more row of the update, weighted by n*k/(n + k)
+        auto* row = co_moments.data();
+        for (std::size_t i = 0ul; i < d; row += d - i, ++i)
+            for (std::size_t r = 0ul; r <= k; ++r)
+            {
+                auto const* c = centered + r * d;
+                auto const a = r < k ? c[i] : weight * c[i];
+                for (std::size_t j = i; j < d; ++j)
+                    row[j - i] += a * c[j];
+            }
+        n = total;
+    }
+};
+// explicitly instantiated in livestats_lib for the most common sample types
+extern template class welford_covariance_matrix_estimator_t<double>;
+extern template class welford_covariance_matrix_estimator_t<float>;
+
+namespace pmr {
+
+template <std::floating_point ValueType>
+using welford_covariance_matrix_estimator_t = livestats::welford_covariance_matrix_estimator_t<
+    ValueType, std::dynamic_extent, std::pmr::polymorphic_allocator<ValueType>>;
+
+} // namespace pmr
+
+} // namespace livestats
@@ -4,6 +4,7 @@
 #include <cstdint>
 
 #include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
 
 namespace livestats {
 
@@ -69,7 +70,44 @@ public:
      * Return the total number of samples observed so far.
      */
     std::size_t size() const { return n; }
+
+    /**
+     * Return the number of bytes used by this estimator, which owns no buffer.
+     */
+    std::size_t memory_usage() const { return sizeof(*this); }
+
+    /**
+     * Save the current state to the given stream; see `Serializable`.
+     */
+    void save(std::ostream& out) const requires serialization::Trivial<value_type>
+    {
+        serialization::write_header<value_type>(out, serialization::kind_t::welford_mean);
+        serialization::write(out, n);
+        serialization::write(out, mean);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     */
+    void load(std::istream& in) requires serialization::Trivial<value_type>
+    {
+        reset();
+        if (not serialization::read_header<value_type>(in, serialization::kind_t::welford_mean))
+            return;
+        auto const saved_n = serialization::read<std::size_t>(in);
+        auto const saved_mean = serialization::read<value_type>(in);
+        if (in)
+        {
+            n = saved_n;
+            mean = saved_mean;
+        }
+    }
 };
+// explicitly instantiated in livestats_lib for the most common sample types
+extern template class welford_mean_estimator_t<double>;
+extern template class welford_mean_estimator_t<float>;
+extern template class welford_mean_estimator_t<std::int64_t>;
+extern template class welford_mean_estimator_t<std::uint64_t>;
 static_assert(Estimator<welford_mean_estimator_t<double>>);
 
 } // namespace livestats
@@ -4,6 +4,7 @@
 #include <cstdint>
 
 #include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
 #include "livestats/welford_mean_estimator.hpp"
 
 #include "livestats/math/non_negative.hpp"
@@ -20,7 +21,7 @@ namespace livestats {
 template <typename ValueType, typename MeanEstimatorType = welford_mean_estimator_t<ValueType>>
 class welford_variance_estimator_t
 {
-    MeanEstimatorType mean;
+    MeanEstimatorType mean_estimator;
     ValueType n_s = ValueType{};
 
 public:
@@ -40,8 +41,8 @@ public:
      */
     void push(value_type const x)
     {
-        auto const old_mean = mean.get();
-        auto const new_mean = mean.add(x);
+        auto const old_mean = mean_estimator.get();
+        auto const new_mean = mean_estimator.add(x);
         math::non_negative::plus_equal_a_minus_b_times_c_minus_d(n_s, x, old_mean, x, new_mean);
     }
 
@@ -50,7 +51,7 @@ public:
      */
     void reset()
     {
-        mean.reset();
+        mean_estimator.reset();
         n_s = value_type{};
     }
 
@@ -63,8 +64,54 @@ public:
     /**
      * Return the total number of samples observed so far.
      */
-    std::size_t size() const { return mean.size(); }
+    std::size_t size() const { return mean_estimator.size(); }
+
+    /**
+     * Return the number of bytes used by this estimator, including the mean estimator.
+     */
+    std::size_t memory_usage() const
+    {
+        return sizeof(*this) - sizeof(mean_estimator) + livestats::memory_usage(mean_estimator);
+    }
+
+    /**
+     * Return the current value of the mean, as tracked to compute the variance.
+     */
+    value_type mean() const { return mean_estimator.get(); }
+
+    /**
+     * Save the current state to the given stream; see `Serializable`.
+     */
+    void save(std::ostream& out) const
+        requires serialization::Trivial<value_type> and Serializable<MeanEstimatorType>
+    {
+        serialization::write_header<value_type>(out, serialization::kind_t::welford_variance);
+        mean_estimator.save(out);
+        serialization::write(out, n_s);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     */
+    void load(std::istream& in)
+        requires serialization::Trivial<value_type> and Serializable<MeanEstimatorType>
+    {
+        reset();
+        if (not serialization::read_header<value_type>(in, serialization::kind_t::welford_variance))
+            return;
+        mean_estimator.load(in);
+        auto const saved_n_s = serialization::read<value_type>(in);
+        if (in)
+            n_s = saved_n_s;
+        else
+            reset();
+    }
 };
+// explicitly instantiated in livestats_lib for the most common sample types
+extern template class welford_variance_estimator_t<double>;
+extern template class welford_variance_estimator_t<float>;
+extern template class welford_variance_estimator_t<std::int64_t>;
+extern template class welford_variance_estimator_t<std::uint64_t>;
 static_assert(Estimator<welford_variance_estimator_t<double>>);
 
 } // namespace livestats
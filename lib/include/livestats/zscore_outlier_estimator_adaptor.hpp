@@ -1,21 +1,31 @@
 #pragma once
 
 #include "livestats/estimator.hpp"
+#include "livestats/serialization.hpp"
 #include "livestats/welford_mean_estimator.hpp"
 #include "livestats/welford_variance_estimator.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
 
 namespace livestats {
 
 /**
  * An estimator adaptor that filters outliers before pushing new samples into the underlying estimator.
- * New samples are considered outliers if they are more than 3 standard deviations away from current mean and variance.
+ * New samples are considered outliers if they are more than `threshold()` standard deviations away
+ * from current mean and variance, 3 by default.
  * In order to allow this filter to adjust to new regimes in the incoming data stream,
  * mean and variance include all discarded samples as well as all accepted samples.
+ * If the variance estimator exposes the mean it tracks (see `MeanVarianceEstimator`), that mean is reused
+ * and no separate mean estimator is stored nor updated.
  *
  * @tparam  EstimatorType       The underlying estimator being adapted.
- * @tparam  MeanValueEstimator  The estimator for the mean of all incoming data.
+ * @tparam  MeanValueEstimator  The estimator for the mean of all incoming data; unused with a `MeanVarianceEstimator`.
  * @tparam  VarianceEstimator   The estimator for the variance of all incoming data.
  */
 template <
@@ -25,15 +35,28 @@ template <
 >
 class zscore_outlier_estimator_adaptor_t
 {
+    static constexpr bool shares_mean = MeanVarianceEstimator<VarianceEstimator>;
+    struct no_mean_t { void reset() { } };
+
     EstimatorType estimator;
-    MeanValueEstimator mean;
+    [[no_unique_address]] std::conditional_t<shares_mean, no_mean_t, MeanValueEstimator> mean;
     VarianceEstimator variance;
 
     std::size_t n_discarded = 0ul;
+    typename EstimatorType::value_type z = 3;
+    typename EstimatorType::value_type z2 = 9;
 
 public:
     using value_type = typename EstimatorType::value_type;
 
+    zscore_outlier_estimator_adaptor_t() = default;
+
+    explicit zscore_outlier_estimator_adaptor_t(value_type const threshold, EstimatorType estimator = {})
+        : estimator(std::move(estimator))
+        , z(threshold)
+        , z2(threshold * threshold)
+    { }
+
     /**
      * Check if the input value is an outlier:
      *   - if not pass it to the underlying estimator and return the new result;
@@ -56,10 +79,60 @@ public:
             estimator.push(x);
         else
             ++n_discarded;
-        mean.push(x);
+        if constexpr (not shares_mean)
+            mean.push(x);
         variance.push(x);
     }
 
+    /**
+     * Filter a whole block of samples, returning the number of samples discarded from this block.
+     * Unlike repeated calls to `push()`, all samples in the block are classified against the mean and variance
+     * as they were before the block, so the baseline is refreshed once per block rather than once per sample:
+     * an outlier cannot widen the acceptance range for the samples following it in the same block,
+     * and if the filter cannot judge samples yet (no accepted sample or zero variance) the whole block is accepted.
+     * The classification is a branch-free compare-and-mask pass meant to be vectorized by the compiler;
+     * accepted samples are then compacted and pushed into the underlying estimator,
+     * and all samples are pushed into the baseline estimators.
+     */
+    std::size_t push_block(std::span<value_type const> const block)
+    {
+        constexpr std::size_t chunk_size = 256ul;
+        std::array<std::uint8_t, chunk_size> keep;
+        std::array<value_type, chunk_size> accepted;
+
+        bool const accept_all = size() == 0ul or variance.get() == value_type{};
+        auto const m = current_mean();
+        auto const v = variance.get();
+        auto const sqr = [] (auto const x) { return x*x; };
+        std::size_t n_rejected = 0ul;
+        for (std::size_t begin = 0ul; begin < block.size(); begin += chunk_size)
+        {
+            auto const chunk = block.subspan(begin, std::min(chunk_size, block.size() - begin));
+            if (accept_all)
+                std::fill_n(keep.begin(), chunk.size(), std::uint8_t{1});
+            else
+                for (std::size_t i = 0ul; i < chunk.size(); ++i)
+                    keep[i] = not (sqr(chunk[i] - m) / v > z2);
+            std::size_t n_accepted = 0ul;
+            for (std::size_t i = 0ul; i < chunk.size(); ++i)
+            {
+                accepted[n_accepted] = chunk[i];
+                n_accepted += keep[i];
+            }
+            for (std::size_t i = 0ul; i < n_accepted; ++i)
+                estimator.push(accepted[i]);
+            for (auto const x: chunk)
+            {
+                if constexpr (not shares_mean)
+                    mean.push(x);
+                variance.push(x);
+            }
+            n_rejected += chunk.size() - n_accepted;
+        }
+        n_discarded += n_rejected;
+        return n_rejected;
+    }
+
     /**
      * Discard everything and reset as if default-constructed.
      */
@@ -89,14 +162,90 @@ public:
      */
     std::size_t size_discarded() const { return n_discarded; }
 
+    /**
+     * Return the number of bytes used by this adaptor, including the buffers of the estimators it holds.
+     */
+    std::size_t memory_usage() const
+    {
+        auto const mean_usage = [&] {
+            if constexpr (shares_mean)
+                return std::size_t{0ul};
+            else
+                return livestats::memory_usage(mean) - sizeof(mean);
+        };
+        return sizeof(*this)
+            + livestats::memory_usage(estimator) - sizeof(estimator)
+            + livestats::memory_usage(variance) - sizeof(variance)
+            + mean_usage();
+    }
+
+    /**
+     * Return the number of standard deviations from the mean beyond which samples are discarded.
+     */
+    value_type threshold() const { return z; }
+
+    /**
+     * Change the number of standard deviations from the mean beyond which new samples are discarded.
+     */
+    void set_threshold(value_type const threshold)
+    {
+        z = threshold;
+        z2 = threshold * threshold;
+    }
+
+    /**
+     * Save the current state of the underlying estimator and of the outlier filter to the given stream;
+     * see `Serializable`. The threshold is configuration rather than state, so it is not saved.
+     */
+    void save(std::ostream& out) const
+        requires Serializable<EstimatorType> and Serializable<VarianceEstimator>
+            and (shares_mean or Serializable<MeanValueEstimator>)
+    {
+        using namespace serialization;
+        write_header<value_type>(out, kind_t::zscore_outlier_adaptor);
+        estimator.save(out);
+        if constexpr (not shares_mean)
+            mean.save(out);
+        variance.save(out);
+        write(out, n_discarded);
+    }
+
+    /**
+     * Discard everything and restore the state previously saved via `save()`; see `Serializable`.
+     */
+    void load(std::istream& in)
+        requires Serializable<EstimatorType> and Serializable<VarianceEstimator>
+            and (shares_mean or Serializable<MeanValueEstimator>)
+    {
+        using namespace serialization;
+        reset();
+        if (not read_header<value_type>(in, kind_t::zscore_outlier_adaptor))
+            return;
+        estimator.load(in);
+        if constexpr (not shares_mean)
+            mean.load(in);
+        variance.load(in);
+        n_discarded = read<std::size_t>(in);
+        if (not in)
+            reset();
+    }
+
 private:
     bool is_outlier(value_type const x) const
     {
         // use squared of zscore instead of normal zscore because value_type may not support sqrt and abs
         assert(variance.get() != value_type{});
         auto const sqr = [] (auto const x) { return x*x; };
-        auto const zscore2 = sqr(x - mean.get()) / variance.get();
-        return zscore2 > value_type{9};
+        auto const zscore2 = sqr(x - current_mean()) / variance.get();
+        return zscore2 > z2;
+    }
+
+    value_type current_mean() const
+    {
+        if constexpr (shares_mean)
+            return variance.mean();
+        else
+            return mean.get();
     }
 };
 static_assert(Estimator<zscore_outlier_estimator_adaptor_t<estimator_archetype_t>>);
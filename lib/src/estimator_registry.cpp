@@ -0,0 +1,83 @@
+#include "livestats/estimator_registry.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace livestats {
+
+namespace {
+
+bool is_valid_name(std::string_view const name, bool const allow_colon)
+{
+    auto const is_alpha = [] (char const c) { return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or c == '_'; };
+    auto const is_digit = [] (char const c) { return c >= '0' and c <= '9'; };
+    if (name.empty() or not (is_alpha(name.front()) or (allow_colon and name.front() == ':')))
+        return false;
+    return std::all_of(name.begin(), name.end(), [&] (char const c) {
+        return is_alpha(c) or is_digit(c) or (allow_colon and c == ':');
+    });
+}
+
+std::string render_labels(std::initializer_list<metric_label_t> const labels)
+{
+    if (labels.size() == 0ul)
+        return {};
+    std::string rendered = "{";
+    for (auto const& [name, value]: labels)
+    {
+        if (not is_valid_name(name, false))
+            throw std::invalid_argument("invalid metric label name: " + std::string(name));
+        if (rendered.size() > 1ul)
+            rendered += ',';
+        rendered += name;
+        rendered += "=\"";
+        for (auto const c: value)
+        {
+            if (c == '\\' or c == '"')
+                rendered += '\\';
+            if (c == '\n')
+                rendered += "\\n";
+            else
+                rendered += c;
+        }
+        rendered += '"';
+    }
+    rendered += '}';
+    return rendered;
+}
+
+} // namespace
+
+std::size_t estimator_registry_t::size() const
+{
+    std::size_t n = 0ul;
+    for (auto const& family: metric_families)
+        n += family.series.size();
+    return n;
+}
+
+void estimator_registry_t::add(
+    std::string_view const name,
+    std::initializer_list<metric_label_t> const labels,
+    std::string_view const help,
+    void const* const estimator,
+    reader_t const read)
+{
+    if (not is_valid_name(name, true))
+        throw std::invalid_argument("invalid metric name: " + std::string(name));
+    auto rendered = render_labels(labels);
+    auto family = std::find_if(metric_families.begin(), metric_families.end(), [&] (family_t const& f) {
+        return f.name == name;
+    });
+    if (family == metric_families.end())
+        family = metric_families.insert(metric_families.end(), family_t{std::string(name), std::string(help), {}});
+    else if (std::any_of(family->series.begin(), family->series.end(), [&] (series_t const& s) {
+        return s.labels == rendered;
+    }))
+        throw std::invalid_argument("duplicate metric: " + std::string(name) + rendered);
+    else if (family->help.empty())
+        family->help = help;
+    family->series.push_back(series_t{std::move(rendered), estimator, read});
+}
+
+} // namespace livestats
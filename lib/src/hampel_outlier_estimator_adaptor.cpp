@@ -0,0 +1 @@
+#include "livestats/hampel_outlier_estimator_adaptor.hpp"
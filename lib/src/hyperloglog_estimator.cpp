@@ -0,0 +1,7 @@
+#include "livestats/hyperloglog_estimator.hpp"
+
+namespace livestats {
+
+template class hyperloglog_estimator_t<>;
+
+} // namespace livestats
@@ -0,0 +1 @@
+#include "livestats/keyed_estimator_map.hpp"
@@ -1 +1,10 @@
 #include "livestats/naive_mean_estimator.hpp"
+
+namespace livestats {
+
+template class naive_mean_estimator_t<double>;
+template class naive_mean_estimator_t<float>;
+template class naive_mean_estimator_t<std::int64_t>;
+template class naive_mean_estimator_t<std::uint64_t>;
+
+} // namespace livestats
@@ -0,0 +1,88 @@
+#include "livestats/openmetrics_exporter.hpp"
+
+#include <charconv>
+#include <cmath>
+
+namespace livestats {
+
+namespace {
+
+constexpr std::size_t max_number_size = 32ul; // the shortest round-trip representation of any double fits
+
+void append_number(std::string& out, double const x)
+{
+    if (std::isnan(x))
+        out += "NaN";
+    else if (std::isinf(x))
+        out += x > 0.0 ? "+Inf" : "-Inf";
+    else
+    {
+        char digits[max_number_size];
+        auto const [end, error] = std::to_chars(digits, digits + max_number_size, x);
+        out.append(digits, end);
+    }
+}
+
+void append_help(std::string& out, std::string_view const help)
+{
+    for (auto const c: help)
+    {
+        if (c == '\\')
+            out += "\\\\";
+        else if (c == '\n')
+            out += "\\n";
+        else
+            out += c;
+    }
+}
+
+/**
+ * Return an upper bound of the size of the rendered text.
+ */
+std::size_t rendered_size(estimator_registry_t const& registry)
+{
+    std::size_t size = sizeof("# EOF\n");
+    for (auto const& family: registry.families())
+    {
+        size += sizeof("# TYPE  gauge\n") + family.name.size();
+        size += sizeof("# HELP  \n") + family.name.size() + 2ul * family.help.size();
+        for (auto const& series: family.series)
+            size += family.name.size() + series.labels.size() + max_number_size + sizeof(" \n");
+    }
+    return size;
+}
+
+} // namespace
+
+std::string_view openmetrics_exporter_t::scrape()
+{
+    buffer.clear();
+    if (auto const size = rendered_size(registry); size > buffer.capacity())
+        buffer.reserve(size);
+    for (auto const& family: registry.families())
+    {
+        buffer += "# TYPE ";
+        buffer += family.name;
+        buffer += " gauge\n";
+        if (not family.help.empty())
+        {
+            buffer += "# HELP ";
+            buffer += family.name;
+            buffer += ' ';
+            append_help(buffer, family.help);
+            buffer += '\n';
+        }
+        for (auto const& series: family.series)
+        {
+            buffer += family.name;
+            buffer += series.labels;
+            buffer += ' ';
+            append_number(buffer, series.value());
+            buffer += '\n';
+        }
+    }
+    buffer += "# EOF\n";
+    return buffer;
+}
+
+} // namespace livestats
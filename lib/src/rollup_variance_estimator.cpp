@@ -0,0 +1,8 @@
+#include "livestats/rollup_variance_estimator.hpp"
+
+namespace livestats {
+
+template class rollup_variance_estimator_t<double>;
+template class rollup_variance_estimator_t<float>;
+
+} // namespace livestats
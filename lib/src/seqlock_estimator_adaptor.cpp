@@ -0,0 +1 @@
+#include "livestats/seqlock_estimator_adaptor.hpp"
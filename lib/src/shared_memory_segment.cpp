@@ -0,0 +1,201 @@
+#include "livestats/shared_memory_segment.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace livestats {
+
+namespace {
+
+constexpr std::uint64_t magic = 0x6c69766573746174ul; // identifies livestats segments
+constexpr std::uint32_t version = 1u;
+constexpr std::size_t cache_line_size = 64ul; // estimators never share a cache line with each other
+
+std::size_t align_up(std::size_t const n, std::size_t const alignment)
+{
+    return (n + alignment - 1ul) / alignment * alignment;
+}
+
+[[noreturn]] void throw_errno(char const* const what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+shared_memory::segment_header_t& header_of(std::byte* const base)
+{
+    return *reinterpret_cast<shared_memory::segment_header_t*>(base);
+}
+
+shared_memory::segment_entry_t* entries_of(std::byte* const base)
+{
+    return reinterpret_cast<shared_memory::segment_entry_t*>(base + sizeof(shared_memory::segment_header_t));
+}
+
+/**
+ * Return the name of the given entry, which may not be null-terminated if the segment is corrupt.
+ */
+std::string_view entry_name(shared_memory::segment_entry_t const& entry)
+{
+    return {entry.name, ::strnlen(entry.name, sizeof(entry.name))};
+}
+
+} // namespace
+
+std::uint64_t shared_memory::type_hash(std::type_info const& type)
+{
+    // FNV-1a
+    std::uint64_t hash = 0xcbf29ce484222325ul;
+    for (auto const* c = type.name(); *c; ++c)
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 0x100000001b3ul;
+    return hash;
+}
+
+shared_memory_segment_t::shared_memory_segment_t(
+    std::string segment_name,
+    std::size_t const segment_size,
+    std::size_t const max_entries)
+    : name(std::move(segment_name))
+    , size(segment_size)
+{
+    auto const data_begin = align_up(
+        sizeof(shared_memory::segment_header_t) + max_entries * sizeof(shared_memory::segment_entry_t),
+        cache_line_size);
+    if (data_begin > size)
+        throw std::length_error("shared memory segment too small for the requested number of entries");
+    ::shm_unlink(name.c_str());
+    int const fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+        throw_errno("shm_open");
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        auto const error = errno;
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw std::system_error(error, std::generic_category(), "ftruncate");
+    }
+    void* const p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    auto const error = errno;
+    ::close(fd);
+    if (p == MAP_FAILED)
+    {
+        ::shm_unlink(name.c_str());
+        throw std::system_error(error, std::generic_category(), "mmap");
+    }
+    base = static_cast<std::byte*>(p);
+    auto& header = *::new (base) shared_memory::segment_header_t{};
+    header.max_entries = static_cast<std::uint32_t>(max_entries);
+    header.size = size;
+    header.used = data_begin;
+    header.version = version;
+    header.magic = magic;
+    header.n_entries.store(0u, std::memory_order_release);
+}
+
+shared_memory_segment_t::~shared_memory_segment_t()
+{
+    ::munmap(base, size);
+    ::shm_unlink(name.c_str());
+}
+
+void* shared_memory_segment_t::allocate(
+    std::string_view const entry_name,
+    std::uint64_t const type_hash,
+    std::size_t const n,
+    std::size_t const alignment)
+{
+    if (entry_name.size() > shared_memory::max_name_size)
+        throw std::length_error("estimator name too long for the shared memory segment");
+    auto& header = header_of(base);
+    auto const i = header.n_entries.load(std::memory_order_relaxed);
+    auto const offset = align_up(header.used, std::max(alignment, cache_line_size));
+    if (i == header.max_entries or offset + n > size)
+        throw std::bad_alloc();
+    auto& entry = entries_of(base)[i];
+    std::memset(entry.name, 0, sizeof(entry.name));
+    entry_name.copy(entry.name, entry_name.size());
+    entry.type_hash = type_hash;
+    entry.offset = offset;
+    entry.size = n;
+    header.used = offset + n;
+    return base + offset;
+}
+
+void shared_memory_segment_t::publish()
+{
+    header_of(base).n_entries.fetch_add(1u, std::memory_order_release);
+}
+
+shared_memory_segment_reader_t::shared_memory_segment_reader_t(std::string const& name)
+{
+    int const fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        throw_errno("shm_open");
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        auto const error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "fstat");
+    }
+    size = static_cast<std::size_t>(st.st_size);
+    void* const p = size ? ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    auto const error = errno;
+    ::close(fd);
+    if (p == MAP_FAILED)
+        throw std::system_error(size ? error : EINVAL, std::generic_category(), "mmap");
+    base = static_cast<std::byte const*>(p);
+    auto const& header = *reinterpret_cast<shared_memory::segment_header_t const*>(base);
+    auto const valid = size >= sizeof(header)
+        and header.magic == magic
+        and header.version == version
+        and header.size == size
+        and sizeof(header) + header.max_entries * sizeof(shared_memory::segment_entry_t) <= size;
+    if (not valid)
+    {
+        ::munmap(const_cast<std::byte*>(base), size);
+        throw std::runtime_error("not a livestats shared memory segment: " + name);
+    }
+    max_entries = header.max_entries;
+}
+
+shared_memory_segment_reader_t::~shared_memory_segment_reader_t()
+{
+    ::munmap(const_cast<std::byte*>(base), size);
+}
+
+std::vector<std::string_view> shared_memory_segment_reader_t::names() const
+{
+    auto const published = entries();
+    std::vector<std::string_view> result;
+    result.reserve(published.size());
+    for (auto const& entry: published)
+        result.emplace_back(entry_name(entry));
+    return result;
+}
+
+shared_memory::segment_entry_t const* shared_memory_segment_reader_t::find(std::string_view const name) const
+{
+    for (auto const& entry: entries())
+        if (entry_name(entry) == name)
+            return &entry;
+    return nullptr;
+}
+
+std::span<shared_memory::segment_entry_t const> shared_memory_segment_reader_t::entries() const
+{
+    auto const& header = *reinterpret_cast<shared_memory::segment_header_t const*>(base);
+    auto const n = header.n_entries.load(std::memory_order_acquire);
+    if (n > max_entries)
+        return {};
+    return {reinterpret_cast<shared_memory::segment_entry_t const*>(base + sizeof(header)), n};
+}
+
+} // namespace livestats
@@ -0,0 +1 @@
+#include "livestats/sliding_time_window_covariance_estimator.hpp"
@@ -0,0 +1 @@
+#include "livestats/sliding_time_window_hyperloglog_estimator.hpp"
@@ -0,0 +1 @@
+#include "livestats/sliding_time_window_rate_estimator.hpp"
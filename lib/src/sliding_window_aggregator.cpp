@@ -0,0 +1,8 @@
+#include "livestats/sliding_window_aggregator.hpp"
+
+namespace livestats {
+
+template class sliding_window_aggregator_t<math::max_monoid_t<double>>;
+template class sliding_window_aggregator_t<math::min_monoid_t<double>>;
+
+} // namespace livestats
@@ -0,0 +1,8 @@
+#include "livestats/sliding_window_covariance_estimator.hpp"
+
+namespace livestats {
+
+template class sliding_window_covariance_estimator_t<double>;
+template class sliding_window_covariance_estimator_t<float>;
+
+} // namespace livestats
@@ -0,0 +1,10 @@
+#include "livestats/sliding_window_median_estimator.hpp"
+
+namespace livestats {
+
+template class sliding_window_median_estimator_t<double>;
+template class sliding_window_median_estimator_t<float>;
+template class sliding_window_median_estimator_t<std::int64_t>;
+template class sliding_window_median_estimator_t<std::uint64_t>;
+
+} // namespace livestats
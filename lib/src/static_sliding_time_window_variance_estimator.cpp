@@ -0,0 +1 @@
+#include "livestats/static_sliding_time_window_variance_estimator.hpp"
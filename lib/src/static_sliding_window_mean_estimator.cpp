@@ -0,0 +1 @@
+#include "livestats/static_sliding_window_mean_estimator.hpp"
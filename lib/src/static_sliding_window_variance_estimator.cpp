@@ -0,0 +1 @@
+#include "livestats/static_sliding_window_variance_estimator.hpp"
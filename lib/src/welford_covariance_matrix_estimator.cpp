@@ -0,0 +1,8 @@
+#include "livestats/welford_covariance_matrix_estimator.hpp"
+
+namespace livestats {
+
+template class welford_covariance_matrix_estimator_t<double>;
+template class welford_covariance_matrix_estimator_t<float>;
+
+} // namespace livestats
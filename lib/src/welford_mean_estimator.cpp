@@ -1 +1,10 @@
 #include "livestats/welford_mean_estimator.hpp"
+
+namespace livestats {
+
+template class welford_mean_estimator_t<double>;
+template class welford_mean_estimator_t<float>;
+template class welford_mean_estimator_t<std::int64_t>;
+template class welford_mean_estimator_t<std::uint64_t>;
+
+} // namespace livestats
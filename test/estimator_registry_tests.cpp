@@ -0,0 +1,70 @@
+#define BOOST_TEST_MODULE estimator_registry_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/estimator_registry.hpp"
+#include "livestats/welford_mean_estimator.hpp"
+#include "livestats/welford_variance_estimator.hpp"
+
+#include <stdexcept>
+
+using mean_t = livestats::seqlock_estimator_adaptor_t<livestats::welford_mean_estimator_t<double>>;
+using variance_t = livestats::seqlock_estimator_adaptor_t<livestats::welford_variance_estimator_t<double>>;
+
+BOOST_AUTO_TEST_SUITE(estimator_registry_tests)
+
+BOOST_AUTO_TEST_CASE(families_and_labels)
+{
+    mean_t a;
+    mean_t b;
+    variance_t c;
+    livestats::estimator_registry_t registry;
+    BOOST_TEST(registry.size() == 0ul);
+
+    registry.add("price_mean", {{"instrument", "ESZ4"}, {"venue", "xcme"}}, a, "Mean price.");
+    registry.add("price_variance", {}, c);
+    registry.add("price_mean", {{"instrument", "NQZ4"}, {"venue", "xcme"}}, b);
+    BOOST_TEST(registry.size() == 3ul);
+
+    auto const& families = registry.families();
+    BOOST_TEST(families.size() == 2ul);
+    BOOST_TEST(families[0].name == "price_mean");
+    BOOST_TEST(families[0].help == "Mean price.");
+    BOOST_TEST(families[0].series.size() == 2ul);
+    BOOST_TEST(families[0].series[0].labels == R"({instrument="ESZ4",venue="xcme"})");
+    BOOST_TEST(families[0].series[1].labels == R"({instrument="NQZ4",venue="xcme"})");
+    BOOST_TEST(families[1].name == "price_variance");
+    BOOST_TEST(families[1].help == "");
+    BOOST_TEST(families[1].series[0].labels == "");
+
+    // series read consistent snapshots of the current estimates
+    a.push(1.0);
+    a.push(2.0);
+    c.push(1.0);
+    c.push(3.0);
+    BOOST_TEST(families[0].series[0].value() == 1.5);
+    BOOST_TEST(families[0].series[1].value() == 0.0);
+    BOOST_TEST(families[1].series[0].value() == 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(escape_label_values)
+{
+    mean_t a;
+    livestats::estimator_registry_t registry;
+    registry.add("m", {{"path", "C:\\tmp \"x\"\n"}}, a);
+    BOOST_TEST(registry.families()[0].series[0].labels == R"({path="C:\\tmp \"x\"\n"})");
+}
+
+BOOST_AUTO_TEST_CASE(reject_invalid_metrics)
+{
+    mean_t a;
+    livestats::estimator_registry_t registry;
+    BOOST_CHECK_THROW(registry.add("", {}, a), std::invalid_argument);
+    BOOST_CHECK_THROW(registry.add("1st", {}, a), std::invalid_argument);
+    BOOST_CHECK_THROW(registry.add("price-mean", {}, a), std::invalid_argument);
+    BOOST_CHECK_THROW(registry.add("price", {{"in:strument", "x"}}, a), std::invalid_argument);
+    registry.add("ns:price", {{"instrument", "x"}}, a);
+    BOOST_CHECK_THROW(registry.add("ns:price", {{"instrument", "x"}}, a), std::invalid_argument);
+    BOOST_TEST(registry.size() == 1ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,131 @@
+#define BOOST_TEST_MODULE hampel_outlier_estimator_adaptor_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/hampel_outlier_estimator_adaptor.hpp"
+#include "livestats/naive_mean_estimator.hpp"
+#include "livestats/zscore_outlier_estimator_adaptor.hpp"
+
+#include <sstream>
+
+template <typename T>
+using filtered_mean_estimator_t =
+    livestats::hampel_outlier_estimator_adaptor_t<
+        livestats::naive_mean_estimator_t<T>
+    >;
+
+BOOST_AUTO_TEST_SUITE(hampel_outlier_estimator_adaptor_tests)
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
+{
+    filtered_mean_estimator_t<double> filtered_mean(5ul);
+    BOOST_TEST(filtered_mean.threshold() == 3 * 1.4826);
+    BOOST_TEST(filtered_mean.get() == 0.0);
+    BOOST_TEST(filtered_mean.size() == 0ul);
+    BOOST_TEST(filtered_mean.size_discarded() == 0ul);
+
+    BOOST_TEST(filtered_mean.add(10.0) == 10.0);
+    BOOST_TEST(filtered_mean.add(11.0) == 10.5);
+    BOOST_TEST(filtered_mean.add(9.0) == 10.0);
+    BOOST_TEST(filtered_mean.size() == 3ul);
+    BOOST_TEST(filtered_mean.median() == 10.0);
+    BOOST_TEST(filtered_mean.median_absolute_deviation() == 1.0);
+
+    BOOST_TEST(filtered_mean.add(50.0) == 10.0);
+    BOOST_TEST(filtered_mean.size() == 3ul);
+    BOOST_TEST(filtered_mean.size_discarded() == 1ul);
+
+    filtered_mean.reset();
+    BOOST_TEST(filtered_mean.get() == 0.0);
+    BOOST_TEST(filtered_mean.size() == 0ul);
+    BOOST_TEST(filtered_mean.size_discarded() == 0ul);
+    BOOST_TEST(filtered_mean.median() == 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_uint64)
+{
+    filtered_mean_estimator_t<std::uint64_t> filtered_mean(5ul);
+    BOOST_TEST(filtered_mean.threshold() == 4ul);
+    for (auto const x: {10ul, 12ul, 8ul, 11ul})
+        filtered_mean.push(x);
+    BOOST_TEST(filtered_mean.get() == 10ul);
+    // median 10.5 truncated to 10, MAD 1: anything further than 4 from 10 is an outlier
+    filtered_mean.push(15ul);
+    filtered_mean.push(1ul);
+    BOOST_TEST(filtered_mean.size() == 4ul);
+    BOOST_TEST(filtered_mean.size_discarded() == 2ul);
+}
+
+BOOST_AUTO_TEST_CASE(robust_to_outlier_bursts)
+{
+    // a burst of large outliers inflates the variance used by the z-score filter, which then lets them through,
+    // while median and MAD are unaffected as long as outliers are less than half of the window
+    filtered_mean_estimator_t<double> hampel(21ul);
+    livestats::zscore_outlier_estimator_adaptor_t<livestats::naive_mean_estimator_t<double>> zscore;
+    for (int i = 0; i < 20; ++i)
+    {
+        auto const x = 10.0 + (i % 2 ? 0.5 : -0.5);
+        hampel.push(x);
+        zscore.push(x);
+    }
+    for (int i = 0; i < 5; ++i)
+    {
+        hampel.push(1000.0);
+        zscore.push(1000.0);
+    }
+    BOOST_TEST(hampel.size_discarded() == 5ul);
+    BOOST_TEST(hampel.get() == 10.0);
+    BOOST_TEST(zscore.size_discarded() < 5ul);
+}
+
+BOOST_AUTO_TEST_CASE(runtime_threshold)
+{
+    filtered_mean_estimator_t<double> strict(5ul, 1.0);
+    filtered_mean_estimator_t<double> lenient(5ul, 10.0);
+    for (auto const x: {10.0, 11.0, 9.0, 14.0})
+    {
+        strict.push(x);
+        lenient.push(x);
+    }
+    // 9 is 3 MADs away from the median of {10, 11}, and 14 is 4 MADs away from the median of {10, 11, 9}
+    BOOST_TEST(strict.size_discarded() == 2ul);
+    BOOST_TEST(lenient.size_discarded() == 0ul);
+
+    lenient.set_threshold(1.0);
+    BOOST_TEST(lenient.threshold() == 1.0);
+    lenient.push(30.0);
+    BOOST_TEST(lenient.size_discarded() == 1ul);
+}
+
+BOOST_AUTO_TEST_CASE(adapt_to_regime_changes)
+{
+    filtered_mean_estimator_t<double> filtered_mean(5ul);
+    for (auto const x: {1.0, 2.0, 3.0, 2.0, 1.0})
+        filtered_mean.push(x);
+    for (int i = 0; i < 10; ++i)
+        filtered_mean.push(i % 2 ? 100.0 : 101.0);
+    // once new regime samples are the majority of the window they are accepted
+    BOOST_TEST(filtered_mean.size_discarded() == 3ul);
+    BOOST_TEST(filtered_mean.size() == 12ul);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    filtered_mean_estimator_t<double> filtered_mean(5ul);
+    for (auto const x: {10.0, 11.0, 9.0, 50.0})
+        filtered_mean.push(x);
+    std::stringstream checkpoint;
+    filtered_mean.save(checkpoint);
+
+    filtered_mean_estimator_t<double> restored(5ul);
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.get() == 10.0);
+    BOOST_TEST(restored.size() == 3ul);
+    BOOST_TEST(restored.size_discarded() == 1ul);
+    BOOST_TEST(restored.median() == filtered_mean.median());
+    // the restored outlier filter keeps rejecting the same samples
+    BOOST_TEST(restored.add(60.0) == filtered_mean.add(60.0));
+    BOOST_TEST(restored.size_discarded() == filtered_mean.size_discarded());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
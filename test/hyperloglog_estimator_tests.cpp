@@ -0,0 +1,105 @@
+#define BOOST_TEST_MODULE hyperloglog_estimator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "livestats/hyperloglog_estimator.hpp"
+
+BOOST_AUTO_TEST_SUITE(hyperloglog_estimator_tests)
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset)
+{
+    livestats::hyperloglog_estimator_t<> hll;
+    BOOST_TEST(hll.get() == 0.0);
+    BOOST_TEST(hll.add(42ul) == 1.0, boost::test_tools::tolerance(0.01));
+    // duplicates do not change the estimate
+    hll.push(42ul);
+    hll.push(42);
+    BOOST_TEST(hll.get() == 1.0, boost::test_tools::tolerance(0.01));
+    BOOST_TEST(hll.size() == 3ul);
+    hll.reset();
+    BOOST_TEST(hll.get() == 0.0);
+    BOOST_TEST(hll.size() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(accuracy)
+{
+    livestats::hyperloglog_estimator_t<> hll;
+    for (std::uint64_t const n: {100ul, 1'000ul, 10'000ul, 100'000ul, 1'000'000ul})
+    {
+        hll.reset();
+        for (std::uint64_t i = 0ul; i < n; ++i)
+        {
+            hll.push(i);
+            hll.push(i); // duplicates
+        }
+        // well within 4 standard errors
+        auto const relative_error = std::abs(hll.get() - static_cast<double>(n)) / static_cast<double>(n);
+        BOOST_TEST(relative_error < 4.0 * hll.relative_error());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(strings)
+{
+    livestats::hyperloglog_estimator_t<14> hll;
+    for (int i = 0; i < 50'000; ++i)
+        hll.push("client-" + std::to_string(i % 20'000));
+    BOOST_TEST(hll.get() == 20'000.0, boost::test_tools::tolerance(4.0 * hll.relative_error()));
+    hll.push(std::string_view("client-1"));
+    hll.push("client-1");
+    BOOST_TEST(hll.get() == 20'000.0, boost::test_tools::tolerance(4.0 * hll.relative_error()));
+}
+
+BOOST_AUTO_TEST_CASE(merge)
+{
+    livestats::hyperloglog_estimator_t<> even_odd;
+    livestats::hyperloglog_estimator_t<> odd;
+    for (std::uint64_t i = 0ul; i < 100'000ul; ++i)
+        (i % 2ul ? odd : even_odd).push(i);
+    BOOST_TEST(even_odd.get() == 50'000.0, boost::test_tools::tolerance(4.0 * even_odd.relative_error()));
+    even_odd.merge(odd);
+    BOOST_TEST(even_odd.size() == 100'000ul);
+    BOOST_TEST(even_odd.get() == 100'000.0, boost::test_tools::tolerance(4.0 * even_odd.relative_error()));
+
+    // merging the same keys again does not change anything
+    auto const before = even_odd.get();
+    even_odd.merge(odd);
+    BOOST_TEST(even_odd.get() == before);
+}
+
+BOOST_AUTO_TEST_CASE(memory_usage)
+{
+    livestats::hyperloglog_estimator_t<> hll;
+    BOOST_TEST(hll.memory_usage() == 4096ul + sizeof(std::size_t));
+    BOOST_TEST(hll.registers().size() == 4096ul);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::hyperloglog_estimator_t<> hll;
+    for (std::uint64_t i = 0ul; i < 10'000ul; ++i)
+        hll.push(i);
+    std::stringstream checkpoint;
+    hll.save(checkpoint);
+
+    livestats::hyperloglog_estimator_t<> restored;
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.get() == hll.get());
+    BOOST_TEST(restored.size() == 10'000ul);
+    // the same keys do not change the restored estimate
+    restored.push(42ul);
+    BOOST_TEST(restored.get() == hll.get());
+
+    // state saved with a different precision cannot be restored
+    checkpoint.seekg(0);
+    livestats::hyperloglog_estimator_t<10> other;
+    other.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(other.size() == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
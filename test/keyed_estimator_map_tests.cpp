@@ -0,0 +1,208 @@
+#define BOOST_TEST_MODULE keyed_estimator_map_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/keyed_estimator_map.hpp"
+#include "livestats/sliding_window_mean_estimator.hpp"
+#include "livestats/welford_variance_estimator.hpp"
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+using variance_map_t = livestats::keyed_estimator_map_t<std::uint64_t, livestats::welford_variance_estimator_t<double>>;
+
+BOOST_AUTO_TEST_SUITE(keyed_estimator_map_tests)
+
+BOOST_AUTO_TEST_CASE(push_find_erase_clear)
+{
+    variance_map_t variances;
+    BOOST_TEST(variances.empty());
+    BOOST_TEST(variances.find(1ul) == nullptr);
+
+    variances.push(1ul, 1.0);
+    variances.push(2ul, 5.0);
+    variances.push(1ul, 3.0);
+    BOOST_TEST(variances.size() == 2ul);
+    BOOST_TEST_REQUIRE(variances.find(1ul) != nullptr);
+    BOOST_TEST(variances.find(1ul)->get() == 1.0);
+    BOOST_TEST(variances.find(1ul)->size() == 2ul);
+    BOOST_TEST(variances.find(2ul)->size() == 1ul);
+    BOOST_TEST(not variances.contains(3ul));
+
+    BOOST_TEST(variances.erase(1ul));
+    BOOST_TEST(not variances.erase(1ul));
+    BOOST_TEST(variances.size() == 1ul);
+    BOOST_TEST(not variances.contains(1ul));
+    // a new key starts from a fresh estimator
+    variances.push(1ul, 7.0);
+    BOOST_TEST(variances.find(1ul)->size() == 1ul);
+
+    variances.clear();
+    BOOST_TEST(variances.empty());
+    BOOST_TEST(not variances.contains(2ul));
+}
+
+BOOST_AUTO_TEST_CASE(match_std_map)
+{
+    // many keys, erasures and growth exercise probing and backward shift deletion
+    variance_map_t variances;
+    std::map<std::uint64_t, livestats::welford_variance_estimator_t<double>> expected;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<std::uint64_t> keys(0ul, 500ul);
+    for (int i = 0; i < 20000; ++i)
+    {
+        auto const key = keys(rng) * 1024ul; // identity hash with a common stride
+        if (i % 3 == 0)
+        {
+            BOOST_TEST_REQUIRE(variances.erase(key) == (expected.erase(key) == 1ul));
+            continue;
+        }
+        auto const x = static_cast<double>(i % 17);
+        variances.push(key, x);
+        expected[key].push(x);
+    }
+    BOOST_TEST(variances.size() == expected.size());
+    for (auto const& [key, variance]: expected)
+    {
+        BOOST_TEST_REQUIRE(variances.contains(key));
+        BOOST_TEST(variances.find(key)->get() == variance.get());
+        BOOST_TEST(variances.find(key)->size() == variance.size());
+    }
+    std::size_t n = 0ul;
+    variances.for_each([&] (std::uint64_t const key, auto const& variance)
+    {
+        BOOST_TEST(expected.at(key).size() == variance.size());
+        ++n;
+    });
+    BOOST_TEST(n == expected.size());
+}
+
+BOOST_AUTO_TEST_CASE(heterogeneous_string_keys)
+{
+    livestats::keyed_estimator_map_t<std::string, livestats::welford_variance_estimator_t<double>> variances;
+    std::string_view const endpoint = "/api/v1/orders";
+    variances.push(endpoint, 1.0);
+    variances.push("/api/v1/orders", 3.0);
+    variances.push(std::string("/health"), 1.0);
+    BOOST_TEST(variances.size() == 2ul);
+    BOOST_TEST(variances.find(endpoint)->get() == 1.0);
+    BOOST_TEST(variances.contains("/health"));
+}
+
+BOOST_AUTO_TEST_CASE(prototype_estimator)
+{
+    livestats::keyed_estimator_map_t<int, livestats::sliding_window_mean_estimator_t<double>> means(
+        0s, livestats::sliding_window_mean_estimator_t<double>(2ul));
+    for (auto const x: {1.0, 2.0, 6.0})
+        means.push(1, x);
+    means.push(2, 3.0);
+    BOOST_TEST(means.find(1)->get() == 4.0);
+    BOOST_TEST(means.find(2)->get() == 3.0);
+}
+
+BOOST_AUTO_TEST_CASE(memory_usage)
+{
+    using mean_t = livestats::sliding_window_mean_estimator_t<double>;
+    livestats::keyed_estimator_map_t<std::uint64_t, mean_t> means(0s, mean_t(100ul));
+    auto const per_estimator = 100ul * sizeof(double);
+    // the prototype and every slot hold a window buffer
+    BOOST_TEST(means.memory_usage() >= sizeof(means) + (means.capacity() + 1ul) * per_estimator);
+    auto const empty = means.memory_usage();
+    means.push(1ul, 1.0);
+    BOOST_TEST(means.memory_usage() == empty);
+    means.reserve(100ul);
+    BOOST_TEST(means.memory_usage() >= empty + (means.capacity() - 16ul) * per_estimator);
+}
+
+BOOST_AUTO_TEST_CASE(evict_idle_keys)
+{
+    variance_map_t variances(10s);
+    BOOST_TEST(variances.idle_timeout() == 10s);
+    variance_map_t::clock_type::time_point t0;
+    variances.push(1ul, 1.0, t0);
+    variances.push(2ul, 1.0, t0 + 5s);
+    variances.push(1ul, 1.0, t0 + 6s);
+    BOOST_TEST(variances.evict_idle(t0 + 12s) == 0ul);
+    BOOST_TEST(variances.evict_idle(t0 + 15s) == 1ul);
+    BOOST_TEST(not variances.contains(2ul));
+    BOOST_TEST(variances.contains(1ul));
+    BOOST_TEST(variances.evict_idle(t0 + 16s) == 1ul);
+    BOOST_TEST(variances.empty());
+
+    // without a timeout nothing is ever evicted
+    variances.set_idle_timeout(0s);
+    variances.push(1ul, 1.0, t0);
+    BOOST_TEST(variances.evict_idle(t0 + 1000s) == 0ul);
+    BOOST_TEST(variances.size() == 1ul);
+}
+
+BOOST_AUTO_TEST_CASE(evict_idle_sweeps_whole_table)
+{
+    variance_map_t variances(10ms);
+    variance_map_t::clock_type::time_point t0;
+    // keys whose home is the last slot of the initial table of 16, so that their probe chain wraps around
+    std::vector<std::uint64_t> keys;
+    for (std::uint64_t key = 0ul; keys.size() < 4ul; ++key)
+        if ((key * 0x9e3779b97f4a7c15ull) >> 60 == 15ul)
+            keys.push_back(key);
+    for (std::uint64_t key = 1000ul; keys.size() < 12ul; ++key)
+        keys.push_back(key);
+    for (auto const key: keys)
+        variances.push(key, 1.0, t0 + 1ms);
+    BOOST_TEST(variances.capacity() == 16ul);
+    BOOST_TEST(variances.size() == keys.size());
+
+    BOOST_TEST(variances.evict_idle(t0 + 1s) == keys.size());
+    BOOST_TEST(variances.size() == 0ul);
+    for (auto const key: keys)
+        BOOST_TEST(not variances.contains(key));
+
+    // evicting from the middle of a wrapping probe chain keeps the rest reachable
+    for (auto const key: keys)
+        variances.push(key, 1.0, t0 + 2s);
+    variances.push(keys[0], 1.0, t0 + 3s);
+    variances.push(keys[2], 1.0, t0 + 3s);
+    BOOST_TEST(variances.evict_idle(t0 + 3s) == keys.size() - 2ul);
+    BOOST_TEST(variances.size() == 2ul);
+    BOOST_TEST(variances.contains(keys[0]));
+    BOOST_TEST(variances.contains(keys[2]));
+}
+
+BOOST_AUTO_TEST_CASE(churning_keys_do_not_grow_the_table)
+{
+    // every key is pushed once, then stays idle: the CLOCK hand reclaims them as new keys are inserted
+    variance_map_t variances(1s);
+    variance_map_t::clock_type::time_point t;
+    for (std::uint64_t key = 0ul; key < 100000ul; ++key)
+    {
+        variances.push(key, 1.0, t);
+        t += 100ms;
+    }
+    BOOST_TEST(variances.size() < 64ul);
+    BOOST_TEST(variances.capacity() <= 64ul);
+    // recent keys are still there
+    BOOST_TEST(variances.contains(99999ul));
+    BOOST_TEST(variances.contains(99995ul));
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::array<std::byte, 16384> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    livestats::pmr::keyed_estimator_map_t<int, livestats::welford_variance_estimator_t<double>> variances(0s, {}, &arena);
+    BOOST_TEST(variances.get_allocator().resource() == &arena);
+    variances.reserve(20ul);
+    for (int key = 0; key < 20; ++key)
+        variances.push(key, 1.0);
+    BOOST_TEST(variances.size() == 20ul);
+    BOOST_TEST(variances.capacity() == 32ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
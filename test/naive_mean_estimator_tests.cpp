@@ -5,6 +5,8 @@
 
 #include "livestats/naive_mean_estimator.hpp"
 
+#include <sstream>
+
 static const auto tiny = boost::test_tools::tolerance(1e-12);
 
 BOOST_AUTO_TEST_SUITE(naive_mean_estimator_tests)
@@ -91,4 +93,42 @@ BOOST_AUTO_TEST_CASE(add_push_get_reset_multiprecision)
     BOOST_TEST(mean.size() == 2ul);
 }
 
+BOOST_AUTO_TEST_CASE(accumulate_uint32_into_int128)
+{
+    livestats::naive_mean_estimator_t<std::uint32_t, unsigned __int128> mean;
+    mean.push(4'000'000'000u);
+    mean.push(4'000'000'002u);
+    mean.push(4'000'000'004u);
+    BOOST_TEST(mean.get() == 4'000'000'002u);
+    BOOST_TEST(mean.size() == 3ul);
+
+    mean.reset();
+    BOOST_TEST(mean.get() == 0u);
+    BOOST_TEST(mean.size() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::naive_mean_estimator_t<double> mean;
+    mean.push(1.0);
+    mean.push(2.0);
+    std::stringstream checkpoint;
+    mean.save(checkpoint);
+
+    livestats::naive_mean_estimator_t<double> restored;
+    restored.push(42.0);
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.get() == 1.5);
+    BOOST_TEST(restored.size() == 2ul);
+    BOOST_TEST(restored.add(6.0) == mean.add(6.0));
+
+    // state saved with a different sample type cannot be restored
+    std::stringstream other;
+    livestats::naive_mean_estimator_t<float>{}.save(other);
+    restored.load(other);
+    BOOST_TEST(other.fail());
+    BOOST_TEST(restored.size() == 0ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,121 @@
+#define BOOST_TEST_MODULE openmetrics_exporter_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/openmetrics_exporter.hpp"
+#include "livestats/welford_mean_estimator.hpp"
+#include "livestats/welford_variance_estimator.hpp"
+
+#include <atomic>
+#include <charconv>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using mean_t = livestats::seqlock_estimator_adaptor_t<livestats::welford_mean_estimator_t<double>>;
+using variance_t = livestats::seqlock_estimator_adaptor_t<livestats::welford_variance_estimator_t<double>>;
+
+BOOST_AUTO_TEST_SUITE(openmetrics_exporter_tests)
+
+BOOST_AUTO_TEST_CASE(render_text)
+{
+    mean_t a;
+    mean_t b;
+    variance_t c;
+    livestats::estimator_registry_t registry;
+    registry.add("price_mean", {{"instrument", "ESZ4"}}, a, "Mean price,\nin USD.");
+    registry.add("price_mean", {{"instrument", "NQZ4"}}, b);
+    registry.add("price_variance", {}, c);
+    a.push(1.0);
+    a.push(2.0);
+    b.push(0.1);
+    c.push(1.0);
+    c.push(3.0);
+
+    livestats::openmetrics_exporter_t exporter(registry);
+    BOOST_TEST(exporter.scrape() ==
+        "# TYPE price_mean gauge\n"
+        "# HELP price_mean Mean price,\\nin USD.\n"
+        "price_mean{instrument=\"ESZ4\"} 1.5\n"
+        "price_mean{instrument=\"NQZ4\"} 0.1\n"
+        "# TYPE price_variance gauge\n"
+        "price_variance 1\n"
+        "# EOF\n");
+}
+
+BOOST_AUTO_TEST_CASE(render_special_values)
+{
+    mean_t a;
+    mean_t b;
+    mean_t c;
+    livestats::estimator_registry_t registry;
+    registry.add("x", {{"i", "0"}}, a);
+    registry.add("x", {{"i", "1"}}, b);
+    registry.add("x", {{"i", "2"}}, c);
+    a.push(std::numeric_limits<double>::quiet_NaN());
+    b.push(std::numeric_limits<double>::infinity());
+    c.push(-std::numeric_limits<double>::infinity());
+
+    livestats::openmetrics_exporter_t exporter(registry);
+    BOOST_TEST(exporter.scrape() ==
+        "# TYPE x gauge\n"
+        "x{i=\"0\"} NaN\n"
+        "x{i=\"1\"} +Inf\n"
+        "x{i=\"2\"} -Inf\n"
+        "# EOF\n");
+}
+
+BOOST_AUTO_TEST_CASE(reuse_buffer)
+{
+    mean_t a;
+    livestats::estimator_registry_t registry;
+    registry.add("x", {}, a);
+    livestats::openmetrics_exporter_t exporter(registry);
+    auto const first = exporter.scrape();
+    auto const capacity = exporter.capacity();
+
+    // values with the longest representation fit in the buffer sized by the first scrape
+    a.push(-1.2345678901234567e-300);
+    auto const second = exporter.scrape();
+    BOOST_TEST(second == "# TYPE x gauge\nx -1.2345678901234568e-300\n# EOF\n");
+    BOOST_TEST(second.data() == first.data());
+    BOOST_TEST(exporter.capacity() == capacity);
+}
+
+BOOST_AUTO_TEST_CASE(scrape_while_pushing)
+{
+    // each update leaves an odd mean, which a scrape in the middle of an update would not see
+    mean_t mean;
+    livestats::estimator_registry_t registry;
+    registry.add("mean", {}, mean);
+    livestats::openmetrics_exporter_t exporter(registry);
+
+    std::atomic<bool> done = false;
+    std::thread writer([&] {
+        for (std::size_t i = 0ul; i < 100'000ul; ++i)
+            mean.update([i] (auto& e) {
+                e.reset();
+                e.push(static_cast<double>(2ul * i));
+                e.push(static_cast<double>(2ul * i + 2ul));
+            });
+        done = true;
+    });
+    std::size_t n_scrapes = 0ul;
+    std::size_t n_torn = 0ul;
+    constexpr std::string_view prefix = "# TYPE mean gauge\nmean ";
+    while (not done)
+    {
+        auto const text = exporter.scrape();
+        ++n_scrapes;
+        long value = -1;
+        auto const number = text.substr(prefix.size());
+        std::from_chars(number.data(), number.data() + number.size(), value);
+        if (not text.starts_with(prefix) or not text.ends_with("\n# EOF\n") or (value != 0 and value % 2 != 1))
+            ++n_torn;
+    }
+    writer.join();
+    BOOST_TEST(n_torn == 0ul);
+    BOOST_TEST(n_scrapes > 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
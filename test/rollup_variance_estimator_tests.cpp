@@ -0,0 +1,160 @@
+#define BOOST_TEST_MODULE rollup_variance_estimator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include <chrono>
+#include <memory_resource>
+#include <sstream>
+#include <stdexcept>
+
+#include "livestats/rollup_variance_estimator.hpp"
+#include "livestats/welford_variance_estimator.hpp"
+
+static const auto tiny = boost::test_tools::tolerance(1e-9);
+
+BOOST_AUTO_TEST_SUITE(rollup_variance_estimator_tests)
+
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_CASE(invalid_levels)
+{
+    using livestats::rollup_variance_estimator_t;
+    BOOST_CHECK_THROW(rollup_variance_estimator_t<double>({}), std::invalid_argument);
+    BOOST_CHECK_THROW(rollup_variance_estimator_t<double>({{1s, 0ul}}), std::invalid_argument);
+    BOOST_CHECK_THROW(rollup_variance_estimator_t<double>({{0s, 10ul}}), std::invalid_argument);
+    BOOST_CHECK_THROW(rollup_variance_estimator_t<double>({{2s, 10ul}, {3s, 10ul}}), std::invalid_argument);
+    BOOST_CHECK_NO_THROW(rollup_variance_estimator_t<double>({{1s, 60ul}, {1min, 60ul}, {1h, 24ul}}));
+}
+
+BOOST_AUTO_TEST_CASE(hopping_windows)
+{
+    livestats::rollup_variance_estimator_t<double> rollup({{1s, 4ul}, {4s, 3ul}});
+    BOOST_TEST(rollup.levels() == 2ul);
+    BOOST_TEST((rollup.bucket_size(1ul) == 4s));
+    BOOST_TEST(rollup.bucket_count(0ul) == 4ul);
+
+    auto const t0 = std::chrono::steady_clock::time_point(1000s);
+    rollup.push(1.0, t0);
+    rollup.push(3.0, t0 + 500ms);
+    // nothing is visible until the first bucket completes
+    BOOST_TEST(rollup.size() == 0ul);
+    BOOST_TEST(rollup.get() == 0.0);
+
+    rollup.push(5.0, t0 + 1s);
+    BOOST_TEST(rollup.size() == 2ul);
+    BOOST_TEST(rollup.mean(0ul, 1ul) == 2.0);
+    BOOST_TEST(rollup.get() == 1.0);
+
+    // 2s without samples are recorded as empty buckets
+    rollup.push(7.0, t0 + 3s + 100ms);
+    rollup.advance(t0 + 4s);
+    BOOST_TEST(rollup.size(0ul, 4ul) == 4ul);
+    BOOST_TEST(rollup.size(0ul, 1ul) == 1ul);
+    BOOST_TEST(rollup.size(0ul, 2ul) == 1ul);
+    BOOST_TEST(rollup.mean(0ul, 4ul) == 4.0);
+    BOOST_TEST(rollup.variance(0ul, 4ul) == 5.0);
+
+    // the first 4s bucket rolls up all the samples of its 1s buckets
+    BOOST_TEST(rollup.size(1ul, 3ul) == 4ul);
+    BOOST_TEST(rollup.mean(1ul, 1ul) == 4.0);
+    BOOST_TEST(rollup.variance(1ul, 1ul) == 5.0);
+
+    // the finest level only keeps the last 4 buckets, while the coarser one keeps the last 12s
+    rollup.push(10.0, t0 + 6s);
+    rollup.advance(t0 + 8s);
+    BOOST_TEST(rollup.size() == 1ul);
+    BOOST_TEST(rollup.get() == 0.0);
+    BOOST_TEST(rollup.size(1ul, 3ul) == 5ul);
+    BOOST_TEST(rollup.mean(1ul, 3ul) == 5.2);
+    BOOST_TEST(rollup.mean(1ul, 1ul) == 10.0);
+
+    // a long gap empties all levels
+    rollup.advance(t0 + 1h);
+    BOOST_TEST(rollup.size(0ul, 4ul) == 0ul);
+    BOOST_TEST(rollup.size(1ul, 3ul) == 0ul);
+
+    rollup.reset();
+    rollup.push(2.0, t0 + 2h);
+    rollup.advance(t0 + 2h + 1s);
+    BOOST_TEST(rollup.size() == 1ul);
+    BOOST_TEST(rollup.mean(0ul, 1ul) == 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(matches_welford_variance)
+{
+    livestats::rollup_variance_estimator_t<double> rollup({{10ms, 100ul}, {100ms, 10ul}, {1s, 60ul}});
+    livestats::welford_variance_estimator_t<double> expected;
+    auto const t0 = std::chrono::steady_clock::time_point(3600s);
+    for (int i = 0; i < 20'000; ++i)
+    {
+        auto const x = static_cast<double>((i * 7919) % 1000) / 10.0;
+        rollup.push(x, t0 + i * 1ms);
+        expected.push(x);
+    }
+    rollup.advance(t0 + 20s);
+    BOOST_TEST(rollup.size(2ul, 60ul) == expected.size());
+    BOOST_TEST(rollup.mean(2ul, 60ul) == expected.mean(), tiny);
+    BOOST_TEST(rollup.variance(2ul, 60ul) == expected.get(), tiny);
+    // the finest level spans the last second
+    BOOST_TEST(rollup.size() == 1'000ul);
+    BOOST_TEST(rollup.size(1ul, 10ul) == 1'000ul);
+    BOOST_TEST(rollup.variance(1ul, 10ul) == rollup.get(), tiny);
+}
+
+BOOST_AUTO_TEST_CASE(memory_usage)
+{
+    livestats::rollup_variance_estimator_t<double> rollup({{1s, 60ul}, {1min, 60ul}, {1h, 24ul}});
+    auto const empty = rollup.memory_usage();
+    BOOST_TEST(empty > 144ul * 3ul * sizeof(double));
+    auto const t0 = std::chrono::steady_clock::time_point(3600s);
+    for (int i = 0; i < 100'000; ++i)
+        rollup.push(1.0, t0 + i * 10ms);
+    BOOST_TEST(rollup.memory_usage() == empty);
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    livestats::pmr::rollup_variance_estimator_t<double> rollup({{1s, 60ul}, {1min, 60ul}}, &resource);
+    BOOST_TEST(rollup.get_allocator().resource() == &resource);
+    rollup.push(1.0, std::chrono::steady_clock::time_point(10s));
+    rollup.advance(std::chrono::steady_clock::time_point(11s));
+    BOOST_TEST(rollup.size() == 1ul);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::rollup_variance_estimator_t<double> rollup({{1s, 4ul}, {4s, 3ul}});
+    auto const t0 = std::chrono::steady_clock::time_point(1000s);
+    rollup.push(1.0, t0);
+    rollup.push(3.0, t0 + 500ms);
+    rollup.push(5.0, t0 + 1s);
+    rollup.push(7.0, t0 + 3s + 100ms);
+    rollup.advance(t0 + 4s);
+    std::stringstream checkpoint;
+    rollup.save(checkpoint);
+
+    livestats::rollup_variance_estimator_t<double> restored({{1s, 4ul}, {4s, 3ul}});
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.size(0ul, 4ul) == 4ul);
+    BOOST_TEST(restored.variance(0ul, 4ul) == 5.0);
+    BOOST_TEST(restored.size(1ul, 3ul) == 4ul);
+
+    // the restored buckets keep rolling up as time goes by
+    rollup.push(10.0, t0 + 6s);
+    rollup.advance(t0 + 8s);
+    restored.push(10.0, t0 + 6s);
+    restored.advance(t0 + 8s);
+    BOOST_TEST(restored.size() == rollup.size());
+    BOOST_TEST(restored.mean(1ul, 3ul) == rollup.mean(1ul, 3ul));
+    BOOST_TEST(restored.variance(1ul, 3ul) == rollup.variance(1ul, 3ul));
+
+    // state saved with different levels cannot be restored
+    checkpoint.seekg(0);
+    livestats::rollup_variance_estimator_t<double> other({{1s, 4ul}, {2s, 3ul}});
+    other.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(other.size(1ul, 3ul) == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,87 @@
+#define BOOST_TEST_MODULE seqlock_estimator_adaptor_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/naive_mean_estimator.hpp"
+#include "livestats/seqlock_estimator_adaptor.hpp"
+#include "livestats/static_sliding_window_mean_estimator.hpp"
+#include "livestats/welford_variance_estimator.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(seqlock_estimator_adaptor_tests)
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
+{
+    livestats::seqlock_estimator_adaptor_t<livestats::welford_variance_estimator_t<double>> variance;
+    BOOST_TEST(variance.get() == 0.0);
+    BOOST_TEST(variance.size() == 0ul);
+
+    BOOST_TEST(variance.add(1.0) == 0.0);
+    BOOST_TEST(variance.add(3.0) == 1.0);
+    BOOST_TEST(variance.size() == 2ul);
+    auto const snapshot = variance.snapshot();
+    BOOST_TEST(snapshot.get() == 1.0);
+    BOOST_TEST(snapshot.size() == 2ul);
+
+    variance.reset();
+    BOOST_TEST(variance.get() == 0.0);
+    BOOST_TEST(variance.size() == 0ul);
+    BOOST_TEST(variance.snapshot().size() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(construct_underlying_estimator_and_update)
+{
+    livestats::seqlock_estimator_adaptor_t<livestats::static_sliding_window_mean_estimator_t<double, 2ul>> mean;
+    mean.push(1.0);
+    mean.push(3.0);
+    mean.update([] (auto& e) { e.push(5.0); });
+    BOOST_TEST(mean.get() == 4.0);
+    BOOST_TEST(mean.snapshot().oldest() == 3.0);
+}
+
+BOOST_AUTO_TEST_CASE(snapshots_are_consistent_while_writing)
+{
+    // every sample is 1, so any consistent snapshot has mean 1; a torn copy would not
+    livestats::seqlock_estimator_adaptor_t<livestats::naive_mean_estimator_t<double>> mean;
+    std::atomic<bool> done = false;
+    std::thread writer([&]
+    {
+        for (auto i = 0; i < 1'000'000; ++i)
+            mean.push(1.0);
+        done = true;
+    });
+    std::size_t inconsistent = 0ul;
+    std::size_t previous_size = 0ul;
+    while (not done)
+    {
+        auto const snapshot = mean.snapshot();
+        if ((snapshot.size() > 0ul and snapshot.get() != 1.0) or snapshot.size() < previous_size)
+            ++inconsistent;
+        previous_size = snapshot.size();
+    }
+    writer.join();
+    BOOST_TEST(inconsistent == 0ul);
+    BOOST_TEST(mean.snapshot().size() == 1'000'000ul);
+}
+
+BOOST_AUTO_TEST_CASE(try_snapshot_gives_up_while_an_update_never_ends)
+{
+    livestats::seqlock_estimator_adaptor_t<livestats::welford_variance_estimator_t<double>> variance;
+    variance.push(1.0);
+    BOOST_TEST(variance.try_snapshot().has_value());
+    BOOST_TEST(variance.try_snapshot()->size() == 1ul);
+
+    // an update that never completes, as if the writer died in the middle of it
+    try
+    {
+        variance.update([] (auto&) { throw std::runtime_error("writer died"); });
+    }
+    catch (std::runtime_error const&)
+    { }
+    BOOST_TEST(not variance.try_snapshot(1'000ul).has_value());
+    BOOST_TEST(not variance.try_snapshot().has_value());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+#define BOOST_TEST_MODULE shared_memory_segment_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/shared_memory_segment.hpp"
+#include "livestats/static_sliding_time_window_variance_estimator.hpp"
+#include "livestats/static_sliding_window_variance_estimator.hpp"
+#include "livestats/welford_mean_estimator.hpp"
+#include "livestats/welford_variance_estimator.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static std::string const segment_name = "/livestats_tests_" + std::to_string(::getpid());
+
+BOOST_AUTO_TEST_SUITE(shared_memory_segment_tests)
+
+BOOST_AUTO_TEST_CASE(write_and_read)
+{
+    livestats::shared_memory_segment_t segment(segment_name, 1ul << 16, 16ul);
+    auto& latency = segment.emplace<livestats::welford_variance_estimator_t<double>>("latency");
+    auto& size = segment.emplace<livestats::static_sliding_window_variance_estimator_t<std::uint64_t, 4ul>>("size");
+
+    livestats::shared_memory_segment_reader_t const reader(segment_name);
+    auto const names = reader.names();
+    BOOST_TEST(names.size() == 2ul);
+    BOOST_TEST(names[0] == "latency");
+    BOOST_TEST(names[1] == "size");
+
+    latency.push(1.0);
+    latency.push(3.0);
+    size.push(1ul);
+    size.push(3ul);
+    auto const latency_snapshot = reader.snapshot<livestats::welford_variance_estimator_t<double>>("latency");
+    BOOST_TEST(latency_snapshot.has_value());
+    BOOST_TEST(latency_snapshot->get() == 1.0);
+    BOOST_TEST(latency_snapshot->size() == 2ul);
+    auto const size_snapshot = reader.snapshot<livestats::static_sliding_window_variance_estimator_t<std::uint64_t, 4ul>>("size");
+    BOOST_TEST(size_snapshot.has_value());
+    BOOST_TEST(size_snapshot->get() == 1ul);
+    BOOST_TEST(size_snapshot->oldest() == 1ul);
+
+    // estimators published later are visible to readers already attached
+    auto& count = segment.emplace<livestats::welford_mean_estimator_t<double>>("count");
+    count.push(2.0);
+    BOOST_TEST(reader.names().size() == 3ul);
+    BOOST_TEST(reader.snapshot<livestats::welford_mean_estimator_t<double>>("count")->get() == 2.0);
+
+    // unknown names and mismatching types are not found
+    BOOST_TEST(not reader.snapshot<livestats::welford_mean_estimator_t<double>>("unknown").has_value());
+    BOOST_TEST(not reader.snapshot<livestats::welford_mean_estimator_t<float>>("count").has_value());
+}
+
+BOOST_AUTO_TEST_CASE(time_window_estimator)
+{
+    using namespace std::chrono_literals;
+    using latency_t = livestats::static_sliding_time_window_variance_estimator_t<double, 64ul, 1, 50>;
+    livestats::shared_memory_segment_t segment(segment_name, 1ul << 16, 4ul);
+    auto& latency = segment.emplace<latency_t>("latency");
+    livestats::shared_memory_segment_reader_t const reader(segment_name);
+
+    auto const t0 = std::chrono::steady_clock::now();
+    latency.update([&] (latency_t& e) {
+        e.push(1.0, t0);
+        e.push(3.0, t0 + 200us);
+        e.push(5.0, t0 + 1'500us);
+    });
+    auto snapshot = reader.snapshot<latency_t>("latency");
+    BOOST_REQUIRE(snapshot.has_value());
+    BOOST_TEST(snapshot->size() == 1ul);
+    BOOST_TEST(snapshot->mean() == 5.0);
+    BOOST_TEST(snapshot->size(livestats::sliding_time_window_tag<50>) == 3ul);
+    BOOST_TEST(snapshot->mean(livestats::sliding_time_window_tag<50>) == 3.0);
+
+    // readers expire old samples in their own copy, leaving the shared estimator untouched
+    snapshot->advance(t0 + 100ms);
+    BOOST_TEST(snapshot->size(livestats::sliding_time_window_tag<50>) == 0ul);
+    BOOST_TEST(reader.snapshot<latency_t>("latency")->size(livestats::sliding_time_window_tag<50>) == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(errors)
+{
+    BOOST_CHECK_THROW(livestats::shared_memory_segment_reader_t{segment_name}, std::system_error);
+    livestats::shared_memory_segment_t segment(segment_name, 4096ul, 4ul);
+    BOOST_CHECK_THROW(
+        segment.emplace<livestats::welford_mean_estimator_t<double>>(std::string(100ul, 'x')),
+        std::length_error);
+    for (auto const name: {"a", "b", "c", "d"})
+        segment.emplace<livestats::welford_mean_estimator_t<double>>(name);
+    BOOST_CHECK_THROW(segment.emplace<livestats::welford_mean_estimator_t<double>>("e"), std::bad_alloc);
+}
+
+BOOST_AUTO_TEST_CASE(corrupt_segment)
+{
+    using livestats::shared_memory::segment_entry_t;
+    using livestats::shared_memory::segment_header_t;
+    using mean_t = livestats::welford_mean_estimator_t<double>;
+    std::size_t const segment_size = 1ul << 16;
+    livestats::shared_memory_segment_t segment(segment_name, segment_size, 4ul);
+    segment.emplace<mean_t>("a").push(1.0);
+    segment.emplace<mean_t>("b").push(2.0);
+    livestats::shared_memory_segment_reader_t const reader(segment_name);
+
+    // another process scribbles over the segment
+    int const fd = ::shm_open(segment_name.c_str(), O_RDWR, 0);
+    BOOST_REQUIRE(fd >= 0);
+    void* const p = ::mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    BOOST_REQUIRE(p != MAP_FAILED);
+    auto* const base = static_cast<std::byte*>(p);
+    auto& header = *reinterpret_cast<segment_header_t*>(base);
+    auto* const entries = reinterpret_cast<segment_entry_t*>(base + sizeof(segment_header_t));
+
+    // names without a terminating null are cut at the end of the entry
+    std::memset(entries[0].name, 'x', sizeof(entries[0].name));
+    BOOST_TEST(reader.names().at(0).size() == sizeof(entries[0].name));
+
+    // estimators out of the bounds of the segment are not found
+    entries[1].offset = segment_size - 8ul;
+    BOOST_TEST(not reader.snapshot<mean_t>("b").has_value());
+    entries[1].offset = ~std::uint64_t(0) - 63ul;
+    BOOST_TEST(not reader.snapshot<mean_t>("b").has_value());
+
+    // an estimator left in the middle of an update, eg by a writer that died, does not hang readers
+    entries[1].offset = entries[0].offset;
+    std::memcpy(entries[1].name, "b", 2ul);
+    // the sequence is the first member of the seqlock adaptor
+    auto const sequence = reinterpret_cast<std::atomic<std::uint64_t>*>(base + entries[0].offset);
+    sequence->fetch_add(1ul);
+    BOOST_TEST(not reader.snapshot<mean_t>("b").has_value());
+    sequence->fetch_add(1ul);
+    BOOST_TEST(reader.snapshot<mean_t>("b")->get() == 1.0);
+
+    // a corrupt number of entries hides all of them
+    header.n_entries.store(1'000'000u);
+    BOOST_TEST(reader.names().empty());
+    BOOST_TEST(not reader.snapshot<mean_t>("b").has_value());
+    ::munmap(p, segment_size);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+#define BOOST_TEST_MODULE sliding_time_window_aggregator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory_resource>
+#include <random>
+#include <utility>
+
+#include "livestats/sliding_time_window_aggregator.hpp"
+#include "livestats/sliding_time_window_timer_wheel.hpp"
+
+BOOST_AUTO_TEST_SUITE(sliding_time_window_aggregator_tests)
+
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_max)
+{
+    livestats::sliding_time_window_aggregator_t<livestats::math::max_monoid_t<double>, 1> max;
+    auto const t0 = std::chrono::steady_clock::now();
+    BOOST_TEST((max.next_expiry() == std::chrono::steady_clock::time_point::max()));
+    max.push(5.0, t0);
+    max.push(1.0, t0 + 200us);
+    max.push(3.0, t0 + 600us);
+    BOOST_TEST(max.get() == 5.0);
+    BOOST_TEST(max.size() == 3ul);
+    BOOST_TEST((max.next_expiry() == t0 + 1ms + 1ns));
+
+    // older samples are discarded
+    max.push(9.0, t0 + 100us);
+    BOOST_TEST(max.size() == 3ul);
+
+    max.advance(t0 + 1'300us);
+    BOOST_TEST(max.get() == 3.0);
+    BOOST_TEST(max.size() == 1ul);
+    max.advance(t0 + 2ms);
+    BOOST_TEST(max.size() == 0ul);
+
+    max.push(2.0, t0 + 3ms);
+    BOOST_TEST(max.get() == 2.0);
+    max.reset();
+    BOOST_TEST(max.size() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(matches_brute_force)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> value_of(-1.0, 1.0);
+    std::exponential_distribution<double> step_of(1.0 / 100.0); // bursts and gaps, 100us on average
+    livestats::sliding_time_window_aggregator_t<livestats::math::max_monoid_t<double>, 5> max;
+    std::deque<std::pair<std::chrono::steady_clock::time_point, double>> samples;
+    auto t = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20'000; ++i)
+    {
+        t += std::chrono::microseconds(static_cast<long>(step_of(rng)));
+        auto const x = value_of(rng);
+        max.push(x, t);
+        samples.emplace_back(t, x);
+        while (samples.front().first < t - 5ms)
+            samples.pop_front();
+        auto const expected = std::max_element(
+            samples.begin(), samples.end(), [] (auto const& p, auto const& q) { return p.second < q.second; });
+        BOOST_REQUIRE(max.size() == samples.size());
+        BOOST_REQUIRE(max.get() == expected->second);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(drop_oldest)
+{
+    livestats::sliding_time_window_aggregator_t<livestats::math::max_monoid_t<double>, 1> max(
+        4ul, livestats::sliding_time_window_overflow_policy::drop_oldest);
+    auto const t0 = std::chrono::steady_clock::now();
+    auto const memory = max.memory_usage();
+    for (int i = 0; i < 10; ++i)
+        max.push(10.0 - i, t0 + i * 10us);
+    // the buffers never grow, the oldest samples leave the window early
+    BOOST_TEST(max.memory_usage() == memory);
+    BOOST_TEST(max.size() == 4ul);
+    BOOST_TEST(max.size_dropped() == 6ul);
+    BOOST_TEST(max.get() == 4.0);
+    BOOST_TEST((max.next_expiry() == t0 + 60us + 1ms + 1ns));
+    max.reset();
+    BOOST_TEST(max.size_dropped() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(time_window_estimator)
+{
+    using aggregator_t = livestats::sliding_time_window_aggregator_t<livestats::math::sum_monoid_t<double>, 1>;
+    static_assert(livestats::TimeWindowEstimator<aggregator_t>);
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    livestats::pmr::sliding_time_window_aggregator_t<livestats::math::sum_monoid_t<double>, 1> sum(4ul, {}, &resource);
+    BOOST_TEST(sum.get_allocator().resource() == &resource);
+    auto const t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; ++i)
+        sum.push(1.0, t0 + i * 100us);
+    BOOST_TEST(sum.get() == 10.0);
+    BOOST_TEST(sum.memory_usage() > sizeof(sum));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
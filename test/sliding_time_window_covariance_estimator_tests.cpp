@@ -0,0 +1,201 @@
+#define BOOST_TEST_MODULE sliding_time_window_covariance_estimator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include <array>
+#include <cmath>
+#include <memory_resource>
+#include <sstream>
+#include <vector>
+
+#include "livestats/sliding_time_window_covariance_estimator.hpp"
+
+static const auto tiny = boost::test_tools::tolerance(1e-12);
+
+BOOST_AUTO_TEST_SUITE(sliding_time_window_covariance_estimator_tests)
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
+{
+    using livestats::sliding_time_window_tag;
+    livestats::sliding_time_window_covariance_estimator_t<double, 1, 50> covariance;
+    BOOST_TEST(covariance.get() == 0.0, tiny);
+    BOOST_TEST(covariance.size() == 0ul);
+    BOOST_TEST(covariance.size(sliding_time_window_tag<50>) == 0ul);
+    BOOST_TEST(covariance.sample_buffer_size() == 0ul);
+    BOOST_TEST((covariance.next_expiry() == std::chrono::steady_clock::time_point::max()));
+
+    auto const t0 = std::chrono::steady_clock::now();
+    covariance.push(1.0, 2.0, t0);
+    covariance.push(2.0, 4.0, t0 + std::chrono::microseconds(10));
+    BOOST_TEST(covariance.get() == 0.5, tiny);
+    BOOST_TEST(covariance.correlation() == 1.0, tiny);
+    BOOST_TEST(covariance.slope() == 2.0, tiny);
+    BOOST_TEST(covariance.intercept() == 0.0, tiny);
+    BOOST_TEST((covariance.next_expiry() == t0 + std::chrono::milliseconds(1) + std::chrono::nanoseconds(1)));
+
+    // out of order pairs are discarded
+    covariance.push(100.0, 100.0, t0 + std::chrono::microseconds(5));
+    BOOST_TEST(covariance.size() == 2ul);
+
+    // the 1ms window drops the first two pairs, the 50ms window keeps all of them
+    covariance.push(3.0, 5.0, t0 + std::chrono::microseconds(1'005));
+    covariance.push(4.0, 4.0, t0 + std::chrono::microseconds(1'015));
+    covariance.push(5.0, 5.0, t0 + std::chrono::microseconds(1'020));
+    BOOST_TEST(covariance.size() == 3ul);
+    BOOST_TEST(covariance.size(sliding_time_window_tag<1>) == 3ul);
+    BOOST_TEST(covariance.size(sliding_time_window_tag<50>) == 5ul);
+    BOOST_TEST(covariance.sample_buffer_size() == 5ul);
+    BOOST_TEST(std::abs(covariance.get()) < 1e-12);
+    BOOST_TEST(covariance.mean_x() == 4.0, tiny);
+    BOOST_TEST(covariance.mean_y() == 14.0 / 3.0, tiny);
+    BOOST_TEST(covariance.get(sliding_time_window_tag<50>) == 1.2, tiny);
+    BOOST_TEST(covariance.covariance(sliding_time_window_tag<50>) == 1.2, tiny);
+    BOOST_TEST(covariance.correlation(sliding_time_window_tag<50>) == 6.0 / std::sqrt(60.0), tiny);
+    BOOST_TEST(covariance.slope(sliding_time_window_tag<50>) == 0.6, tiny);
+    BOOST_TEST(covariance.intercept(sliding_time_window_tag<50>) == 2.2, tiny);
+    BOOST_TEST(covariance.mean_x(sliding_time_window_tag<50>) == 3.0, tiny);
+    BOOST_TEST(covariance.mean_y(sliding_time_window_tag<50>) == 4.0, tiny);
+
+    // all pairs fall out of both windows
+    covariance.advance(t0 + std::chrono::milliseconds(60));
+    BOOST_TEST(covariance.size() == 0ul);
+    BOOST_TEST(covariance.size(sliding_time_window_tag<50>) == 0ul);
+    BOOST_TEST(covariance.sample_buffer_size() == 0ul);
+    BOOST_TEST(covariance.get() == 0.0, tiny);
+
+    covariance.push(1.0, 1.0, t0 + std::chrono::milliseconds(61));
+    covariance.reset();
+    BOOST_TEST(covariance.size() == 0ul);
+    BOOST_TEST(covariance.sample_buffer_size() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    livestats::pmr::sliding_time_window_covariance_estimator_t<double, 1, 50> covariance(&arena);
+    BOOST_TEST(covariance.get_allocator().resource() == &arena);
+    auto const t0 = std::chrono::steady_clock::now();
+    covariance.push(1.0, 2.0, t0);
+    covariance.push(2.0, 4.0, t0 + std::chrono::microseconds(10));
+    BOOST_TEST(covariance.get() == 0.5, tiny);
+    BOOST_TEST(covariance.sample_buffer_size() == 2ul);
+}
+
+BOOST_AUTO_TEST_CASE(preallocated_capacity_drop_oldest)
+{
+    livestats::sliding_time_window_covariance_estimator_t<double, 1, 50> covariance(
+        2ul, livestats::sliding_time_window_overflow_policy::drop_oldest);
+    auto const t0 = std::chrono::steady_clock::now();
+    covariance.push(7.0, 7.0, t0);
+    covariance.push(1.0, 2.0, t0 + std::chrono::microseconds(10));
+    covariance.push(2.0, 4.0, t0 + std::chrono::microseconds(20));
+    BOOST_TEST(covariance.capacity() == 2ul);
+    BOOST_TEST(covariance.high_watermark() == 2ul);
+    BOOST_TEST(covariance.size_dropped() == 1ul);
+    BOOST_TEST(covariance.size() == 2ul);
+    BOOST_TEST(covariance.size(livestats::sliding_time_window_tag<50>) == 2ul);
+    BOOST_TEST(covariance.get() == 0.5, tiny);
+    BOOST_TEST(covariance.get(livestats::sliding_time_window_tag<50>) == 0.5, tiny);
+}
+
+BOOST_AUTO_TEST_CASE(push_range)
+{
+    struct quote_t
+    {
+        std::chrono::steady_clock::time_point timestamp;
+        double bid;
+        double ask;
+    };
+    auto const t0 = std::chrono::steady_clock::now();
+    std::vector<quote_t> quotes;
+    for (int i = 0; i < 200; ++i)
+    {
+        auto const bid = static_cast<double>(i % 13);
+        quotes.push_back({t0 + std::chrono::microseconds(50 * i), bid, 2.0 * bid + (i % 3)});
+    }
+
+    livestats::sliding_time_window_covariance_estimator_t<double, 1, 5> expected;
+    livestats::sliding_time_window_covariance_estimator_t<double, 1, 5> covariance;
+    for (auto const& quote: quotes)
+        expected.push(quote.bid, quote.ask, quote.timestamp);
+    covariance.push_range(quotes, &quote_t::timestamp, &quote_t::bid, &quote_t::ask);
+    BOOST_TEST(covariance.size() == expected.size());
+    BOOST_TEST(covariance.high_watermark() >= expected.high_watermark()); // a batch is appended before eviction
+    BOOST_TEST(covariance.get() == expected.get(), tiny);
+    BOOST_TEST(covariance.slope() == expected.slope(), tiny);
+    auto const w5 = livestats::sliding_time_window_tag<5>;
+    BOOST_TEST(covariance.get(w5) == expected.get(w5), tiny);
+
+    // parallel spans
+    std::vector<std::chrono::steady_clock::time_point> timestamps;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    for (auto const& quote: quotes)
+    {
+        timestamps.push_back(quote.timestamp);
+        xs.push_back(quote.bid);
+        ys.push_back(quote.ask);
+    }
+    covariance.reset();
+    covariance.push_range(timestamps, xs, ys);
+    BOOST_TEST(covariance.size() == expected.size());
+    BOOST_TEST(covariance.correlation() == expected.correlation(), tiny);
+}
+
+BOOST_AUTO_TEST_CASE(reorder_horizon)
+{
+    livestats::sliding_time_window_covariance_estimator_t<double, 1> covariance;
+    covariance.set_reorder_horizon(std::chrono::microseconds(100));
+    auto const t0 = std::chrono::steady_clock::now();
+    covariance.push(1.0, 2.0, t0);
+    covariance.push(3.0, 5.0, t0 + std::chrono::microseconds(20));
+    covariance.push(2.0, 4.0, t0 + std::chrono::microseconds(10));
+    covariance.push(9.0, 9.0, t0 - std::chrono::microseconds(90));
+    BOOST_TEST(covariance.size() == 3ul);
+    BOOST_TEST(covariance.size_late() == 1ul);
+    BOOST_TEST(covariance.high_watermark() == 3ul);
+    BOOST_TEST(covariance.get() == 1.0, tiny);
+    BOOST_TEST(covariance.slope() == 1.5, tiny);
+
+    // the late pair expires in time order
+    covariance.advance(t0 + std::chrono::microseconds(1'015));
+    BOOST_TEST(covariance.size() == 1ul);
+    BOOST_TEST(covariance.mean_x() == 3.0, tiny);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::sliding_time_window_covariance_estimator_t<double, 1, 50> covariance;
+    auto const t0 = std::chrono::steady_clock::now();
+    covariance.push(1.0, 2.0, t0);
+    covariance.push(2.0, 4.0, t0 + std::chrono::microseconds(10));
+    covariance.push(3.0, 5.0, t0 + std::chrono::microseconds(1'005));
+    std::stringstream checkpoint;
+    covariance.save(checkpoint);
+
+    livestats::sliding_time_window_covariance_estimator_t<double, 1, 50> restored(1ul);
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.sample_buffer_size() == 3ul);
+    BOOST_TEST(restored.high_watermark() == 3ul);
+    BOOST_TEST(restored.size() == 2ul);
+    BOOST_TEST(restored.size(livestats::sliding_time_window_tag<50>) == 3ul);
+    BOOST_TEST(restored.get() == covariance.get(), tiny);
+    BOOST_TEST(restored.slope(livestats::sliding_time_window_tag<50>) == covariance.slope(livestats::sliding_time_window_tag<50>), tiny);
+
+    // the restored pairs keep expiring as time goes by
+    restored.advance(t0 + std::chrono::microseconds(1'015));
+    covariance.advance(t0 + std::chrono::microseconds(1'015));
+    BOOST_TEST(restored.size() == 1ul);
+    BOOST_TEST(restored.get() == covariance.get(), tiny);
+    BOOST_TEST((restored.next_expiry() == covariance.next_expiry()));
+
+    // state saved with different windows cannot be restored
+    checkpoint.seekg(0);
+    livestats::sliding_time_window_covariance_estimator_t<double, 1, 100> other;
+    other.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(other.sample_buffer_size() == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
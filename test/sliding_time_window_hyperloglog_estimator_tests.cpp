@@ -0,0 +1,115 @@
+#define BOOST_TEST_MODULE sliding_time_window_hyperloglog_estimator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+
+#include "livestats/sliding_time_window_hyperloglog_estimator.hpp"
+
+BOOST_AUTO_TEST_SUITE(sliding_time_window_hyperloglog_estimator_tests)
+
+using namespace std::chrono_literals;
+using livestats::sliding_time_window_tag;
+
+BOOST_AUTO_TEST_CASE(multiple_windows)
+{
+    livestats::sliding_time_window_hyperloglog_estimator_t<12, 1'000, 10'000, 60'000> unique;
+    BOOST_TEST((unique.bucket_duration() == 125ms));
+    auto const close = boost::test_tools::tolerance(0.05);
+
+    // 1000 new clients per second, each seen twice, for 30s
+    auto const t0 = std::chrono::steady_clock::time_point(1000s);
+    for (std::uint64_t s = 0ul; s < 30ul; ++s)
+        for (std::uint64_t i = 0ul; i < 2'000ul; ++i)
+            unique.push(s * 1'000ul + i / 2ul, t0 + s * 1s + i * 400us);
+    BOOST_TEST(unique.get() == 1'000.0, close);
+    BOOST_TEST(unique.size() == 2'000ul);
+    BOOST_TEST(unique.get(sliding_time_window_tag<10'000>) == 10'000.0, close);
+    BOOST_TEST(unique.get(sliding_time_window_tag<60'000>) == 30'000.0, close);
+    BOOST_TEST(unique.size(sliding_time_window_tag<60'000>) == 60'000ul);
+
+    // the same clients come back: the 60s window does not count them twice
+    for (std::uint64_t i = 0ul; i < 5'000ul; ++i)
+        unique.push(i, t0 + 31s + i * 100us);
+    BOOST_TEST(unique.get() == 5'000.0, close);
+    BOOST_TEST(unique.get(sliding_time_window_tag<60'000>) == 30'000.0, close);
+
+    // a late key still counts in the windows spanning its bucket;
+    // the 10s window spans 80 buckets of 125ms back from the current one, ie from t0 + 21.5s
+    unique.push(1'000'000ul, t0 + 25s);
+    BOOST_TEST(unique.size(sliding_time_window_tag<10'000>) == 750ul + 8ul * 2'000ul + 5'000ul + 1ul);
+    BOOST_TEST(unique.size() == 5'000ul);
+
+    // windows slide by whole buckets
+    unique.advance(t0 + 80s);
+    BOOST_TEST(unique.size() == 0ul);
+    BOOST_TEST(unique.get(sliding_time_window_tag<60'000>) == 844.0 + 9'000.0 + 5'000.0 + 1.0, close);
+    unique.advance(t0 + 1h);
+    BOOST_TEST(unique.get(sliding_time_window_tag<60'000>) == 0.0);
+
+    unique.reset();
+    unique.push(7ul, t0 + 2h);
+    BOOST_TEST(unique.get() == 1.0, close);
+}
+
+BOOST_AUTO_TEST_CASE(query_after_bucket_boundary)
+{
+    livestats::sliding_time_window_hyperloglog_estimator_t<12, 1'000, 10'000> unique;
+    auto const close = boost::test_tools::tolerance(0.05);
+
+    // 1000 clients over one second
+    auto const t0 = std::chrono::steady_clock::time_point(1000s);
+    for (std::uint64_t i = 0ul; i < 1'000ul; ++i)
+        unique.push(i, t0 + i * 1ms);
+    BOOST_TEST(unique.get() == 1'000.0, close);
+
+    // just past the end of the second, the window still covers its last 7/8
+    unique.advance(t0 + 1s + 1ns);
+    BOOST_TEST(unique.size() == 875ul);
+    BOOST_TEST(unique.get() == 875.0, close);
+    BOOST_TEST(unique.size(sliding_time_window_tag<10'000>) == 1'000ul);
+}
+
+BOOST_AUTO_TEST_CASE(bucket_divides_gcd_of_windows)
+{
+    livestats::sliding_time_window_hyperloglog_estimator_t<4, 150, 100> unique;
+    BOOST_TEST((unique.bucket_duration() == 6'250us));
+    BOOST_TEST(unique.memory_usage() >= 24ul * 16ul);
+
+    livestats::basic_sliding_time_window_hyperloglog_estimator_t<4, 1, 150, 100> coarse;
+    BOOST_TEST((coarse.bucket_duration() == 50ms));
+    BOOST_TEST(coarse.memory_usage() >= 3ul * 16ul);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::sliding_time_window_hyperloglog_estimator_t<10, 1'000, 10'000> unique;
+    auto const t0 = std::chrono::steady_clock::time_point(1000s);
+    for (std::uint64_t i = 0ul; i < 5'000ul; ++i)
+        unique.push(i, t0 + i * 1ms);
+    std::stringstream checkpoint;
+    unique.save(checkpoint);
+
+    livestats::sliding_time_window_hyperloglog_estimator_t<10, 1'000, 10'000> restored;
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.size() == unique.size());
+    BOOST_TEST(restored.get() == unique.get());
+    BOOST_TEST(restored.get(sliding_time_window_tag<10'000>) == unique.get(sliding_time_window_tag<10'000>));
+
+    // the restored buckets keep sliding as time goes by
+    unique.advance(t0 + 6s);
+    restored.advance(t0 + 6s);
+    BOOST_TEST(restored.size() == 0ul);
+    BOOST_TEST(restored.get(sliding_time_window_tag<10'000>) == unique.get(sliding_time_window_tag<10'000>));
+
+    // state saved with different windows cannot be restored
+    checkpoint.seekg(0);
+    livestats::sliding_time_window_hyperloglog_estimator_t<10, 2'000, 10'000> other;
+    other.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(other.size() == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,7 +1,12 @@
 #define BOOST_TEST_MODULE sliding_time_window_mean_estimator_tests
 #include <boost/test/included/unit_test.hpp>
 
+#include <array>
+#include <limits>
+#include <memory_resource>
+#include <sstream>
 #include <thread>
+#include <vector>
 
 #include "livestats/sliding_time_window_mean_estimator.hpp"
 
@@ -375,4 +380,340 @@ BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
     BOOST_TEST(mean.sample_buffer_size() == 0ul);
 }
 
+BOOST_AUTO_TEST_CASE(accumulate_uint32_into_uint64)
+{
+    using mean_t = livestats::basic_sliding_time_window_mean_estimator_t<
+        std::uint32_t, std::uint64_t, std::allocator<std::uint32_t>, livestats::no_instrumentation_t, 1, 50>;
+    mean_t mean;
+    auto const t0 = std::chrono::steady_clock::now();
+    mean.push(4'000'000'000u, t0);
+    mean.push(4'000'000'002u, t0 + std::chrono::microseconds(10));
+    mean.push(4'000'000'004u, t0 + std::chrono::microseconds(20));
+    BOOST_TEST(mean.get() == 4'000'000'002u);
+    BOOST_TEST(mean.get(livestats::sliding_time_window_tag<50>) == 4'000'000'002u);
+
+    mean.advance(t0 + std::chrono::microseconds(1'010));
+    BOOST_TEST(mean.get() == 4'000'000'003u);
+    BOOST_TEST(mean.size() == 2ul);
+    BOOST_TEST(mean.get(livestats::sliding_time_window_tag<50>) == 4'000'000'002u);
+    BOOST_TEST(mean.size(livestats::sliding_time_window_tag<50>) == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(counting_instrumentation)
+{
+    using mean_t = livestats::basic_sliding_time_window_mean_estimator_t<
+        double, double, std::allocator<double>, livestats::counting_instrumentation_t, 1, 50>;
+    static_assert(sizeof(livestats::sliding_time_window_mean_estimator_t<double, 1, 50>) < sizeof(mean_t));
+    mean_t mean(2ul);
+    auto const t0 = std::chrono::steady_clock::now();
+    mean.push(1.0, t0);
+    mean.push(2.0, t0 + std::chrono::microseconds(10));
+    mean.push(3.0, t0 + std::chrono::microseconds(20));
+    mean.push(9.0, t0 + std::chrono::microseconds(5)); // out of order
+    auto const& probes = mean.instrumentation();
+    BOOST_TEST(probes.n_pushes == 3ul);
+    BOOST_TEST(probes.n_discarded == 1ul);
+    BOOST_TEST(probes.n_allocations == 1ul);
+    BOOST_TEST(probes.max_buffer_size == 3ul);
+    BOOST_TEST(probes.n_advances == 3ul);
+    BOOST_TEST(probes.n_evicted == 0ul);
+    BOOST_TEST(probes.evictions_histogram[0] == 3ul);
+
+    // 3 samples leave the 1ms window, then 3 samples leave the 50ms window
+    mean.advance(t0 + std::chrono::milliseconds(2));
+    mean.advance(t0 + std::chrono::milliseconds(60));
+    BOOST_TEST(probes.n_advances == 5ul);
+    BOOST_TEST(probes.n_evicted == 6ul);
+    BOOST_TEST(probes.evictions_histogram[2] == 2ul);
+
+    // counters cover the whole lifetime of the estimator
+    mean.reset();
+    BOOST_TEST(probes.n_pushes == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(memory_usage)
+{
+    livestats::sliding_time_window_mean_estimator_t<double, 1, 50> mean(100ul);
+    BOOST_TEST(mean.memory_usage() >= sizeof(mean) + 100ul * 2ul * sizeof(double));
+    auto const preallocated = mean.memory_usage();
+    mean.push(1.0);
+    BOOST_TEST(mean.memory_usage() == preallocated);
+    BOOST_TEST(livestats::memory_usage(mean) == preallocated);
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    livestats::pmr::sliding_time_window_mean_estimator_t<double, 1, 50> mean(&arena);
+    BOOST_TEST(mean.get_allocator().resource() == &arena);
+    auto const t0 = std::chrono::steady_clock::now();
+    mean.push(1.0, t0);
+    mean.push(4.0, t0 + std::chrono::microseconds(10));
+    BOOST_TEST(mean.get() == 2.5);
+    BOOST_TEST(mean.sample_buffer_size() == 2ul);
+}
+
+BOOST_AUTO_TEST_CASE(preallocated_capacity_grow)
+{
+    livestats::sliding_time_window_mean_estimator_t<double, 1, 50> mean(2ul);
+    BOOST_TEST(mean.capacity() == 2ul);
+    BOOST_TEST(mean.high_watermark() == 0ul);
+    auto const t0 = std::chrono::steady_clock::now();
+    mean.push(1.0, t0);
+    mean.push(2.0, t0 + std::chrono::microseconds(10));
+    BOOST_TEST(mean.capacity() == 2ul);
+    mean.push(3.0, t0 + std::chrono::microseconds(20));
+    mean.push(4.0, t0 + std::chrono::microseconds(30));
+    BOOST_TEST(mean.capacity() == 4ul);
+    BOOST_TEST(mean.high_watermark() == 4ul);
+    BOOST_TEST(mean.size() == 4ul);
+    BOOST_TEST(mean.size_dropped() == 0ul);
+    BOOST_TEST(mean.get() == 2.5);
+
+    // the 50ms window still needs all samples, so the buffer only shrinks once they fall out of that window
+    mean.advance(t0 + std::chrono::microseconds(1'025));
+    BOOST_TEST(mean.size() == 1ul);
+    BOOST_TEST(mean.sample_buffer_size() == 4ul);
+    mean.advance(t0 + std::chrono::microseconds(50'025));
+    BOOST_TEST(mean.sample_buffer_size() == 1ul);
+    BOOST_TEST(mean.high_watermark() == 4ul);
+    BOOST_TEST(mean.capacity() == 4ul);
+
+    mean.reset();
+    BOOST_TEST(mean.high_watermark() == 0ul);
+    BOOST_TEST(mean.capacity() == 4ul);
+}
+
+BOOST_AUTO_TEST_CASE(preallocated_capacity_drop_oldest)
+{
+    livestats::sliding_time_window_mean_estimator_t<double, 1, 50> mean(
+        2ul, livestats::sliding_time_window_overflow_policy::drop_oldest);
+    auto const t0 = std::chrono::steady_clock::now();
+    mean.push(1.0, t0);
+    mean.push(2.0, t0 + std::chrono::microseconds(10));
+    mean.push(4.0, t0 + std::chrono::microseconds(20));
+    mean.push(6.0, t0 + std::chrono::microseconds(30));
+    BOOST_TEST(mean.capacity() == 2ul);
+    BOOST_TEST(mean.high_watermark() == 2ul);
+    BOOST_TEST(mean.sample_buffer_size() == 2ul);
+    BOOST_TEST(mean.size() == 2ul);
+    BOOST_TEST(mean.size(livestats::sliding_time_window_tag<50>) == 2ul);
+    BOOST_TEST(mean.size_dropped() == 2ul);
+    BOOST_TEST(mean.get() == 5.0);
+    BOOST_TEST(mean.get(livestats::sliding_time_window_tag<50>) == 5.0);
+
+    // the 1ms window drops the sample at 20us, so only the 50ms window contains the oldest sample
+    mean.advance(t0 + std::chrono::microseconds(1'025));
+    BOOST_TEST(mean.size() == 1ul);
+    mean.push(8.0, t0 + std::chrono::microseconds(1'030));
+    BOOST_TEST(mean.size_dropped() == 3ul);
+    BOOST_TEST(mean.size() == 2ul);
+    BOOST_TEST(mean.size(livestats::sliding_time_window_tag<50>) == 2ul);
+    BOOST_TEST(mean.get(livestats::sliding_time_window_tag<50>) == 7.0);
+
+    mean.reset();
+    BOOST_TEST(mean.size_dropped() == 0ul);
+    BOOST_TEST(mean.capacity() == 2ul);
+}
+
+BOOST_AUTO_TEST_CASE(push_range)
+{
+    using livestats::sliding_time_window_tag;
+    auto const t0 = std::chrono::steady_clock::now();
+    std::vector<std::chrono::steady_clock::time_point> timestamps;
+    std::vector<double> values;
+    for (int i = 0; i < 100; ++i)
+    {
+        // some samples arrive within the reorder horizon, others too late
+        auto const lag = i % 10 == 4 ? 150 : i % 10 == 9 ? 400 : 0;
+        timestamps.push_back(t0 + std::chrono::microseconds(100 * i - lag));
+        values.push_back(i % 7);
+    }
+
+    for (auto const policy: {
+        livestats::sliding_time_window_overflow_policy::grow,
+        livestats::sliding_time_window_overflow_policy::drop_oldest})
+    {
+        livestats::sliding_time_window_mean_estimator_t<double, 1, 5> expected(8ul, policy);
+        livestats::sliding_time_window_mean_estimator_t<double, 1, 5> mean(8ul, policy);
+        expected.set_reorder_horizon(std::chrono::microseconds(250));
+        mean.set_reorder_horizon(std::chrono::microseconds(250));
+        for (std::size_t i = 0ul; i < values.size(); ++i)
+            expected.push(values[i], timestamps[i]);
+        mean.push_range(timestamps, values);
+
+        BOOST_TEST(mean.size() == expected.size());
+        BOOST_TEST(mean.get() == expected.get(), tiny);
+        BOOST_TEST(mean.size(sliding_time_window_tag<5>) == expected.size(sliding_time_window_tag<5>));
+        BOOST_TEST(mean.get(sliding_time_window_tag<5>) == expected.get(sliding_time_window_tag<5>), tiny);
+        BOOST_TEST(mean.sample_buffer_size() == expected.sample_buffer_size());
+        BOOST_TEST(mean.size_dropped() == expected.size_dropped());
+        BOOST_TEST(mean.size_late() == expected.size_late());
+        BOOST_TEST(mean.size_late() == 10ul);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(push_range_projections)
+{
+    struct tick_t
+    {
+        int id;
+        std::chrono::steady_clock::time_point timestamp;
+        double price;
+    };
+    auto const t0 = std::chrono::steady_clock::now();
+    std::array<tick_t, 4> const ticks{{
+        {1, t0, 1.0},
+        {2, t0 + std::chrono::microseconds(500), 2.0},
+        {3, t0 + std::chrono::microseconds(1'200), 3.0},
+        {4, t0 + std::chrono::microseconds(1'400), 7.0},
+    }};
+
+    livestats::sliding_time_window_mean_estimator_t<double, 1, 50> mean;
+    mean.push_range(ticks, &tick_t::timestamp, &tick_t::price);
+    BOOST_TEST(mean.get() == 4.0);
+    BOOST_TEST(mean.size() == 3ul);
+    BOOST_TEST(mean.get(livestats::sliding_time_window_tag<50>) == 3.25);
+    BOOST_TEST(mean.sample_buffer_size() == 4ul);
+
+    // an empty batch changes nothing
+    mean.push_range(std::span<tick_t const>(), &tick_t::timestamp, &tick_t::price);
+    BOOST_TEST(mean.size() == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(reorder_horizon)
+{
+    using livestats::sliding_time_window_tag;
+    livestats::sliding_time_window_mean_estimator_t<double, 1, 50> mean;
+    BOOST_TEST((mean.reorder_horizon() == std::chrono::steady_clock::duration::zero()));
+    mean.set_reorder_horizon(std::chrono::milliseconds(2));
+    BOOST_TEST((mean.reorder_horizon() == std::chrono::milliseconds(2)));
+
+    auto const t0 = std::chrono::steady_clock::now();
+    mean.push(1.0, t0);
+    mean.push(3.0, t0 + std::chrono::microseconds(1'000));
+    mean.push(2.0, t0 + std::chrono::microseconds(500)); // late, inserted in time order
+    BOOST_TEST(mean.get() == 2.0);
+    BOOST_TEST(mean.size() == 3ul);
+    BOOST_TEST(mean.sample_buffer_size() == 3ul);
+
+    // the 1ms window drops the samples at 0us and 500us, the 50ms window keeps them
+    mean.advance(t0 + std::chrono::microseconds(1'600));
+    BOOST_TEST(mean.get() == 3.0);
+    BOOST_TEST(mean.size() == 1ul);
+
+    // a late sample before the beginning of the 1ms window only goes in the 50ms window
+    mean.push(6.0, t0 + std::chrono::microseconds(550));
+    BOOST_TEST(mean.size() == 1ul);
+    BOOST_TEST(mean.size(sliding_time_window_tag<50>) == 4ul);
+    BOOST_TEST(mean.get(sliding_time_window_tag<50>) == 3.0);
+    // while a late sample within the 1ms window goes in both
+    mean.push(5.0, t0 + std::chrono::microseconds(900));
+    BOOST_TEST(mean.get() == 4.0);
+    BOOST_TEST(mean.size(sliding_time_window_tag<50>) == 5ul);
+
+    // samples older than the horizon are discarded and counted
+    mean.push(100.0, t0 + std::chrono::microseconds(1'000) - std::chrono::milliseconds(3));
+    BOOST_TEST(mean.size_late() == 1ul);
+    BOOST_TEST(mean.size(sliding_time_window_tag<50>) == 5ul);
+
+    // late samples expire in time order
+    mean.advance(t0 + std::chrono::microseconds(50'700));
+    BOOST_TEST(mean.size(sliding_time_window_tag<50>) == 2ul);
+    BOOST_TEST(mean.get(sliding_time_window_tag<50>) == 4.0);
+    BOOST_TEST(mean.size() == 0ul);
+    BOOST_TEST(mean.sample_buffer_size() == 2ul);
+
+    // a sample within the horizon but older than every window is discarded and counted too
+    mean.push(100.0, t0 + std::chrono::microseconds(600));
+    BOOST_TEST(mean.size_late() == 2ul);
+    BOOST_TEST(mean.size(sliding_time_window_tag<50>) == 2ul);
+    BOOST_TEST(mean.sample_buffer_size() == 2ul);
+
+    mean.reset();
+    BOOST_TEST(mean.size_late() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(sub_millisecond_windows)
+{
+    using namespace std::chrono_literals;
+    livestats::sliding_time_window_mean_estimator_t<double, 10us, 250us, 1> mean;
+    auto const t0 = std::chrono::steady_clock::now();
+
+    mean.push(1.0, t0);
+    mean.push(3.0, t0 + 5us);
+    mean.push(5.0, t0 + 100us);
+    BOOST_TEST(mean.size() == 1ul);
+    BOOST_TEST(mean.get() == 5.0);
+    BOOST_TEST(mean.size(livestats::sliding_time_window_tag_us<250>) == 3ul);
+    BOOST_TEST(mean.get(livestats::sliding_time_window_tag<250us>) == 3.0);
+    BOOST_TEST(mean.size(livestats::sliding_time_window_tag_ns<1'000'000>) == 3ul);
+    BOOST_TEST((mean.next_expiry() == t0 + 110us + std::chrono::steady_clock::duration(1)));
+
+    mean.advance(t0 + 300us);
+    BOOST_TEST(mean.size() == 0ul);
+    BOOST_TEST(mean.size(livestats::sliding_time_window_tag_us<250>) == 1ul);
+    BOOST_TEST(mean.get(livestats::sliding_time_window_tag_us<250>) == 5.0);
+    BOOST_TEST(mean.size(livestats::sliding_time_window_tag<1>) == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::sliding_time_window_mean_estimator_t<double, 1, 50> mean;
+    auto const t0 = std::chrono::steady_clock::now();
+    mean.push(1.0, t0);
+    mean.push(4.0, t0 + std::chrono::microseconds(10));
+    mean.push(17.0, t0 + std::chrono::microseconds(1'005));
+    std::stringstream checkpoint;
+    mean.save(checkpoint);
+
+    livestats::sliding_time_window_mean_estimator_t<double, 1, 50> restored(1ul);
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.sample_buffer_size() == 3ul);
+    BOOST_TEST(restored.high_watermark() == 3ul);
+    BOOST_TEST(restored.size() == 2ul);
+    BOOST_TEST(restored.size(livestats::sliding_time_window_tag<50>) == 3ul);
+    BOOST_TEST(restored.get() == mean.get());
+    BOOST_TEST(restored.get(livestats::sliding_time_window_tag<50>) == mean.get(livestats::sliding_time_window_tag<50>));
+
+    // the restored samples keep expiring as time goes by
+    restored.advance(t0 + std::chrono::microseconds(1'015));
+    mean.advance(t0 + std::chrono::microseconds(1'015));
+    BOOST_TEST(restored.size() == 1ul);
+    BOOST_TEST(restored.get() == mean.get());
+    BOOST_TEST(restored.sample_buffer_size() == 3ul);
+
+    // state saved with different windows cannot be restored
+    checkpoint.seekg(0);
+    livestats::sliding_time_window_mean_estimator_t<double, 1, 100> other;
+    other.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(other.sample_buffer_size() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(load_corrupt_sample_count)
+{
+    livestats::sliding_time_window_mean_estimator_t<double, 1, 50> mean;
+    auto const t0 = std::chrono::steady_clock::now();
+    mean.push(1.0, t0);
+    mean.push(4.0, t0 + std::chrono::microseconds(10));
+    std::stringstream checkpoint;
+    mean.save(checkpoint);
+
+    // the sample count follows the header and the window sizes
+    auto bytes = checkpoint.str();
+    auto const offset = sizeof(livestats::serialization::header_t) + 2ul * sizeof(std::chrono::nanoseconds);
+    auto const huge = std::numeric_limits<std::size_t>::max() / 2ul;
+    bytes.replace(offset, sizeof(huge), reinterpret_cast<char const*>(&huge), sizeof(huge));
+
+    std::stringstream corrupt(bytes);
+    livestats::sliding_time_window_mean_estimator_t<double, 1, 50> restored;
+    BOOST_CHECK_NO_THROW(restored.load(corrupt));
+    BOOST_TEST(corrupt.fail());
+    BOOST_TEST(restored.sample_buffer_size() == 0ul);
+    BOOST_TEST(restored.capacity() < 16ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+#define BOOST_TEST_MODULE sliding_time_window_rate_estimator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include <chrono>
+#include <deque>
+#include <memory_resource>
+#include <random>
+#include <sstream>
+
+#include "livestats/sliding_time_window_rate_estimator.hpp"
+
+static const auto tiny = boost::test_tools::tolerance(1e-9);
+
+BOOST_AUTO_TEST_SUITE(sliding_time_window_rate_estimator_tests)
+
+using namespace std::chrono_literals;
+using livestats::sliding_time_window_tag;
+
+BOOST_AUTO_TEST_CASE(rate_and_interarrival)
+{
+    livestats::sliding_time_window_rate_estimator_t<1, 100> rate;
+    BOOST_TEST(rate.get() == 0.0);
+    BOOST_TEST((rate.next_expiry() == std::chrono::steady_clock::time_point::max()));
+
+    auto const t0 = std::chrono::steady_clock::now();
+    rate.push(t0);
+    rate.push(t0 + 200us);
+    rate.push(t0 + 600us);
+    rate.push(t0 + 1'000us);
+    BOOST_TEST(rate.size() == 4ul);
+    BOOST_TEST(rate.get() == 4'000.0);
+    BOOST_TEST(rate.get(sliding_time_window_tag<100>) == 40.0);
+    // gaps of 200us, 400us and 400us
+    auto const w = sliding_time_window_tag<1>;
+    BOOST_TEST(rate.mean_interarrival(w).count() == 1e-3 / 3.0, tiny);
+    auto const mean = 1e-3 / 3.0;
+    auto const variance = ((2e-4 - mean) * (2e-4 - mean) + 2.0 * (4e-4 - mean) * (4e-4 - mean)) / 3.0;
+    BOOST_TEST(rate.interarrival_variance(w) == variance, tiny);
+    // the primary window is the default
+    BOOST_TEST(rate.mean_interarrival().count() == rate.mean_interarrival(w).count());
+    BOOST_TEST(rate.interarrival_variance() == rate.interarrival_variance(w));
+    BOOST_TEST(rate.mean_interarrival(sliding_time_window_tag<100>).count() == 1e-3 / 3.0, tiny);
+
+    // older events are discarded
+    rate.push(t0 + 900us);
+    BOOST_TEST(rate.size() == 4ul);
+
+    // the 1ms window drops the events at 0us and 200us
+    rate.advance(t0 + 1'300us);
+    BOOST_TEST(rate.size() == 2ul);
+    BOOST_TEST(rate.mean_interarrival(w).count() == 4e-4, tiny);
+    BOOST_TEST(rate.interarrival_variance(w) == 0.0);
+    BOOST_TEST(rate.size(sliding_time_window_tag<100>) == 4ul);
+    BOOST_TEST((rate.next_expiry() == t0 + 1'600us + 1ns));
+
+    rate.advance(t0 + 2'100us);
+    BOOST_TEST(rate.size() == 0ul);
+    BOOST_TEST(rate.mean_interarrival(w).count() == 0.0);
+    rate.advance(t0 + 200ms);
+    BOOST_TEST(rate.sample_buffer_size() == 0ul);
+
+    rate.push(t0 + 300ms);
+    BOOST_TEST(rate.size() == 1ul);
+    rate.reset();
+    BOOST_TEST(rate.size(sliding_time_window_tag<100>) == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(matches_brute_force)
+{
+    std::mt19937 rng(42);
+    std::exponential_distribution<double> gap_of(1.0 / 50.0); // Poisson arrivals, 50us apart on average
+    livestats::sliding_time_window_rate_estimator_t<5, 20> rate;
+    std::deque<std::chrono::steady_clock::time_point> events;
+    auto t = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10'000; ++i)
+    {
+        t += std::chrono::nanoseconds(static_cast<long>(gap_of(rng) * 1'000.0));
+        rate.push(t);
+        events.push_back(t);
+        while (events.front() < t - 5ms)
+            events.pop_front();
+        BOOST_REQUIRE(rate.size() == events.size());
+        if (i % 100 == 0 and events.size() >= 2ul)
+        {
+            double sum = 0.0;
+            double sum_squares = 0.0;
+            for (std::size_t k = 1ul; k < events.size(); ++k)
+            {
+                auto const gap = std::chrono::duration<double>(events[k] - events[k - 1ul]).count();
+                sum += gap;
+                sum_squares += gap * gap;
+            }
+            auto const n = static_cast<double>(events.size() - 1ul);
+            auto const w = sliding_time_window_tag<5>;
+            BOOST_TEST(rate.mean_interarrival(w).count() == sum / n, tiny);
+            BOOST_TEST(rate.interarrival_variance(w) == sum_squares / n - (sum / n) * (sum / n),
+                       boost::test_tools::tolerance(1e-6));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    livestats::pmr::sliding_time_window_rate_estimator_t<1> rate(16ul, &resource);
+    BOOST_TEST(rate.get_allocator().resource() == &resource);
+    BOOST_TEST(rate.memory_usage() == sizeof(rate) + 16ul * sizeof(std::chrono::steady_clock::time_point));
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::sliding_time_window_rate_estimator_t<1, 100> rate;
+    auto const t0 = std::chrono::steady_clock::now();
+    rate.push(t0);
+    rate.push(t0 + 200us);
+    rate.push(t0 + 600us);
+    rate.push(t0 + 1'000us);
+    rate.advance(t0 + 1'300us);
+    std::stringstream checkpoint;
+    rate.save(checkpoint);
+
+    livestats::sliding_time_window_rate_estimator_t<1, 100> restored(1ul);
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.sample_buffer_size() == 4ul);
+    BOOST_TEST(restored.size() == 2ul);
+    BOOST_TEST(restored.size(sliding_time_window_tag<100>) == 4ul);
+    BOOST_TEST(restored.interarrival_variance(sliding_time_window_tag<100>)
+        == rate.interarrival_variance(sliding_time_window_tag<100>));
+    BOOST_TEST((restored.next_expiry() == rate.next_expiry()));
+
+    // the restored events keep expiring as time goes by
+    restored.push(t0 + 1'500us);
+    restored.advance(t0 + 2'100us);
+    BOOST_TEST(restored.size() == 1ul);
+    BOOST_TEST(restored.size(sliding_time_window_tag<100>) == 5ul);
+
+    // state saved with different windows cannot be restored
+    checkpoint.seekg(0);
+    livestats::sliding_time_window_rate_estimator_t<1, 50> other;
+    other.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(other.sample_buffer_size() == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,182 @@
+#define BOOST_TEST_MODULE sliding_time_window_timer_wheel_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/sliding_time_window_mean_estimator.hpp"
+#include "livestats/sliding_time_window_timer_wheel.hpp"
+#include "livestats/sliding_time_window_variance_estimator.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+using mean_estimator_t = livestats::sliding_time_window_mean_estimator_t<double, 100>;
+using clock_type = std::chrono::steady_clock;
+
+static_assert(livestats::TimeWindowEstimator<mean_estimator_t>);
+static_assert(livestats::TimeWindowEstimator<livestats::sliding_time_window_variance_estimator_t<double, 1, 10>>);
+
+BOOST_AUTO_TEST_SUITE(sliding_time_window_timer_wheel_tests)
+
+BOOST_AUTO_TEST_CASE(next_expiry)
+{
+    livestats::sliding_time_window_mean_estimator_t<double, 10, 100> mean;
+    BOOST_TEST((mean.next_expiry() == clock_type::time_point::max()));
+    clock_type::time_point const t0;
+    mean.push(1.0, t0);
+    mean.push(2.0, t0 + 5ms);
+    BOOST_TEST((mean.next_expiry() == t0 + 10ms + 1ns));
+    mean.advance(t0 + 10ms);
+    BOOST_TEST(mean.size(livestats::sliding_time_window_tag<10>) == 2ul);
+    mean.advance(t0 + 10ms + 1ns);
+    BOOST_TEST(mean.size(livestats::sliding_time_window_tag<10>) == 1ul);
+    BOOST_TEST((mean.next_expiry() == t0 + 15ms + 1ns));
+    mean.advance(t0 + 20ms);
+    BOOST_TEST((mean.next_expiry() == t0 + 100ms + 1ns));
+}
+
+BOOST_AUTO_TEST_CASE(advance_only_due_estimators)
+{
+    clock_type::time_point const t0;
+    livestats::sliding_time_window_timer_wheel_t<mean_estimator_t> wheel(1ms, t0);
+    std::vector<mean_estimator_t> means(1000);
+    std::vector<decltype(wheel)::handle_t> handles;
+    for (auto& mean: means)
+        handles.push_back(wheel.add(mean));
+    BOOST_TEST(wheel.size() == 1000ul);
+    BOOST_TEST(wheel.size_scheduled() == 0ul);
+
+    // only one key in ten receives samples
+    for (std::size_t i = 0ul; i < means.size(); i += 10ul)
+        wheel.push(handles[i], 1.0, t0 + std::chrono::milliseconds(i / 10ul));
+    BOOST_TEST(wheel.size_scheduled() == 100ul);
+
+    BOOST_TEST(wheel.tick(t0 + 50ms) == 0ul);
+    BOOST_TEST(means[0].size() == 1ul);
+    // samples pushed at 0ms..9ms expire just after 100ms..109ms
+    BOOST_TEST(wheel.tick(t0 + 109ms) == 9ul);
+    BOOST_TEST(means[90].size() == 1ul);
+    BOOST_TEST(wheel.tick(t0 + 110ms) == 1ul);
+    BOOST_TEST(means[0].size() == 0ul);
+    BOOST_TEST(means[90].size() == 0ul);
+    BOOST_TEST(means[100].size() == 1ul);
+    BOOST_TEST(wheel.size_scheduled() == 90ul);
+    BOOST_TEST(wheel.tick(t0 + 1h) == 90ul);
+    BOOST_TEST(wheel.size_scheduled() == 0ul);
+    for (auto const& mean: means)
+        BOOST_TEST_REQUIRE(mean.size() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(remove_and_reschedule)
+{
+    clock_type::time_point const t0;
+    livestats::sliding_time_window_timer_wheel_t<mean_estimator_t> wheel(1ms, t0);
+    mean_estimator_t a;
+    mean_estimator_t b;
+    auto const ha = wheel.add(a);
+    auto const hb = wheel.add(b);
+    wheel.push(ha, 1.0, t0);
+    wheel.push(hb, 1.0, t0);
+    wheel.remove(ha);
+    BOOST_TEST(wheel.size() == 1ul);
+    BOOST_TEST(wheel.tick(t0 + 200ms) == 1ul);
+    BOOST_TEST(a.size() == 1ul);
+    BOOST_TEST(b.size() == 0ul);
+
+    // pushing directly into a registered estimator requires re-scheduling it
+    b.push(2.0, t0 + 300ms);
+    wheel.reschedule(hb);
+    BOOST_TEST(wheel.tick(t0 + 401ms) == 1ul);
+    BOOST_TEST(b.size() == 0ul);
+
+    // handles of removed estimators are reused
+    BOOST_TEST(wheel.add(a) == ha);
+}
+
+BOOST_AUTO_TEST_CASE(reschedule_late_samples_within_horizon)
+{
+    clock_type::time_point const t0;
+    livestats::sliding_time_window_timer_wheel_t<mean_estimator_t> wheel(1ms, t0);
+    mean_estimator_t mean;
+    mean.set_reorder_horizon(20ms);
+    auto const h = wheel.add(mean);
+
+    wheel.push(h, 1.0, t0 + 50ms);
+    BOOST_TEST(wheel.tick(t0 + 60ms) == 0ul);
+    // the late sample becomes the oldest one, and expires 15ms earlier
+    wheel.push(h, 2.0, t0 + 35ms);
+    BOOST_TEST(mean.size() == 2ul);
+    BOOST_TEST(wheel.tick(t0 + 135ms) == 0ul);
+    BOOST_TEST(wheel.tick(t0 + 136ms) == 1ul);
+    BOOST_TEST(mean.size() == 1ul);
+    BOOST_TEST(mean.get() == 1.0);
+    BOOST_TEST(wheel.tick(t0 + 151ms) == 1ul);
+    BOOST_TEST(mean.size() == 0ul);
+    BOOST_TEST(wheel.size_scheduled() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(match_direct_advance)
+{
+    // resolutions such that window expiries fall into every level of the wheel, and beyond its range
+    for (auto const resolution: {clock_type::duration(1ms), clock_type::duration(10us), clock_type::duration(1ns)})
+    {
+        clock_type::time_point const t0 = clock_type::time_point() + 1h;
+        livestats::sliding_time_window_timer_wheel_t<mean_estimator_t> wheel(resolution, t0);
+        std::vector<mean_estimator_t> means(200);
+        std::vector<decltype(wheel)::handle_t> handles;
+        for (auto& mean: means)
+            handles.push_back(wheel.add(mean));
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<std::size_t> keys(0ul, means.size() - 1ul);
+        // mostly short steps, sometimes long idle gaps
+        std::uniform_int_distribution<std::int64_t> steps(0, 2000);
+        auto now = t0;
+        for (int i = 0; i < 5000; ++i)
+        {
+            auto const step = steps(rng);
+            now += step < 1990 ? std::chrono::microseconds(step * 10) : std::chrono::microseconds(step * step * 10);
+            wheel.push(handles[keys(rng)], 1.0, now);
+            if (i % 7 == 0)
+            {
+                wheel.tick(now);
+                // every sample that expired before the current tick has been discarded
+                for (auto const& mean: means)
+                    BOOST_TEST_REQUIRE((mean.next_expiry() > now - resolution));
+            }
+        }
+        now += 10h;
+        wheel.tick(now);
+        BOOST_TEST(wheel.size_scheduled() == 0ul);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(background_thread)
+{
+    livestats::sliding_time_window_timer_wheel_t<mean_estimator_t, std::mutex> wheel(1ms);
+    std::vector<mean_estimator_t> means(10);
+    std::vector<decltype(wheel)::handle_t> handles;
+    for (auto& mean: means)
+        handles.push_back(wheel.add(mean));
+    {
+        auto const ticker = wheel.run_in_background(1ms);
+        for (auto const h: handles)
+            wheel.push(h, 1.0, clock_type::now());
+        auto const deadline = clock_type::now() + 10s;
+        bool all_empty = false;
+        while (not all_empty and clock_type::now() < deadline)
+        {
+            std::this_thread::sleep_for(10ms);
+            auto const lock = wheel.lock();
+            all_empty = true;
+            for (auto const& mean: means)
+                all_empty = all_empty and mean.size() == 0ul;
+        }
+        BOOST_TEST(all_empty);
+    }
+    BOOST_TEST(wheel.size_scheduled() == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,7 +1,14 @@
 #define BOOST_TEST_MODULE sliding_time_window_variance_estimator_tests
 #include <boost/test/included/unit_test.hpp>
 
+#include <array>
+#include <cmath>
+#include <memory_resource>
+#include <random>
+#include <span>
+#include <sstream>
 #include <thread>
+#include <vector>
 
 #include "livestats/sliding_time_window_variance_estimator.hpp"
 
@@ -375,4 +382,317 @@ BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
     BOOST_TEST(variance.sample_buffer_size() == 0ul);
 }
 
+BOOST_AUTO_TEST_CASE(accumulate_uint32_into_uint64)
+{
+    using variance_t = livestats::basic_sliding_time_window_variance_estimator_t<
+        std::uint32_t, std::uint64_t, std::allocator<std::uint32_t>, livestats::no_instrumentation_t, 1, 50>;
+    variance_t variance;
+    auto const t0 = std::chrono::steady_clock::now();
+    variance.push(4'000'000'000u, t0);
+    variance.push(4'000'000'002u, t0 + std::chrono::microseconds(10));
+    variance.push(4'000'000'004u, t0 + std::chrono::microseconds(20));
+    BOOST_TEST(variance.get() == 2u);
+    BOOST_TEST(variance.mean() == 4'000'000'002u);
+    BOOST_TEST(variance.get(livestats::sliding_time_window_tag<50>) == 2u);
+
+    variance.advance(t0 + std::chrono::microseconds(1'010));
+    BOOST_TEST(variance.get() == 1u);
+    BOOST_TEST(variance.mean() == 4'000'000'003u);
+    BOOST_TEST(variance.size() == 2ul);
+    BOOST_TEST(variance.get(livestats::sliding_time_window_tag<50>) == 2u);
+    BOOST_TEST(variance.mean(livestats::sliding_time_window_tag<50>) == 4'000'000'002u);
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    livestats::pmr::sliding_time_window_variance_estimator_t<double, 1, 50> variance(&arena);
+    BOOST_TEST(variance.get_allocator().resource() == &arena);
+    auto const t0 = std::chrono::steady_clock::now();
+    variance.push(1.0, t0);
+    variance.push(4.0, t0 + std::chrono::microseconds(10));
+    BOOST_TEST(variance.get() == 2.25);
+    BOOST_TEST(variance.mean() == 2.5);
+    BOOST_TEST(variance.sample_buffer_size() == 2ul);
+}
+
+BOOST_AUTO_TEST_CASE(preallocated_capacity_grow)
+{
+    livestats::sliding_time_window_variance_estimator_t<double, 1, 50> variance(2ul);
+    BOOST_TEST(variance.capacity() == 2ul);
+    BOOST_TEST(variance.high_watermark() == 0ul);
+    auto const t0 = std::chrono::steady_clock::now();
+    variance.push(1.0, t0);
+    variance.push(2.0, t0 + std::chrono::microseconds(10));
+    BOOST_TEST(variance.capacity() == 2ul);
+    variance.push(3.0, t0 + std::chrono::microseconds(20));
+    variance.push(4.0, t0 + std::chrono::microseconds(30));
+    BOOST_TEST(variance.capacity() == 4ul);
+    BOOST_TEST(variance.high_watermark() == 4ul);
+    BOOST_TEST(variance.size() == 4ul);
+    BOOST_TEST(variance.size_dropped() == 0ul);
+    BOOST_TEST(variance.get() == 1.25);
+    BOOST_TEST(variance.mean() == 2.5);
+
+    // the 50ms window still needs all samples, so the buffer only shrinks once they fall out of that window
+    variance.advance(t0 + std::chrono::microseconds(1'025));
+    BOOST_TEST(variance.size() == 1ul);
+    BOOST_TEST(variance.sample_buffer_size() == 4ul);
+    variance.advance(t0 + std::chrono::microseconds(50'025));
+    BOOST_TEST(variance.sample_buffer_size() == 1ul);
+    BOOST_TEST(variance.high_watermark() == 4ul);
+    BOOST_TEST(variance.capacity() == 4ul);
+
+    variance.reset();
+    BOOST_TEST(variance.high_watermark() == 0ul);
+    BOOST_TEST(variance.capacity() == 4ul);
+}
+
+BOOST_AUTO_TEST_CASE(preallocated_capacity_drop_oldest)
+{
+    livestats::sliding_time_window_variance_estimator_t<double, 1, 50> variance(
+        2ul, livestats::sliding_time_window_overflow_policy::drop_oldest);
+    auto const t0 = std::chrono::steady_clock::now();
+    variance.push(1.0, t0);
+    variance.push(2.0, t0 + std::chrono::microseconds(10));
+    variance.push(4.0, t0 + std::chrono::microseconds(20));
+    variance.push(6.0, t0 + std::chrono::microseconds(30));
+    BOOST_TEST(variance.capacity() == 2ul);
+    BOOST_TEST(variance.high_watermark() == 2ul);
+    BOOST_TEST(variance.sample_buffer_size() == 2ul);
+    BOOST_TEST(variance.size() == 2ul);
+    BOOST_TEST(variance.size(livestats::sliding_time_window_tag<50>) == 2ul);
+    BOOST_TEST(variance.size_dropped() == 2ul);
+    BOOST_TEST(variance.get() == 1.0);
+    BOOST_TEST(variance.mean() == 5.0);
+    BOOST_TEST(variance.mean(livestats::sliding_time_window_tag<50>) == 5.0);
+
+    // the 1ms window drops the sample at 20us, so only the 50ms window contains the oldest sample
+    variance.advance(t0 + std::chrono::microseconds(1'025));
+    BOOST_TEST(variance.size() == 1ul);
+    variance.push(8.0, t0 + std::chrono::microseconds(1'030));
+    BOOST_TEST(variance.size_dropped() == 3ul);
+    BOOST_TEST(variance.size() == 2ul);
+    BOOST_TEST(variance.size(livestats::sliding_time_window_tag<50>) == 2ul);
+    BOOST_TEST(variance.get(livestats::sliding_time_window_tag<50>) == 1.0);
+    BOOST_TEST(variance.mean(livestats::sliding_time_window_tag<50>) == 7.0);
+
+    variance.reset();
+    BOOST_TEST(variance.size_dropped() == 0ul);
+    BOOST_TEST(variance.capacity() == 2ul);
+}
+
+BOOST_AUTO_TEST_CASE(push_range)
+{
+    using livestats::sliding_time_window_tag;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> value_of(0.0, 10.0);
+    std::uniform_int_distribution<int> step_of(0, 200);
+    auto t = std::chrono::steady_clock::now();
+    std::vector<std::chrono::steady_clock::time_point> timestamps;
+    std::vector<double> values;
+    for (int i = 0; i < 1'000; ++i)
+    {
+        t += std::chrono::microseconds(step_of(rng));
+        timestamps.push_back(i % 50 == 49 ? t - std::chrono::microseconds(150) : t);
+        values.push_back(value_of(rng));
+    }
+
+    livestats::sliding_time_window_variance_estimator_t<double, 1, 10> expected;
+    livestats::sliding_time_window_variance_estimator_t<double, 1, 10> variance;
+    expected.set_reorder_horizon(std::chrono::microseconds(100));
+    variance.set_reorder_horizon(std::chrono::microseconds(100));
+    for (std::size_t i = 0ul; i < values.size(); ++i)
+    {
+        expected.push(values[i], timestamps[i]);
+        // push in batches of various sizes
+        if (i % 37 == 36 or i + 1ul == values.size())
+        {
+            auto const begin = i - i % 37;
+            variance.push_range(
+                std::span(timestamps).subspan(begin, i + 1ul - begin),
+                std::span<double const>(values).subspan(begin, i + 1ul - begin));
+            BOOST_TEST(variance.size() == expected.size());
+            BOOST_TEST(variance.get() == expected.get(), boost::test_tools::tolerance(1e-9));
+            BOOST_TEST(variance.mean() == expected.mean(), boost::test_tools::tolerance(1e-9));
+            BOOST_TEST(variance.size(sliding_time_window_tag<10>) == expected.size(sliding_time_window_tag<10>));
+            BOOST_TEST(
+                variance.get(sliding_time_window_tag<10>) == expected.get(sliding_time_window_tag<10>),
+                boost::test_tools::tolerance(1e-9));
+        }
+    }
+    BOOST_TEST(variance.size_late() == expected.size_late());
+}
+
+BOOST_AUTO_TEST_CASE(reorder_horizon_exact)
+{
+    // samples arrive up to 1.5ms late; the windows must match those computed over all samples received so far
+    using livestats::sliding_time_window_tag;
+    livestats::sliding_time_window_variance_estimator_t<double, 1, 5> variance;
+    variance.set_reorder_horizon(std::chrono::milliseconds(2));
+    auto const t0 = std::chrono::steady_clock::now();
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<long> jitter(0, 1'500);
+    std::uniform_real_distribution<double> values(0.0, 100.0);
+
+    struct sample_t { std::chrono::steady_clock::time_point timestamp; double value; };
+    std::vector<sample_t> received;
+    auto latest = t0;
+    auto const expected = [&] (std::chrono::milliseconds const w) {
+        double sum = 0.0;
+        std::size_t n = 0ul;
+        for (auto const& s: received)
+            if (s.timestamp >= latest - w)
+            {
+                sum += s.value;
+                ++n;
+            }
+        auto const mean = n > 0ul ? sum / static_cast<double>(n) : 0.0;
+        double n_s = 0.0;
+        for (auto const& s: received)
+            if (s.timestamp >= latest - w)
+                n_s += (s.value - mean) * (s.value - mean);
+        return std::array{static_cast<double>(n), mean, n > 0ul ? n_s / static_cast<double>(n) : 0.0};
+    };
+    for (long i = 0; i < 1'000; ++i)
+    {
+        sample_t const s{t0 + std::chrono::microseconds(100 * i + jitter(rng)), values(rng)};
+        variance.push(s.value, s.timestamp);
+        received.push_back(s);
+        latest = std::max(latest, s.timestamp);
+
+        auto const [n1, mean1, variance1] = expected(std::chrono::milliseconds(1));
+        BOOST_TEST(variance.size(sliding_time_window_tag<1>) == n1);
+        BOOST_TEST(variance.mean(sliding_time_window_tag<1>) == mean1, tiny);
+        BOOST_TEST(std::abs(variance.get(sliding_time_window_tag<1>) - variance1) < 1e-6);
+        auto const [n5, mean5, variance5] = expected(std::chrono::milliseconds(5));
+        BOOST_TEST(variance.size(sliding_time_window_tag<5>) == n5);
+        BOOST_TEST(variance.mean(sliding_time_window_tag<5>) == mean5, tiny);
+        BOOST_TEST(std::abs(variance.get(sliding_time_window_tag<5>) - variance5) < 1e-6);
+    }
+    BOOST_TEST(variance.size_late() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(merge_windows_of_shards)
+{
+    using estimator_t = livestats::sliding_time_window_variance_estimator_t<double, 10, 100>;
+    estimator_t a;
+    estimator_t b;
+    estimator_t all;
+    auto const t0 = std::chrono::steady_clock::now();
+    std::mt19937_64 engine(7ul);
+    std::uniform_real_distribution<double> values(0.0, 100.0);
+    for (std::size_t i = 0ul; i < 200ul; ++i)
+    {
+        auto const t = t0 + std::chrono::microseconds(997ul * i);
+        auto const x = values(engine);
+        (i % 3ul == 0ul ? a : b).push(x, t);
+        all.push(x, t);
+    }
+    auto const now = t0 + std::chrono::milliseconds(250);
+    all.advance(now);
+
+    auto const merged = merge_windows(a, b, now);
+    BOOST_TEST(merged.size() == all.size());
+    BOOST_TEST(merged.mean() == all.mean(), tiny);
+    BOOST_TEST(merged.get() == all.get(), tiny);
+    BOOST_TEST(merged.size(livestats::sliding_time_window_tag<100>) == all.size(livestats::sliding_time_window_tag<100>));
+    BOOST_TEST(merged.mean(livestats::sliding_time_window_tag<100>) == all.mean(livestats::sliding_time_window_tag<100>),
+               tiny);
+    BOOST_TEST(merged.get(livestats::sliding_time_window_tag<100>) == all.get(livestats::sliding_time_window_tag<100>),
+               tiny);
+
+    // both shards were aligned to `now`
+    BOOST_TEST(a.size(livestats::sliding_time_window_tag<100>) + b.size(livestats::sliding_time_window_tag<100>)
+               == all.size(livestats::sliding_time_window_tag<100>));
+
+    // empty shards contribute nothing
+    estimator_t empty;
+    auto const same = merge_windows(a, empty, now);
+    BOOST_TEST(same.size() == a.size());
+    BOOST_TEST(same.get(livestats::sliding_time_window_tag<100>) == a.get(livestats::sliding_time_window_tag<100>));
+}
+
+BOOST_AUTO_TEST_CASE(merge_samples_of_shards)
+{
+    using estimator_t = livestats::sliding_time_window_variance_estimator_t<double, 10, 100>;
+    std::array<estimator_t, 3ul> shards;
+    estimator_t all;
+    auto const t0 = std::chrono::steady_clock::now();
+    std::mt19937_64 engine(11ul);
+    std::uniform_real_distribution<double> values(0.0, 100.0);
+    for (std::size_t i = 0ul; i < 300ul; ++i)
+    {
+        auto const t = t0 + std::chrono::microseconds(1'003ul * i);
+        auto const x = values(engine);
+        shards[i % 3ul].push(x, t);
+        all.push(x, t);
+    }
+
+    estimator_t merged(4ul, livestats::sliding_time_window_overflow_policy::drop_oldest);
+    std::array<estimator_t const*, 2ul> const others{&shards[1], &shards[2]};
+    merged.merge(shards[0]);
+    merged.merge(others);
+    BOOST_TEST(merged.sample_buffer_size() == all.sample_buffer_size());
+    BOOST_TEST(merged.size() == all.size());
+    BOOST_TEST(merged.get() == all.get(), tiny);
+    BOOST_TEST(merged.size(livestats::sliding_time_window_tag<100>) == all.size(livestats::sliding_time_window_tag<100>));
+    BOOST_TEST(merged.get(livestats::sliding_time_window_tag<100>) == all.get(livestats::sliding_time_window_tag<100>),
+               tiny);
+    BOOST_TEST(merged.size_dropped() == 0ul);
+
+    // the merged estimator keeps evolving like one fed all the samples
+    for (std::size_t i = 300ul; i < 400ul; ++i)
+    {
+        auto const t = t0 + std::chrono::microseconds(1'003ul * i);
+        auto const x = values(engine);
+        merged.push(x, t);
+        all.push(x, t);
+    }
+    all.advance(t0 + std::chrono::milliseconds(450));
+    merged.advance(t0 + std::chrono::milliseconds(450));
+    BOOST_TEST(merged.sample_buffer_size() == all.sample_buffer_size());
+    BOOST_TEST(merged.size() == all.size());
+    BOOST_TEST(merged.mean() == all.mean(), tiny);
+    BOOST_TEST(merged.get(livestats::sliding_time_window_tag<100>) == all.get(livestats::sliding_time_window_tag<100>),
+               tiny);
+    BOOST_TEST((merged.next_expiry() == all.next_expiry()));
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::sliding_time_window_variance_estimator_t<double, 1, 50> variance;
+    auto const t0 = std::chrono::steady_clock::now();
+    variance.push(1.0, t0);
+    variance.push(4.0, t0 + std::chrono::microseconds(10));
+    variance.push(17.0, t0 + std::chrono::microseconds(1'005));
+    std::stringstream checkpoint;
+    variance.save(checkpoint);
+
+    livestats::sliding_time_window_variance_estimator_t<double, 1, 50> restored(1ul);
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.sample_buffer_size() == 3ul);
+    BOOST_TEST(restored.high_watermark() == 3ul);
+    BOOST_TEST(restored.size() == 2ul);
+    BOOST_TEST(restored.size(livestats::sliding_time_window_tag<50>) == 3ul);
+    BOOST_TEST(restored.get() == variance.get());
+    BOOST_TEST(restored.mean(livestats::sliding_time_window_tag<50>) == variance.mean(livestats::sliding_time_window_tag<50>));
+
+    // the restored samples keep expiring as time goes by
+    restored.advance(t0 + std::chrono::microseconds(1'015));
+    variance.advance(t0 + std::chrono::microseconds(1'015));
+    BOOST_TEST(restored.size() == 1ul);
+    BOOST_TEST(restored.get() == variance.get());
+    BOOST_TEST(restored.sample_buffer_size() == 3ul);
+
+    // state saved with different windows cannot be restored
+    checkpoint.seekg(0);
+    livestats::sliding_time_window_variance_estimator_t<double, 1, 100> other;
+    other.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(other.sample_buffer_size() == 0ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,119 @@
+#define BOOST_TEST_MODULE sliding_window_aggregator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <memory_resource>
+#include <random>
+#include <string>
+
+#include "livestats/sliding_window_aggregator.hpp"
+
+namespace {
+
+/**
+ * Concatenation is associative but not commutative, so it checks that values are combined in order.
+ */
+struct concat_monoid_t
+{
+    using value_type = std::string;
+    std::string identity() const { return {}; }
+    std::string combine(std::string const& a, std::string const& b) const { return a + b; }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(sliding_window_aggregator_tests)
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_max)
+{
+    livestats::sliding_window_aggregator_t<livestats::math::max_monoid_t<double>> max(3ul);
+    BOOST_TEST(max.size() == 0ul);
+    BOOST_TEST(max.add(2.0) == 2.0);
+    BOOST_TEST(max.add(5.0) == 5.0);
+    BOOST_TEST(max.add(1.0) == 5.0);
+    BOOST_TEST(max.full());
+    BOOST_TEST(max.add(3.0) == 5.0);
+    BOOST_TEST(max.add(0.0) == 3.0);
+    BOOST_TEST(max.add(-1.0) == 3.0);
+    BOOST_TEST(max.add(-2.0) == 0.0);
+    BOOST_TEST(max.size() == 3ul);
+    max.reset();
+    BOOST_TEST(max.size() == 0ul);
+    BOOST_TEST(max.get() == -std::numeric_limits<double>::infinity());
+    BOOST_TEST(max.add(-7.0) == -7.0);
+}
+
+BOOST_AUTO_TEST_CASE(non_commutative)
+{
+    livestats::sliding_window_aggregator_t<concat_monoid_t> window(4ul);
+    std::string expected;
+    for (char c = 'a'; c <= 'z'; ++c)
+    {
+        expected.push_back(c);
+        if (expected.size() > 4ul)
+            expected.erase(0ul, 1ul);
+        BOOST_TEST(window.add(std::string(1ul, c)) == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(random_push_pop)
+{
+    // arbitrary interleavings of pushes and pops, as with time windows, against a brute force
+    std::mt19937 rng(42);
+    std::bernoulli_distribution push_of(0.55);
+    livestats::math::sliding_aggregation_t<concat_monoid_t> queue;
+    std::deque<char> expected;
+    for (int i = 0; i < 20'000; ++i)
+    {
+        if (expected.empty() or push_of(rng))
+        {
+            auto const c = static_cast<char>('a' + i % 26);
+            queue.push_back(std::string(1ul, c));
+            expected.push_back(c);
+        }
+        else
+        {
+            BOOST_TEST(queue.front() == std::string(1ul, expected.front()));
+            queue.pop_front();
+            expected.pop_front();
+        }
+        BOOST_REQUIRE(queue.size() == expected.size());
+        BOOST_REQUIRE(queue.aggregate() == std::string(expected.begin(), expected.end()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(min_matches_brute_force)
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> value_of(-1'000, 1'000);
+    for (std::size_t const window_size: {1ul, 2ul, 7ul, 64ul})
+    {
+        livestats::sliding_window_aggregator_t<livestats::math::min_monoid_t<int>> min(window_size);
+        std::deque<int> samples;
+        for (int i = 0; i < 5'000; ++i)
+        {
+            auto const x = value_of(rng);
+            samples.push_back(x);
+            if (samples.size() > window_size)
+                samples.pop_front();
+            BOOST_REQUIRE(min.add(x) == *std::min_element(samples.begin(), samples.end()));
+        }
+        // the window buffer never grows beyond the window size
+        BOOST_TEST(min.memory_usage() <= sizeof(min) + window_size * 2ul * sizeof(int));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    livestats::pmr::sliding_window_aggregator_t<livestats::math::sum_monoid_t<double>> sum(2ul, {}, &resource);
+    BOOST_TEST(sum.get_allocator().resource() == &resource);
+    sum.push(1.0);
+    sum.push(2.0);
+    sum.push(4.0);
+    BOOST_TEST(sum.get() == 6.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+#define BOOST_TEST_MODULE sliding_window_covariance_estimator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/sliding_window_covariance_estimator.hpp"
+
+#include <array>
+#include <cmath>
+#include <memory_resource>
+#include <sstream>
+#include <vector>
+
+static const auto tiny = boost::test_tools::tolerance(1e-9);
+
+BOOST_AUTO_TEST_SUITE(sliding_window_covariance_estimator_tests)
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
+{
+    livestats::sliding_window_covariance_estimator_t<double> covariance(3ul);
+    BOOST_TEST(covariance.get() == 0.0, tiny);
+    BOOST_TEST(covariance.size() == 0ul);
+    BOOST_TEST(covariance.full() == false, tiny);
+
+    BOOST_TEST(covariance.add(1.0, 2.0) == 0.0, tiny);
+    BOOST_TEST(covariance.add(2.0, 4.0) == 0.5, tiny);
+    BOOST_TEST(covariance.correlation() == 1.0, tiny);
+    BOOST_TEST(covariance.slope() == 2.0, tiny);
+    BOOST_TEST(covariance.full() == false, tiny);
+
+    // window {(1, 2), (2, 4), (3, 5)}
+    BOOST_TEST(covariance.add(3.0, 5.0) == 1.0, tiny);
+    BOOST_TEST(covariance.full() == true, tiny);
+    BOOST_TEST(covariance.slope() == 1.5, tiny);
+
+    // window {(2, 4), (3, 5), (4, 4)}
+    BOOST_TEST(std::abs(covariance.add(4.0, 4.0)) < 1e-12);
+    BOOST_TEST(covariance.size() == 3ul);
+    BOOST_TEST(std::abs(covariance.correlation()) < 1e-12);
+    BOOST_TEST(covariance.mean_x() == 3.0, tiny);
+    BOOST_TEST(covariance.mean_y() == 13.0 / 3.0, tiny);
+
+    // window {(3, 5), (4, 4), (5, 5)}
+    BOOST_TEST(std::abs(covariance.add(5.0, 5.0)) < 1e-12);
+    BOOST_TEST(covariance.variance_x() == 2.0 / 3.0, tiny);
+    BOOST_TEST(covariance.variance_y() == 2.0 / 9.0, tiny);
+    BOOST_TEST(std::abs(covariance.slope()) < 1e-12);
+
+    covariance.reset();
+    BOOST_TEST(covariance.get() == 0.0, tiny);
+    BOOST_TEST(covariance.size() == 0ul);
+    BOOST_TEST(covariance.full() == false, tiny);
+}
+
+BOOST_AUTO_TEST_CASE(brute_force)
+{
+    constexpr std::size_t window_size = 7ul;
+    livestats::sliding_window_covariance_estimator_t<double> covariance(window_size);
+    std::vector<double> xs;
+    std::vector<double> ys;
+    for (std::size_t i = 0ul; i < 100ul; ++i)
+    {
+        auto const x = std::sin(0.37 * static_cast<double>(i)) * 10.0;
+        auto const y = 0.5 * x + std::cos(1.3 * static_cast<double>(i)) * 3.0 - 4.0;
+        xs.push_back(x);
+        ys.push_back(y);
+        covariance.push(x, y);
+
+        auto const first = xs.size() > window_size ? xs.size() - window_size : 0ul;
+        auto const n = static_cast<double>(xs.size() - first);
+        double mean_x = 0.0, mean_y = 0.0;
+        for (auto j = first; j < xs.size(); ++j)
+        {
+            mean_x += xs[j] / n;
+            mean_y += ys[j] / n;
+        }
+        double m2_x = 0.0, m2_y = 0.0, c_xy = 0.0;
+        for (auto j = first; j < xs.size(); ++j)
+        {
+            m2_x += (xs[j] - mean_x) * (xs[j] - mean_x);
+            m2_y += (ys[j] - mean_y) * (ys[j] - mean_y);
+            c_xy += (xs[j] - mean_x) * (ys[j] - mean_y);
+        }
+        BOOST_TEST(std::abs(covariance.get() - c_xy / n) < 1e-9);
+        BOOST_TEST(std::abs(covariance.mean_x() - mean_x) < 1e-9);
+        BOOST_TEST(std::abs(covariance.mean_y() - mean_y) < 1e-9);
+        if (m2_x > 0.0 and m2_y > 0.0)
+            BOOST_TEST(std::abs(covariance.correlation() - c_xy / std::sqrt(m2_x * m2_y)) < 1e-9);
+        if (m2_x > 0.0)
+            BOOST_TEST(std::abs(covariance.slope() - c_xy / m2_x) < 1e-9);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::array<std::byte, 1024> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    livestats::pmr::sliding_window_covariance_estimator_t<double> covariance(16ul, &arena);
+    BOOST_TEST(covariance.get_allocator().resource() == &arena);
+    covariance.push(1.0, 2.0);
+    covariance.push(2.0, 4.0);
+    BOOST_TEST(covariance.get() == 0.5, tiny);
+    BOOST_TEST(covariance.size() == 2ul);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::sliding_window_covariance_estimator_t<double> covariance(3ul);
+    covariance.push(1.0, 2.0);
+    covariance.push(2.0, 4.0);
+    covariance.push(3.0, 5.0);
+    covariance.push(4.0, 4.0);
+    std::stringstream checkpoint;
+    covariance.save(checkpoint);
+
+    livestats::sliding_window_covariance_estimator_t<double> restored(3ul);
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.size() == 3ul);
+    BOOST_TEST(restored.get() == covariance.get(), tiny);
+
+    // the restored window keeps sliding
+    restored.push(5.0, 5.0);
+    covariance.push(5.0, 5.0);
+    BOOST_TEST(restored.get() == covariance.get(), tiny);
+    BOOST_TEST(restored.mean_x() == covariance.mean_x(), tiny);
+
+    // state saved with a different window size cannot be restored
+    checkpoint.seekg(0);
+    livestats::sliding_window_covariance_estimator_t<double> other(4ul);
+    other.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(other.size() == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,11 @@
 
 #include "livestats/sliding_window_mean_estimator.hpp"
 
+#include <sstream>
+
+#include <array>
+#include <memory_resource>
+
 BOOST_AUTO_TEST_SUITE(sliding_window_mean_estimator_tests)
 
 BOOST_AUTO_TEST_CASE(add_push_get_reset_uint64)
@@ -123,4 +128,61 @@ BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
     BOOST_TEST(mean.size() == 3ul);
 }
 
+BOOST_AUTO_TEST_CASE(accumulate_uint32_into_uint64)
+{
+    livestats::sliding_window_mean_estimator_t<std::uint32_t, std::uint64_t> mean(3ul);
+    BOOST_TEST(mean.add(4'000'000'000u) == 4'000'000'000u);
+    BOOST_TEST(mean.add(4'000'000'002u) == 4'000'000'001u);
+    BOOST_TEST(mean.add(4'000'000'004u) == 4'000'000'002u);
+    BOOST_TEST(mean.add(4'000'000'006u) == 4'000'000'004u);
+    BOOST_TEST(mean.get_sum() == 12'000'000'012ul);
+    BOOST_TEST(mean.oldest() == 4'000'000'002u);
+    BOOST_TEST(mean.size() == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::array<std::byte, 1024> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    livestats::pmr::sliding_window_mean_estimator_t<double> mean(3ul, &arena);
+    BOOST_TEST(mean.get_allocator().resource() == &arena);
+    for (auto const x: {1.0, 3.0, 17.0, 1.0, 1.0})
+        mean.push(x);
+    BOOST_TEST(mean.get() == 19.0/3);
+    BOOST_TEST(mean.size() == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(memory_usage)
+{
+    livestats::sliding_window_mean_estimator_t<double> mean(100ul);
+    BOOST_TEST(mean.memory_usage() == sizeof(mean) + 100ul * sizeof(double));
+    mean.push(1.0);
+    BOOST_TEST(mean.memory_usage() == sizeof(mean) + 100ul * sizeof(double));
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::sliding_window_mean_estimator_t<double> mean(3ul);
+    for (auto const x: {1.0, 3.0, 17.0, 1.0})
+        mean.push(x);
+    std::stringstream checkpoint;
+    mean.save(checkpoint);
+
+    livestats::sliding_window_mean_estimator_t<double> restored(3ul);
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.get() == mean.get());
+    BOOST_TEST(restored.size() == 3ul);
+    BOOST_TEST(restored.oldest() == 3.0);
+    BOOST_TEST(restored.add(6.0) == mean.add(6.0));
+    BOOST_TEST(restored.oldest() == 17.0);
+
+    // state saved with a different window size cannot be restored
+    checkpoint.seekg(0);
+    livestats::sliding_window_mean_estimator_t<double> smaller(2ul);
+    smaller.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(smaller.size() == 0ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,147 @@
+#define BOOST_TEST_MODULE sliding_window_median_estimator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/sliding_window_median_estimator.hpp"
+
+#include <sstream>
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(sliding_window_median_estimator_tests)
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_uint64)
+{
+    livestats::sliding_window_median_estimator_t<std::uint64_t> median(3ul);
+    BOOST_TEST(median.get() == 0ul);
+    BOOST_TEST(median.size() == 0ul);
+    BOOST_TEST(median.median_absolute_deviation() == 0ul);
+
+    BOOST_TEST(median.add(5ul) == 5ul);
+    BOOST_TEST(median.size() == 1ul);
+
+    BOOST_TEST(median.add(1ul) == 3ul);
+    BOOST_TEST(median.size() == 2ul);
+    BOOST_TEST(median.median_absolute_deviation() == 2ul);
+
+    BOOST_TEST(median.add(100ul) == 5ul);
+    BOOST_TEST(median.size() == 3ul);
+    BOOST_TEST(median.full());
+    BOOST_TEST(median.median_absolute_deviation() == 4ul);
+
+    // 5 leaves the window
+    BOOST_TEST(median.add(2ul) == 2ul);
+    BOOST_TEST(median.size() == 3ul);
+    BOOST_TEST(median.sample(0ul) == 1ul);
+    BOOST_TEST(median.sample(2ul) == 2ul);
+    BOOST_TEST(median.nth(0ul) == 1ul);
+    BOOST_TEST(median.nth(2ul) == 100ul);
+    BOOST_TEST(median.count_less(100ul) == 2ul);
+
+    median.reset();
+    BOOST_TEST(median.get() == 0ul);
+    BOOST_TEST(median.size() == 0ul);
+    median.push(5ul);
+    median.push(1ul);
+    median.push(100ul);
+    BOOST_TEST(median.get() == 5ul);
+}
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
+{
+    livestats::sliding_window_median_estimator_t<double> median(4ul);
+    BOOST_TEST(median.add(1.0) == 1.0);
+    BOOST_TEST(median.add(2.0) == 1.5);
+    BOOST_TEST(median.add(8.0) == 2.0);
+    BOOST_TEST(median.add(-4.0) == 1.5);
+    // deviations from 1.5: 0.5, 0.5, 6.5, 5.5
+    BOOST_TEST(median.median_absolute_deviation() == 3.0);
+    BOOST_TEST(median.add(2.0) == 2.0);
+    BOOST_TEST(median.size() == 4ul);
+}
+
+BOOST_AUTO_TEST_CASE(match_sorted_window)
+{
+    std::mt19937 rng(42);
+    for (auto const window_size: {1ul, 2ul, 3ul, 8ul, 31ul})
+    {
+        livestats::sliding_window_median_estimator_t<std::int64_t> median(window_size);
+        std::deque<std::int64_t> window;
+        // few distinct values so that there are many ties
+        std::uniform_int_distribution<std::int64_t> values(-20, 20);
+        for (int i = 0; i < 2000; ++i)
+        {
+            auto const x = values(rng);
+            median.push(x);
+            window.push_back(x);
+            if (window.size() > window_size)
+                window.pop_front();
+
+            std::vector<std::int64_t> sorted(window.begin(), window.end());
+            std::sort(sorted.begin(), sorted.end());
+            auto const n = sorted.size();
+            auto const middle = [] (std::vector<std::int64_t> const& v)
+            {
+                auto const n = v.size();
+                return n % 2 ? v[n / 2] : v[n / 2 - 1] + (v[n / 2] - v[n / 2 - 1]) / 2;
+            };
+            auto const expected_median = middle(sorted);
+            std::vector<std::int64_t> deviations;
+            for (auto const y: sorted)
+                deviations.push_back(y < expected_median ? expected_median - y : y - expected_median);
+            std::sort(deviations.begin(), deviations.end());
+
+            BOOST_TEST_REQUIRE(median.size() == n);
+            BOOST_TEST_REQUIRE(median.get() == expected_median);
+            BOOST_TEST_REQUIRE(median.median_absolute_deviation() == middle(deviations));
+            for (std::size_t k = 0ul; k < n; ++k)
+            {
+                BOOST_TEST_REQUIRE(median.nth(k) == sorted[k]);
+                BOOST_TEST_REQUIRE(median.sample(k) == window[k]);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::array<std::byte, 1024> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    livestats::pmr::sliding_window_median_estimator_t<double> median(3ul, &arena);
+    BOOST_TEST(median.get_allocator().resource() == &arena);
+    for (auto const x: {1.0, 3.0, 17.0, 1.0, 1.0})
+        median.push(x);
+    BOOST_TEST(median.get() == 1.0);
+    BOOST_TEST(median.size() == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::sliding_window_median_estimator_t<double> median(3ul);
+    for (auto const x: {1.0, 3.0, 17.0, 1.0})
+        median.push(x);
+    std::stringstream checkpoint;
+    median.save(checkpoint);
+
+    livestats::sliding_window_median_estimator_t<double> restored(3ul);
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.get() == median.get());
+    BOOST_TEST(restored.size() == 3ul);
+    BOOST_TEST(restored.sample(0ul) == 3.0);
+    BOOST_TEST(restored.add(6.0) == median.add(6.0));
+    BOOST_TEST(restored.sample(0ul) == 17.0);
+
+    // state saved with a different window size cannot be restored
+    checkpoint.seekg(0);
+    livestats::sliding_window_median_estimator_t<double> smaller(2ul);
+    smaller.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(smaller.size() == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
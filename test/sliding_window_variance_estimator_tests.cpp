@@ -3,6 +3,11 @@
 
 #include "livestats/sliding_window_variance_estimator.hpp"
 
+#include <sstream>
+
+#include <array>
+#include <memory_resource>
+
 static const auto tiny = boost::test_tools::tolerance(1e-12);
 
 BOOST_AUTO_TEST_SUITE(sliding_window_variance_estimator_tests)
@@ -125,4 +130,52 @@ BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
     BOOST_TEST(variance.size() == 3ul);
 }
 
+BOOST_AUTO_TEST_CASE(accumulate_uint32_into_uint64)
+{
+    livestats::sliding_window_variance_estimator_t<std::uint32_t, std::uint64_t> variance(3ul);
+    BOOST_TEST(variance.add(4'000'000'000u) == 0u);
+    BOOST_TEST(variance.add(4'000'000'002u) == 1u);
+    BOOST_TEST(variance.add(4'000'000'004u) == 2u);
+    BOOST_TEST(variance.add(4'000'000'006u) == 2u);
+    BOOST_TEST(variance.size() == 3ul);
+    BOOST_TEST(variance.oldest() == 4'000'000'002u);
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::array<std::byte, 1024> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    livestats::pmr::sliding_window_variance_estimator_t<double> variance(3ul, &arena);
+    BOOST_TEST(variance.get_allocator().resource() == &arena);
+    for (auto const x: {1.0, 3.0, 17.0, 1.0, 1.0})
+        variance.push(x);
+    BOOST_TEST(variance.get() == 56.888888888888, tiny);
+    BOOST_TEST(variance.size() == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::sliding_window_variance_estimator_t<double> variance(3ul);
+    for (auto const x: {1.0, 3.0, 17.0, 1.0})
+        variance.push(x);
+    std::stringstream checkpoint;
+    variance.save(checkpoint);
+
+    livestats::sliding_window_variance_estimator_t<double> restored(3ul);
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.get() == variance.get());
+    BOOST_TEST(restored.size() == 3ul);
+    BOOST_TEST(restored.oldest() == 3.0);
+    BOOST_TEST(restored.add(6.0) == variance.add(6.0));
+    BOOST_TEST(restored.oldest() == 17.0);
+
+    // state saved with a different window size cannot be restored
+    checkpoint.seekg(0);
+    livestats::sliding_window_variance_estimator_t<double> smaller(2ul);
+    smaller.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(smaller.size() == 0ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,147 @@
+#define BOOST_TEST_MODULE static_sliding_time_window_variance_estimator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/sliding_time_window_variance_estimator.hpp"
+#include "livestats/static_sliding_time_window_variance_estimator.hpp"
+
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <type_traits>
+
+static const auto tiny = boost::test_tools::tolerance(1e-9);
+
+BOOST_AUTO_TEST_SUITE(static_sliding_time_window_variance_estimator_tests)
+
+using namespace std::chrono_literals;
+using livestats::sliding_time_window_tag;
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset)
+{
+    livestats::static_sliding_time_window_variance_estimator_t<double, 8ul, 1, 50> variance;
+    static_assert(std::is_trivially_copyable_v<decltype(variance)>);
+    BOOST_TEST(variance.get() == 0.0);
+    BOOST_TEST(variance.size() == 0ul);
+    BOOST_TEST((variance.next_expiry() == std::chrono::steady_clock::time_point::max()));
+
+    auto const t0 = std::chrono::steady_clock::now();
+    variance.push(1.0, t0);
+    variance.push(3.0, t0 + 200us);
+    variance.push(5.0, t0 + 600us);
+    BOOST_TEST(variance.size() == 3ul);
+    BOOST_TEST(variance.mean() == 3.0);
+    BOOST_TEST(variance.get() == 8.0 / 3.0, tiny);
+    BOOST_TEST((variance.next_expiry() == t0 + 1ms + 1ns));
+
+    // older samples are discarded
+    variance.push(100.0, t0 + 100us);
+    BOOST_TEST(variance.size() == 3ul);
+
+    // the 1ms window drops the samples at 0us and 200us, while the 50ms window keeps them
+    variance.advance(t0 + 1'300us);
+    BOOST_TEST(variance.size() == 1ul);
+    BOOST_TEST(variance.mean() == 5.0);
+    BOOST_TEST(variance.size(sliding_time_window_tag<50>) == 3ul);
+    BOOST_TEST(variance.mean(sliding_time_window_tag<50>) == 3.0);
+    BOOST_TEST(variance.sample_buffer_size() == 3ul);
+
+    variance.advance(t0 + 100ms);
+    BOOST_TEST(variance.size(sliding_time_window_tag<50>) == 0ul);
+    BOOST_TEST(variance.sample_buffer_size() == 0ul);
+
+    variance.reset();
+    BOOST_TEST(variance.add(2.0) == 0.0);
+    BOOST_TEST(variance.add(4.0) == 1.0);
+    variance.reset();
+    BOOST_TEST(variance.size() == 0ul);
+    BOOST_TEST(variance.sample_buffer_size() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(drop_oldest)
+{
+    livestats::static_sliding_time_window_variance_estimator_t<double, 4ul, 1, 50> variance;
+    auto const t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; ++i)
+        variance.push(static_cast<double>(i), t0 + i * 10us);
+    // the buffer never grows, the oldest samples leave all windows early
+    BOOST_TEST(variance.memory_usage() == sizeof(variance));
+    BOOST_TEST(variance.sample_buffer_size() == 4ul);
+    BOOST_TEST(variance.size() == 4ul);
+    BOOST_TEST(variance.size(sliding_time_window_tag<50>) == 4ul);
+    BOOST_TEST(variance.size_dropped() == 6ul);
+    BOOST_TEST(variance.mean() == 7.5);
+    BOOST_TEST(variance.get() == 1.25, tiny);
+
+    // a shorter window may already have dropped the oldest sample of the buffer
+    variance.advance(t0 + 1'075us);
+    BOOST_TEST(variance.size() == 2ul);
+    variance.push(10.0, t0 + 1'076us);
+    variance.push(11.0, t0 + 1'078us);
+    BOOST_TEST(variance.size_dropped() == 8ul);
+    BOOST_TEST(variance.size() == 4ul);
+    BOOST_TEST(variance.mean() == 9.5);
+    BOOST_TEST(variance.mean(sliding_time_window_tag<50>) == 9.5);
+}
+
+BOOST_AUTO_TEST_CASE(matches_sliding_time_window_variance)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> value_of(0.0, 1.0);
+    std::exponential_distribution<double> step_of(1.0 / 100.0); // bursts and gaps, 100us on average
+    // large enough never to drop a sample of the 5ms window
+    livestats::static_sliding_time_window_variance_estimator_t<double, 512ul, 1, 5> fixed;
+    livestats::sliding_time_window_variance_estimator_t<double, 1, 5> expected;
+    auto t = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20'000; ++i)
+    {
+        t += std::chrono::microseconds(static_cast<long>(step_of(rng)));
+        auto const x = value_of(rng);
+        fixed.push(x, t);
+        expected.push(x, t);
+        BOOST_REQUIRE(fixed.size() == expected.size());
+        BOOST_REQUIRE(fixed.size(sliding_time_window_tag<5>) == expected.size(sliding_time_window_tag<5>));
+        BOOST_TEST(fixed.get() == expected.get(), tiny);
+        BOOST_TEST(fixed.mean(sliding_time_window_tag<5>) == expected.mean(sliding_time_window_tag<5>), tiny);
+    }
+    BOOST_TEST(fixed.size_dropped() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::static_sliding_time_window_variance_estimator_t<double, 4ul, 1, 50> variance;
+    auto const t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < 6; ++i)
+        variance.push(static_cast<double>(i * i), t0 + i * 300us);
+    std::stringstream checkpoint;
+    variance.save(checkpoint);
+
+    livestats::static_sliding_time_window_variance_estimator_t<double, 4ul, 1, 50> restored;
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.sample_buffer_size() == 4ul);
+    BOOST_TEST(restored.size_dropped() == 2ul);
+    BOOST_TEST(restored.size() == variance.size());
+    BOOST_TEST(restored.get() == variance.get());
+    BOOST_TEST(restored.get(sliding_time_window_tag<50>) == variance.get(sliding_time_window_tag<50>));
+
+    // the restored samples keep expiring as time goes by
+    restored.advance(t0 + 2'300us);
+    variance.advance(t0 + 2'300us);
+    BOOST_TEST(restored.size() == 1ul);
+    BOOST_TEST(restored.get() == variance.get());
+
+    // state saved with different windows or a smaller buffer cannot be restored
+    checkpoint.seekg(0);
+    livestats::static_sliding_time_window_variance_estimator_t<double, 4ul, 1, 100> other;
+    other.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(other.sample_buffer_size() == 0ul);
+    checkpoint.clear();
+    checkpoint.seekg(0);
+    livestats::static_sliding_time_window_variance_estimator_t<double, 2ul, 1, 50> smaller;
+    smaller.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(smaller.sample_buffer_size() == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
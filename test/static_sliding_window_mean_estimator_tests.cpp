@@ -0,0 +1,198 @@
+#define BOOST_TEST_MODULE static_sliding_window_mean_estimator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/static_sliding_window_mean_estimator.hpp"
+
+#include <sstream>
+
+#include <array>
+#include <type_traits>
+
+BOOST_AUTO_TEST_SUITE(static_sliding_window_mean_estimator_tests)
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_uint64)
+{
+    livestats::static_sliding_window_mean_estimator_t<std::uint64_t, 3ul> mean;
+    BOOST_TEST(mean.get() == 0ul);
+    BOOST_TEST(mean.size() == 0ul);
+    BOOST_TEST(mean.full() == false);
+
+    BOOST_TEST(mean.add(1ul) == 1ul);
+    BOOST_TEST(mean.get() == 1ul);
+    BOOST_TEST(mean.size() == 1ul);
+    BOOST_TEST(mean.full() == false);
+    BOOST_TEST(mean.oldest() == 1ul);
+
+    BOOST_TEST(mean.add(3ul) == 2ul);
+    BOOST_TEST(mean.get() == 2ul);
+    BOOST_TEST(mean.size() == 2ul);
+    BOOST_TEST(mean.full() == false);
+    BOOST_TEST(mean.oldest() == 1ul);
+
+    BOOST_TEST(mean.add(17ul) == 7ul);
+    BOOST_TEST(mean.get() == 7ul);
+    BOOST_TEST(mean.size() == 3ul);
+    BOOST_TEST(mean.full() == true);
+    BOOST_TEST(mean.oldest() == 1ul);
+
+    BOOST_TEST(mean.add(1ul) == 7ul);
+    BOOST_TEST(mean.get() == 7ul);
+    BOOST_TEST(mean.size() == 3ul);
+    BOOST_TEST(mean.full() == true);
+    BOOST_TEST(mean.oldest() == 3ul);
+
+    BOOST_TEST(mean.add(1ul) == 6ul);
+    BOOST_TEST(mean.get() == 6ul);
+    BOOST_TEST(mean.size() == 3ul);
+    BOOST_TEST(mean.full() == true);
+    BOOST_TEST(mean.oldest() == 17ul);
+
+    BOOST_TEST(mean.add(1ul) == 1ul);
+    BOOST_TEST(mean.get() == 1ul);
+    BOOST_TEST(mean.size() == 3ul);
+    BOOST_TEST(mean.full() == true);
+    BOOST_TEST(mean.oldest() == 1ul);
+
+    mean.reset();
+    BOOST_TEST(mean.get() == 0ul);
+    BOOST_TEST(mean.size() == 0ul);
+    BOOST_TEST(mean.full() == false);
+    mean.push(1ul);
+    mean.push(3ul);
+    mean.push(17ul);
+    BOOST_TEST(mean.get() == 7ul);
+    BOOST_TEST(mean.size() == 3ul);
+    mean.push(1ul);
+    mean.push(1ul);
+    mean.push(1ul);
+    BOOST_TEST(mean.get() == 1ul);
+    BOOST_TEST(mean.size() == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
+{
+    livestats::static_sliding_window_mean_estimator_t<double, 3ul> mean;
+    BOOST_TEST(mean.get() == 0.0);
+    BOOST_TEST(mean.size() == 0ul);
+    BOOST_TEST(mean.full() == false);
+
+    BOOST_TEST(mean.add(1.0) == 1.0);
+    BOOST_TEST(mean.get() == 1ul);
+    BOOST_TEST(mean.size() == 1ul);
+    BOOST_TEST(mean.full() == false);
+    BOOST_TEST(mean.oldest() == 1.0);
+
+    BOOST_TEST(mean.add(2.0) == 1.5);
+    BOOST_TEST(mean.get() == 1.5);
+    BOOST_TEST(mean.size() == 2ul);
+    BOOST_TEST(mean.full() == false);
+    BOOST_TEST(mean.oldest() == 1.0);
+
+    BOOST_TEST(mean.add(12.0) == 5.0);
+    BOOST_TEST(mean.get() == 5.0);
+    BOOST_TEST(mean.size() == 3ul);
+    BOOST_TEST(mean.full() == true);
+    BOOST_TEST(mean.oldest() == 1.0);
+
+    BOOST_TEST(mean.add(4.5) == 18.5/3);
+    BOOST_TEST(mean.get() == 18.5/3);
+    BOOST_TEST(mean.size() == 3ul);
+    BOOST_TEST(mean.full() == true);
+    BOOST_TEST(mean.oldest() == 2.0);
+
+    BOOST_TEST(mean.add(4.5) == 7.0);
+    BOOST_TEST(mean.get() == 7.0);
+    BOOST_TEST(mean.size() == 3ul);
+    BOOST_TEST(mean.full() == true);
+    BOOST_TEST(mean.oldest() == 12.0);
+
+    BOOST_TEST(mean.add(4.5) == 4.5);
+    BOOST_TEST(mean.get() == 4.5);
+    BOOST_TEST(mean.size() == 3ul);
+    BOOST_TEST(mean.full() == true);
+    BOOST_TEST(mean.oldest() == 4.5);
+
+    mean.reset();
+    BOOST_TEST(mean.get() == 0.0);
+    BOOST_TEST(mean.size() == 0ul);
+    BOOST_TEST(mean.full() == false);
+    mean.push(1.0);
+    mean.push(2.0);
+    mean.push(12.0);
+    BOOST_TEST(mean.get() == 5.0);
+    BOOST_TEST(mean.size() == 3ul);
+    mean.push(4.5);
+    mean.push(4.5);
+    mean.push(4.5);
+    BOOST_TEST(mean.get() == 4.5);
+    BOOST_TEST(mean.size() == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(accumulate_uint32_into_uint64)
+{
+    livestats::static_sliding_window_mean_estimator_t<std::uint32_t, 3ul, std::uint64_t> mean;
+    BOOST_TEST(mean.add(4'000'000'000u) == 4'000'000'000u);
+    BOOST_TEST(mean.add(4'000'000'002u) == 4'000'000'001u);
+    BOOST_TEST(mean.add(4'000'000'004u) == 4'000'000'002u);
+    BOOST_TEST(mean.add(4'000'000'006u) == 4'000'000'004u);
+    BOOST_TEST(mean.get_sum() == 12'000'000'012ul);
+    BOOST_TEST(mean.oldest() == 4'000'000'002u);
+    BOOST_TEST(mean.size() == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(power_of_two_window_size)
+{
+    livestats::static_sliding_window_mean_estimator_t<std::uint64_t, 4ul> mean;
+    for (auto const x: {1ul, 3ul, 5ul, 7ul})
+        mean.push(x);
+    BOOST_TEST(mean.get() == 4ul);
+    BOOST_TEST(mean.full() == true);
+    BOOST_TEST(mean.oldest() == 1ul);
+    for (auto const x: {9ul, 11ul, 13ul, 15ul, 17ul})
+    {
+        mean.push(x);
+        BOOST_TEST(mean.get() == x - 3ul);
+        BOOST_TEST(mean.oldest() == x - 6ul);
+        BOOST_TEST(mean.size() == 4ul);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(embeddable_by_value)
+{
+    using mean_t = livestats::static_sliding_window_mean_estimator_t<double, 8ul>;
+    BOOST_TEST(std::is_trivially_copyable_v<mean_t>);
+    BOOST_TEST(mean_t::capacity() == 8ul);
+    std::array<mean_t, 4ul> means;
+    means[2].push(1.0);
+    auto const copy = means[2];
+    BOOST_TEST(copy.get() == 1.0);
+    BOOST_TEST(copy.size() == 1ul);
+    BOOST_TEST(means[1].size() == 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::static_sliding_window_mean_estimator_t<double, 3ul> mean;
+    for (auto const x: {1.0, 3.0, 17.0, 1.0})
+        mean.push(x);
+    std::stringstream checkpoint;
+    mean.save(checkpoint);
+
+    livestats::static_sliding_window_mean_estimator_t<double, 3ul> restored;
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.get() == mean.get());
+    BOOST_TEST(restored.size() == 3ul);
+    BOOST_TEST(restored.oldest() == 3.0);
+    BOOST_TEST(restored.add(6.0) == mean.add(6.0));
+    BOOST_TEST(restored.oldest() == 17.0);
+
+    // state saved with a different window size cannot be restored
+    checkpoint.seekg(0);
+    livestats::static_sliding_window_mean_estimator_t<double, 4ul> larger;
+    larger.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(larger.size() == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,183 @@
+#define BOOST_TEST_MODULE static_sliding_window_variance_estimator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/static_sliding_window_variance_estimator.hpp"
+
+#include <sstream>
+
+static const auto tiny = boost::test_tools::tolerance(1e-12);
+
+BOOST_AUTO_TEST_SUITE(static_sliding_window_variance_estimator_tests)
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_uint64)
+{
+    livestats::static_sliding_window_variance_estimator_t<std::uint64_t, 3ul> variance;
+    BOOST_TEST(variance.get() == 0ul);
+    BOOST_TEST(variance.size() == 0ul);
+    BOOST_TEST(variance.full() == false);
+
+    BOOST_TEST(variance.add(1ul) == 0ul);
+    BOOST_TEST(variance.get() == 0ul);
+    BOOST_TEST(variance.size() == 1ul);
+    BOOST_TEST(variance.full() == false);
+    BOOST_TEST(variance.oldest() == 1ul);
+
+    BOOST_TEST(variance.add(3ul) == 1ul);
+    BOOST_TEST(variance.get() == 1ul);
+    BOOST_TEST(variance.size() == 2ul);
+    BOOST_TEST(variance.full() == false);
+    BOOST_TEST(variance.oldest() == 1ul);
+
+    BOOST_TEST(variance.add(17ul) == 50ul);
+    BOOST_TEST(variance.get() == 50ul);
+    BOOST_TEST(variance.size() == 3ul);
+    BOOST_TEST(variance.full() == true);
+    BOOST_TEST(variance.oldest() == 1ul);
+
+    BOOST_TEST(variance.add(1ul) == 50ul);
+    BOOST_TEST(variance.get() == 50ul);
+    BOOST_TEST(variance.size() == 3ul);
+    BOOST_TEST(variance.full() == true);
+    BOOST_TEST(variance.oldest() == 3ul);
+
+    BOOST_TEST(variance.add(1ul) == 56ul);
+    BOOST_TEST(variance.get() == 56ul);
+    BOOST_TEST(variance.size() == 3ul);
+    BOOST_TEST(variance.full() == true);
+    BOOST_TEST(variance.oldest() == 17ul);
+
+    BOOST_TEST(variance.add(1ul) == 0ul);
+    BOOST_TEST(variance.get() == 0ul);
+    BOOST_TEST(variance.size() == 3ul);
+    BOOST_TEST(variance.full() == true);
+    BOOST_TEST(variance.oldest() == 1ul);
+
+    variance.reset();
+    BOOST_TEST(variance.get() == 0ul);
+    BOOST_TEST(variance.size() == 0ul);
+    BOOST_TEST(variance.full() == false);
+    variance.push(1ul);
+    variance.push(3ul);
+    variance.push(17ul);
+    BOOST_TEST(variance.get() == 50ul);
+    BOOST_TEST(variance.size() == 3ul);
+    variance.push(1ul);
+    variance.push(1ul);
+    variance.push(1ul);
+    BOOST_TEST(variance.get() == 0ul);
+    BOOST_TEST(variance.size() == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
+{
+    livestats::static_sliding_window_variance_estimator_t<double, 3ul> variance;
+    BOOST_TEST(variance.get() == 0ul);
+    BOOST_TEST(variance.size() == 0ul);
+    BOOST_TEST(variance.full() == false);
+
+    BOOST_TEST(variance.add(1.0) == 0.0);
+    BOOST_TEST(variance.get() == 0.0);
+    BOOST_TEST(variance.size() == 1ul);
+    BOOST_TEST(variance.full() == false);
+    BOOST_TEST(variance.oldest() == 1.0);
+
+    BOOST_TEST(variance.add(3.0) == 1.0);
+    BOOST_TEST(variance.get() == 1.0);
+    BOOST_TEST(variance.size() == 2ul);
+    BOOST_TEST(variance.full() == false);
+    BOOST_TEST(variance.oldest() == 1.0);
+
+    BOOST_TEST(variance.add(17.0) == 50.666666666666, tiny);
+    BOOST_TEST(variance.get() == 50.666666666666, tiny);
+    BOOST_TEST(variance.size() == 3ul);
+    BOOST_TEST(variance.full() == true);
+    BOOST_TEST(variance.oldest() == 1.0);
+
+    BOOST_TEST(variance.add(1.0) == 50.666666666666, tiny);
+    BOOST_TEST(variance.get() == 50.666666666666, tiny);
+    BOOST_TEST(variance.size() == 3ul);
+    BOOST_TEST(variance.full() == true);
+    BOOST_TEST(variance.oldest() == 3.0);
+
+    BOOST_TEST(variance.add(1.0) == 56.888888888888, tiny);
+    BOOST_TEST(variance.get() == 56.888888888888, tiny);
+    BOOST_TEST(variance.size() == 3ul);
+    BOOST_TEST(variance.full() == true);
+    BOOST_TEST(variance.oldest() == 17.0);
+
+    BOOST_TEST(variance.add(1.0) == 0.0);
+    BOOST_TEST(variance.get() == 0.0);
+    BOOST_TEST(variance.size() == 3ul);
+    BOOST_TEST(variance.full() == true);
+    BOOST_TEST(variance.oldest() == 1.0);
+
+    variance.reset();
+    BOOST_TEST(variance.get() == 0.0);
+    BOOST_TEST(variance.size() == 0ul);
+    BOOST_TEST(variance.full() == false);
+    variance.push(1.0);
+    variance.push(3.0);
+    variance.push(17.0);
+    BOOST_TEST(variance.get() == 50.666666666666, tiny);
+    BOOST_TEST(variance.size() == 3ul);
+    variance.push(1.0);
+    variance.push(1.0);
+    variance.push(1.0);
+    BOOST_TEST(variance.get() == 0.0);
+    BOOST_TEST(variance.size() == 3ul);
+}
+
+BOOST_AUTO_TEST_CASE(accumulate_uint32_into_uint64)
+{
+    livestats::static_sliding_window_variance_estimator_t<std::uint32_t, 3ul, std::uint64_t> variance;
+    BOOST_TEST(variance.add(4'000'000'000u) == 0u);
+    BOOST_TEST(variance.add(4'000'000'002u) == 1u);
+    BOOST_TEST(variance.add(4'000'000'004u) == 2u);
+    BOOST_TEST(variance.add(4'000'000'006u) == 2u);
+    BOOST_TEST(variance.size() == 3ul);
+    BOOST_TEST(variance.oldest() == 4'000'000'002u);
+}
+
+BOOST_AUTO_TEST_CASE(power_of_two_window_size)
+{
+    livestats::static_sliding_window_variance_estimator_t<double, 4ul> variance;
+    for (auto const x: {1.0, 3.0, 5.0, 7.0})
+        variance.push(x);
+    BOOST_TEST(variance.get() == 5.0, tiny);
+    BOOST_TEST(variance.full() == true);
+    BOOST_TEST(variance.oldest() == 1.0);
+    for (auto const x: {9.0, 11.0, 13.0, 15.0, 17.0})
+    {
+        variance.push(x);
+        BOOST_TEST(variance.get() == 5.0, tiny);
+        BOOST_TEST(variance.oldest() == x - 6.0);
+        BOOST_TEST(variance.size() == 4ul);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::static_sliding_window_variance_estimator_t<double, 3ul> variance;
+    for (auto const x: {1.0, 3.0, 17.0, 1.0})
+        variance.push(x);
+    std::stringstream checkpoint;
+    variance.save(checkpoint);
+
+    livestats::static_sliding_window_variance_estimator_t<double, 3ul> restored;
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.get() == variance.get());
+    BOOST_TEST(restored.size() == 3ul);
+    BOOST_TEST(restored.oldest() == 3.0);
+    BOOST_TEST(restored.add(6.0) == variance.add(6.0));
+    BOOST_TEST(restored.oldest() == 17.0);
+
+    // state saved with a different window size cannot be restored
+    checkpoint.seekg(0);
+    livestats::static_sliding_window_variance_estimator_t<double, 4ul> larger;
+    larger.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(larger.size() == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
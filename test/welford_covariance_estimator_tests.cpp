@@ -0,0 +1,115 @@
+#define BOOST_TEST_MODULE welford_covariance_estimator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/welford_covariance_estimator.hpp"
+
+#include <cmath>
+#include <sstream>
+
+static const auto tiny = boost::test_tools::tolerance(1e-12);
+
+BOOST_AUTO_TEST_SUITE(welford_covariance_estimator_tests)
+
+BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
+{
+    livestats::welford_covariance_estimator_t<double> covariance;
+    BOOST_TEST(covariance.get() == 0.0, tiny);
+    BOOST_TEST(covariance.size() == 0ul);
+    BOOST_TEST(covariance.correlation() == 0.0, tiny);
+    BOOST_TEST(covariance.slope() == 0.0, tiny);
+
+    BOOST_TEST(covariance.add(1.0, 2.0) == 0.0, tiny);
+    BOOST_TEST(covariance.size() == 1ul);
+    BOOST_TEST(covariance.correlation() == 0.0, tiny);
+    BOOST_TEST(covariance.intercept() == 2.0, tiny);
+
+    BOOST_TEST(covariance.add(2.0, 4.0) == 0.5, tiny);
+    BOOST_TEST(covariance.correlation() == 1.0, tiny);
+    BOOST_TEST(covariance.slope() == 2.0, tiny);
+    BOOST_TEST(covariance.intercept() == 0.0, tiny);
+
+    covariance.push(3.0, 5.0);
+    covariance.push(4.0, 4.0);
+    covariance.push(5.0, 5.0);
+    BOOST_TEST(covariance.size() == 5ul);
+    BOOST_TEST(covariance.mean_x() == 3.0, tiny);
+    BOOST_TEST(covariance.mean_y() == 4.0, tiny);
+    BOOST_TEST(covariance.variance_x() == 2.0, tiny);
+    BOOST_TEST(covariance.variance_y() == 1.2, tiny);
+    BOOST_TEST(covariance.get() == 1.2, tiny);
+    BOOST_TEST(covariance.covariance() == 1.2, tiny);
+    BOOST_TEST(covariance.correlation() == 6.0 / std::sqrt(60.0), tiny);
+    BOOST_TEST(covariance.slope() == 0.6, tiny);
+    BOOST_TEST(covariance.intercept() == 2.2, tiny);
+
+    covariance.reset();
+    BOOST_TEST(covariance.get() == 0.0, tiny);
+    BOOST_TEST(covariance.size() == 0ul);
+    BOOST_TEST(covariance.mean_x() == 0.0, tiny);
+}
+
+BOOST_AUTO_TEST_CASE(negative_correlation)
+{
+    livestats::welford_covariance_estimator_t<double> covariance;
+    for (auto const x: {-2.0, -1.0, 0.0, 1.0, 2.0})
+        covariance.push(x, 3.0 - 2.0 * x);
+    BOOST_TEST(covariance.get() == -4.0, tiny);
+    BOOST_TEST(covariance.correlation() == -1.0, tiny);
+    BOOST_TEST(covariance.slope() == -2.0, tiny);
+    BOOST_TEST(covariance.intercept() == 3.0, tiny);
+}
+
+BOOST_AUTO_TEST_CASE(merge)
+{
+    livestats::welford_covariance_estimator_t<double> all;
+    livestats::welford_covariance_estimator_t<double> first;
+    livestats::welford_covariance_estimator_t<double> second;
+    livestats::welford_covariance_estimator_t<double> empty;
+    double const xs[] = {1.0, 2.0, 3.0, 4.0, 5.0};
+    double const ys[] = {2.0, 4.0, 5.0, 4.0, 5.0};
+    for (std::size_t i = 0ul; i < 5ul; ++i)
+    {
+        all.push(xs[i], ys[i]);
+        (i < 2ul ? first : second).push(xs[i], ys[i]);
+    }
+    first.merge(empty);
+    BOOST_TEST(first.size() == 2ul);
+    first.merge(second);
+    BOOST_TEST(first.size() == 5ul);
+    BOOST_TEST(first.get() == all.get(), tiny);
+    BOOST_TEST(first.mean_x() == all.mean_x(), tiny);
+    BOOST_TEST(first.mean_y() == all.mean_y(), tiny);
+    BOOST_TEST(first.variance_x() == all.variance_x(), tiny);
+    BOOST_TEST(first.variance_y() == all.variance_y(), tiny);
+    BOOST_TEST(first.correlation() == all.correlation(), tiny);
+
+    empty.merge(all);
+    BOOST_TEST(empty.size() == 5ul);
+    BOOST_TEST(empty.get() == all.get(), tiny);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::welford_covariance_estimator_t<double> covariance;
+    covariance.push(1.0, 2.0);
+    covariance.push(2.0, 4.0);
+    covariance.push(3.0, 5.0);
+    std::stringstream checkpoint;
+    covariance.save(checkpoint);
+
+    livestats::welford_covariance_estimator_t<double> restored;
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.size() == 3ul);
+    BOOST_TEST(restored.get() == covariance.get(), tiny);
+    BOOST_TEST(restored.slope() == covariance.slope(), tiny);
+
+    // state saved with a different sample type cannot be restored
+    checkpoint.seekg(0);
+    livestats::welford_covariance_estimator_t<float> other;
+    other.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(other.size() == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
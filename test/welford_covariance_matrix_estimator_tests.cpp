@@ -0,0 +1,168 @@
+#define BOOST_TEST_MODULE welford_covariance_matrix_estimator_tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "livestats/welford_covariance_matrix_estimator.hpp"
+#include "livestats/welford_covariance_estimator.hpp"
+
+#include <array>
+#include <cmath>
+#include <memory_resource>
+#include <sstream>
+#include <vector>
+
+static const auto tiny = boost::test_tools::tolerance(1e-9);
+
+namespace {
+
+/**
+ * Deterministic, correlated observations of the given number of dimensions.
+ */
+std::vector<double> observations(std::size_t const n, std::size_t const dimensions)
+{
+    std::vector<double> xs(n * dimensions);
+    for (std::size_t r = 0ul; r < n; ++r)
+        for (std::size_t j = 0ul; j < dimensions; ++j)
+        {
+            auto const t = static_cast<double>(r);
+            xs[r * dimensions + j] = std::sin(0.3 * t + static_cast<double>(j)) * static_cast<double>(j + 1ul)
+                + std::cos(0.7 * t * static_cast<double>(j % 3ul + 1ul)) + 100.0;
+        }
+    return xs;
+}
+
+/**
+ * Compare every entry of the matrix with a bivariate estimator over the same pair of dimensions.
+ */
+template <typename MatrixEstimator>
+void check_against_pairs(MatrixEstimator const& matrix, std::vector<double> const& xs)
+{
+    auto const d = matrix.dimensions();
+    auto const n = xs.size() / d;
+    BOOST_TEST(matrix.size() == n);
+    std::vector<double> dense(d * d);
+    matrix.covariance_matrix(dense);
+    for (std::size_t i = 0ul; i < d; ++i)
+        for (std::size_t j = 0ul; j < d; ++j)
+        {
+            livestats::welford_covariance_estimator_t<double> pair;
+            for (std::size_t r = 0ul; r < n; ++r)
+                pair.push(xs[r * d + i], xs[r * d + j]);
+            BOOST_TEST(matrix.covariance(i, j) == pair.covariance(), tiny);
+            BOOST_TEST(dense[i * d + j] == pair.covariance(), tiny);
+            BOOST_TEST(matrix.correlation(i, j) == pair.correlation(), tiny);
+            BOOST_TEST(matrix.mean(j) == pair.mean_y(), tiny);
+        }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(welford_covariance_matrix_estimator_tests)
+
+BOOST_AUTO_TEST_CASE(push_get_reset_static)
+{
+    livestats::welford_covariance_matrix_estimator_t<double, 2> covariance;
+    BOOST_TEST(covariance.size() == 0ul);
+    BOOST_TEST(covariance.dimensions() == 2ul);
+    BOOST_TEST(covariance.covariance(0, 1) == 0.0);
+
+    for (auto const& [x, y]: {std::array{1.0, 2.0}, {2.0, 4.0}, {3.0, 5.0}, {4.0, 4.0}, {5.0, 5.0}})
+        covariance.push(std::array{x, y});
+    BOOST_TEST(covariance.size() == 5ul);
+    BOOST_TEST(covariance.mean(0) == 3.0, tiny);
+    BOOST_TEST(covariance.mean(1) == 4.0, tiny);
+    BOOST_TEST(covariance.mean()[1] == 4.0, tiny);
+    BOOST_TEST(covariance.variance(0) == 2.0, tiny);
+    BOOST_TEST(covariance.variance(1) == 1.2, tiny);
+    BOOST_TEST(covariance.covariance(0, 1) == 1.2, tiny);
+    BOOST_TEST(covariance.covariance(1, 0) == 1.2, tiny);
+    BOOST_TEST(covariance.correlation(0, 1) == 6.0 / std::sqrt(60.0), tiny);
+    BOOST_TEST(covariance.correlation(1, 1) == 1.0, tiny);
+
+    covariance.reset();
+    BOOST_TEST(covariance.size() == 0ul);
+    BOOST_TEST(covariance.mean(0) == 0.0);
+    BOOST_TEST(covariance.covariance(0, 1) == 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(push_dynamic)
+{
+    constexpr std::size_t d = 13ul;
+    auto const xs = observations(50ul, d);
+    livestats::welford_covariance_matrix_estimator_t<double> covariance(d);
+    BOOST_TEST(covariance.dimensions() == d);
+    for (std::size_t r = 0ul; r < 50ul; ++r)
+        covariance.push(std::span(xs).subspan(r * d, d));
+    check_against_pairs(covariance, xs);
+}
+
+BOOST_AUTO_TEST_CASE(push_block)
+{
+    constexpr std::size_t d = 6ul;
+    // not a multiple of the block size, to exercise the last partial block
+    auto const xs = observations(8ul * livestats::welford_covariance_matrix_estimator_t<double, d>::block_size + 3ul, d);
+    livestats::welford_covariance_matrix_estimator_t<double, d> covariance;
+    covariance.push(std::span(xs).first(d));
+    covariance.push_block(std::span(xs).subspan(d));
+    check_against_pairs(covariance, xs);
+
+    livestats::welford_covariance_matrix_estimator_t<double> dynamic(d);
+    dynamic.push_block(xs);
+    check_against_pairs(dynamic, xs);
+}
+
+BOOST_AUTO_TEST_CASE(merge)
+{
+    constexpr std::size_t d = 5ul;
+    auto const xs = observations(40ul, d);
+    livestats::welford_covariance_matrix_estimator_t<double, d> first;
+    livestats::welford_covariance_matrix_estimator_t<double, d> second;
+    livestats::welford_covariance_matrix_estimator_t<double, d> empty;
+    first.push_block(std::span(xs).first(15ul * d));
+    second.push_block(std::span(xs).subspan(15ul * d));
+    first.merge(empty);
+    BOOST_TEST(first.size() == 15ul);
+    first.merge(second);
+    check_against_pairs(first, xs);
+
+    empty.merge(first);
+    check_against_pairs(empty, xs);
+}
+
+BOOST_AUTO_TEST_CASE(pmr_allocator)
+{
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    livestats::pmr::welford_covariance_matrix_estimator_t<double> covariance(4ul, &arena);
+    BOOST_TEST(covariance.get_allocator().resource() == &arena);
+    covariance.push(std::array{1.0, 2.0, 3.0, 4.0});
+    covariance.push(std::array{2.0, 4.0, 6.0, 8.0});
+    BOOST_TEST(covariance.covariance(0, 3) == 1.0, tiny);
+    BOOST_TEST(covariance.correlation(1, 2) == 1.0, tiny);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    constexpr std::size_t d = 4ul;
+    auto const xs = observations(20ul, d);
+    livestats::welford_covariance_matrix_estimator_t<double> covariance(d);
+    covariance.push_block(std::span(xs).first(10ul * d));
+    std::stringstream checkpoint;
+    covariance.save(checkpoint);
+
+    // the state of a runtime-D estimator can be restored into a compile-time D one
+    livestats::welford_covariance_matrix_estimator_t<double, d> restored;
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.size() == 10ul);
+    restored.push_block(std::span(xs).subspan(10ul * d));
+    check_against_pairs(restored, xs);
+
+    // state saved with a different number of dimensions cannot be restored
+    checkpoint.seekg(0);
+    livestats::welford_covariance_matrix_estimator_t<double> other(d + 1ul);
+    other.load(checkpoint);
+    BOOST_TEST(checkpoint.fail());
+    BOOST_TEST(other.size() == 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
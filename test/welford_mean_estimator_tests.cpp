@@ -3,6 +3,8 @@
 
 #include "livestats/welford_mean_estimator.hpp"
 
+#include <sstream>
+
 #include <boost/math/special_functions/relative_difference.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
 
@@ -153,4 +155,26 @@ BOOST_AUTO_TEST_CASE(edge_case_double_one_max_max)
     BOOST_TEST(boost::math::relative_difference(mean.add(max), expected_mean) == 0.0, tiny);
 }
 
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::welford_mean_estimator_t<double> mean;
+    mean.push(1.0);
+    mean.push(2.0);
+    std::stringstream checkpoint;
+    mean.save(checkpoint);
+
+    livestats::welford_mean_estimator_t<double> restored;
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.get() == 1.5);
+    BOOST_TEST(restored.size() == 2ul);
+    BOOST_TEST(restored.add(6.0) == mean.add(6.0));
+
+    // truncated state cannot be restored
+    std::stringstream truncated(checkpoint.str().substr(0ul, 10ul));
+    restored.load(truncated);
+    BOOST_TEST(truncated.fail());
+    BOOST_TEST(restored.size() == 0ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
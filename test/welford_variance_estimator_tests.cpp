@@ -6,6 +6,8 @@
 #include "livestats/naive_mean_estimator.hpp"
 #include "livestats/welford_variance_estimator.hpp"
 
+#include <sstream>
+
 static const auto tiny = boost::test_tools::tolerance(1e-12);
 
 BOOST_AUTO_TEST_SUITE(welford_variance_estimator_tests)
@@ -56,6 +58,7 @@ BOOST_AUTO_TEST_CASE(add_push_get_reset_double)
     BOOST_TEST(variance.size() == 2ul);
 
     BOOST_TEST(variance.add(7.0) == expected_variance, tiny);
+    BOOST_TEST(variance.mean() == mean, tiny);
     BOOST_TEST(variance.get() == expected_variance, tiny);
     BOOST_TEST(variance.size() == 3ul);
 
@@ -102,4 +105,20 @@ BOOST_AUTO_TEST_CASE(add_push_get_reset_multiprecision)
     BOOST_TEST(variance.size() == 2ul);
 }
 
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    livestats::welford_variance_estimator_t<double> variance;
+    for (auto const x: {1.0, 3.0, 17.0})
+        variance.push(x);
+    std::stringstream checkpoint;
+    variance.save(checkpoint);
+
+    livestats::welford_variance_estimator_t<double> restored;
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.get() == variance.get());
+    BOOST_TEST(restored.size() == 3ul);
+    BOOST_TEST(restored.add(6.0) == variance.add(6.0));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
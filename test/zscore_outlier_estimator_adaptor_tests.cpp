@@ -5,6 +5,8 @@
 #include "livestats/zscore_outlier_estimator_adaptor.hpp"
 
 #include <ranges>
+#include <sstream>
+#include <vector>
 
 static const auto tiny = boost::test_tools::tolerance(1e-12);
 
@@ -127,5 +129,160 @@ BOOST_AUTO_TEST_CASE(adapt_to_regime_changes_double)
     BOOST_TEST(filtered_mean.size() == 3ul);
 }
 
+BOOST_AUTO_TEST_CASE(runtime_threshold)
+{
+    filtered_mean_estimator_t<double> strict(1.0);
+    filtered_mean_estimator_t<double> lenient(20.0);
+    BOOST_TEST(filtered_mean_estimator_t<double>().threshold() == 3.0);
+    for (auto const x: {1.0, 2.0, 8.0})
+    {
+        strict.push(x);
+        lenient.push(x);
+    }
+    BOOST_TEST(strict.size_discarded() == 1ul);
+    BOOST_TEST(lenient.size_discarded() == 0ul);
+    BOOST_TEST(lenient.get() == 11.0/3);
+
+    lenient.set_threshold(1.0);
+    BOOST_TEST(lenient.threshold() == 1.0);
+    lenient.push(30.0);
+    BOOST_TEST(lenient.size_discarded() == 1ul);
+}
+
+BOOST_AUTO_TEST_CASE(push_block)
+{
+    filtered_mean_estimator_t<double> filtered_mean;
+    std::vector<double> const first = {1.0, 2.0};
+    // nothing to judge against yet, so the whole first block is accepted
+    BOOST_TEST(filtered_mean.push_block(first) == 0ul);
+    BOOST_TEST(filtered_mean.get() == 1.5);
+
+    // all samples are judged against mean 1.5 and variance 0.25; with per-sample refresh the second 8 is accepted
+    std::vector<double> const second = {8.0, 1.5, 8.0};
+    BOOST_TEST(filtered_mean.push_block(second) == 2ul);
+    BOOST_TEST(filtered_mean.size() == 3ul);
+    BOOST_TEST(filtered_mean.size_discarded() == 2ul);
+    BOOST_TEST(filtered_mean.get() == 1.5);
+
+    filtered_mean_estimator_t<double> per_sample;
+    for (auto const x: {1.0, 2.0, 8.0, 1.5, 8.0})
+        per_sample.push(x);
+    BOOST_TEST(per_sample.size_discarded() == 1ul);
+
+    // the baseline includes the whole block, discarded samples included
+    filtered_mean_estimator_t<double> baseline;
+    for (auto const x: {1.0, 2.0})
+        baseline.push(x);
+    baseline.push_block(second);
+    // so both filters go on classifying new samples identically
+    for (auto const x: {30.0, 3.0, 0.5})
+    {
+        baseline.push(x);
+        per_sample.push(x);
+        BOOST_TEST(baseline.size_discarded() - per_sample.size_discarded() == 1ul);
+    }
+    BOOST_TEST(per_sample.size_discarded() == 2ul);
+}
+
+BOOST_AUTO_TEST_CASE(push_block_larger_than_chunk)
+{
+    filtered_mean_estimator_t<std::uint64_t> filtered_mean;
+    filtered_mean.push(100ul);
+    filtered_mean.push(110ul);
+    // mean 105 and variance 25: 120 and 90 are exactly 3 standard deviations away, so they are accepted
+    std::vector<std::uint64_t> block;
+    for (std::uint64_t i = 0ul; i < 1000ul; ++i)
+        block.push_back(i % 100ul == 0ul ? 1000ul : 90ul + i % 31ul);
+    std::size_t expected_rejected = 0ul;
+    std::uint64_t expected_sum = 210ul;
+    for (auto const x: block)
+        if (x > 120ul or x < 90ul)
+            ++expected_rejected;
+        else
+            expected_sum += x;
+    BOOST_TEST(filtered_mean.push_block(block) == expected_rejected);
+    BOOST_TEST(filtered_mean.size_discarded() == expected_rejected);
+    BOOST_TEST(filtered_mean.size() == 1002ul - expected_rejected);
+    BOOST_TEST(filtered_mean.get() == expected_sum / filtered_mean.size());
+}
+
+/**
+ * A variance estimator hiding the mean it tracks, which forces the adaptor to maintain its own mean estimator.
+ */
+struct opaque_variance_estimator_t
+{
+    using value_type = double;
+    livestats::welford_variance_estimator_t<double> variance;
+    value_type add(value_type const x) { return variance.add(x); }
+    void push(value_type const x) { variance.push(x); }
+    void reset() { variance.reset(); }
+    value_type get() const { return variance.get(); }
+    std::size_t size() const { return variance.size(); }
+};
+static_assert(not livestats::MeanVarianceEstimator<opaque_variance_estimator_t>);
+static_assert(livestats::MeanVarianceEstimator<livestats::welford_variance_estimator_t<double>>);
+
+BOOST_AUTO_TEST_CASE(reuse_variance_mean)
+{
+    using shared_t = filtered_mean_estimator_t<double>;
+    using separate_t = livestats::zscore_outlier_estimator_adaptor_t<
+        livestats::naive_mean_estimator_t<double>,
+        livestats::welford_mean_estimator_t<double>,
+        opaque_variance_estimator_t
+    >;
+    static_assert(sizeof(shared_t) < sizeof(separate_t));
+
+    shared_t shared;
+    separate_t separate;
+    for (auto const x: {1.0, 2.0, 8.0, 1.5, 3.0, 8.0, 8.0, 8.0, 1.0, 40.0})
+        BOOST_TEST(shared.add(x) == separate.add(x));
+    BOOST_TEST(shared.size() == separate.size());
+    BOOST_TEST(shared.size_discarded() == separate.size_discarded());
+    BOOST_TEST(shared.size_discarded() > 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+    filtered_mean_estimator_t<double> filtered_mean;
+    for (auto const x: {1.0, 2.0, 8.0})
+        filtered_mean.push(x);
+    std::stringstream checkpoint;
+    filtered_mean.save(checkpoint);
+
+    filtered_mean_estimator_t<double> restored;
+    restored.load(checkpoint);
+    BOOST_TEST(checkpoint.good());
+    BOOST_TEST(restored.get() == 1.5);
+    BOOST_TEST(restored.size() == 2ul);
+    BOOST_TEST(restored.size_discarded() == 1ul);
+    // the restored outlier filter keeps rejecting the same samples
+    BOOST_TEST(restored.add(8.0) == filtered_mean.add(8.0));
+    BOOST_TEST(restored.size_discarded() == filtered_mean.size_discarded());
+}
+
+BOOST_AUTO_TEST_CASE(load_rejects_older_format)
+{
+    using namespace livestats::serialization;
+
+    filtered_mean_estimator_t<double> filtered_mean;
+    for (auto const x: {1.0, 2.0, 8.0})
+        filtered_mean.push(x);
+    std::stringstream checkpoint;
+    filtered_mean.save(checkpoint);
+
+    // a checkpoint of the previous version may still hold the redundant mean
+    auto bytes = checkpoint.str();
+    auto header = read<header_t>(checkpoint);
+    header.version = static_cast<std::uint16_t>(version - 1u);
+    bytes.replace(0ul, sizeof(header_t), reinterpret_cast<char const*>(&header), sizeof(header_t));
+
+    std::stringstream older(bytes);
+    filtered_mean_estimator_t<double> restored;
+    restored.push(1.0);
+    restored.load(older);
+    BOOST_TEST(older.fail());
+    BOOST_TEST(restored.size() == 0ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
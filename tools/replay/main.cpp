@@ -0,0 +1,411 @@
+// livestats-replay: push recorded (timestamp, value) streams through livestats estimators as fast as possible.
+//
+// Input files are memory-mapped and either
+//   - binary: packed little-endian records of { std::int64_t timestamp in nanoseconds; double value; }
+//   - csv: one `timestamp_ns,value` record per line, optionally preceded by a header line.
+// Snapshots of all estimators are written to stdout as CSV every `--snapshot-interval` of recorded time,
+// and the ingest throughput is reported to stderr at the end.
+
+#include "livestats/sliding_time_window_variance_estimator.hpp"
+#include "livestats/sliding_window_variance_estimator.hpp"
+#include "livestats/welford_variance_estimator.hpp"
+#include "livestats/zscore_outlier_estimator_adaptor.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+enum class format_t { binary, csv };
+
+/**
+ * The sets of time windows the tool is compiled for, since window sizes are template arguments.
+ */
+enum class windows_t { fine, medium, coarse };
+
+struct options_t
+{
+    std::vector<std::string> files;
+    std::optional<format_t> format; // deduced from the file extension if not given
+    bool time_windows = true;
+    bool count_window = true;
+    bool zscore = true;
+    windows_t windows = windows_t::medium;
+    double zscore_threshold = 3.0;
+    std::size_t count_window_size = 1000ul;
+    std::size_t capacity = 0ul;
+    std::chrono::nanoseconds snapshot_interval = std::chrono::seconds(1);
+};
+
+constexpr char const* usage = R"(usage: livestats-replay [options] FILE...
+
+Options:
+  --format binary|csv        input format; by default `.csv` files are CSV and anything else is binary
+  --estimators LIST          comma-separated subset of `time,count,zscore` (default: all)
+  --windows fine|medium|coarse
+                             time windows: 100us,1ms,10ms,100ms (fine), 1ms,10ms,100ms,1s (medium, the default)
+                             or 1s,10s,1m,5m (coarse)
+  --zscore-threshold Z       samples more than Z standard deviations from the mean are outliers (default: 3)
+  --count-window N           number of samples in the count-based sliding window (default: 1000)
+  --capacity N               preallocated sample buffer of the time window estimator (default: 0)
+  --snapshot-interval MS     recorded time between snapshots, in milliseconds; 0 disables them (default: 1000)
+  --help                     show this message
+)";
+
+template <typename T>
+std::optional<T> parse_number(std::string_view const s)
+{
+    T x{};
+    auto const [end, error] = std::from_chars(s.data(), s.data() + s.size(), x);
+    if (error != std::errc{} or end != s.data() + s.size())
+        return std::nullopt;
+    return x;
+}
+
+std::optional<options_t> parse_options(int const argc, char const* const* const argv)
+{
+    options_t options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view const arg = argv[i];
+        auto const value = [&] () -> std::optional<std::string_view>
+        {
+            if (i + 1 < argc)
+                return argv[++i];
+            std::fprintf(stderr, "missing value for %s\n", argv[i]);
+            return std::nullopt;
+        };
+        if (arg == "--help")
+            return std::nullopt;
+        else if (arg == "--format")
+        {
+            auto const v = value();
+            if (v == "binary")
+                options.format = format_t::binary;
+            else if (v == "csv")
+                options.format = format_t::csv;
+            else
+                return std::nullopt;
+        }
+        else if (arg == "--estimators")
+        {
+            auto const v = value();
+            if (not v)
+                return std::nullopt;
+            options.time_windows = options.count_window = options.zscore = false;
+            for (auto list = *v; not list.empty();)
+            {
+                auto const comma = list.find(',');
+                auto const name = list.substr(0ul, comma);
+                list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1ul);
+                if (name == "time")
+                    options.time_windows = true;
+                else if (name == "count")
+                    options.count_window = true;
+                else if (name == "zscore")
+                    options.zscore = true;
+                else
+                {
+                    std::fprintf(stderr, "unknown estimator %.*s\n", static_cast<int>(name.size()), name.data());
+                    return std::nullopt;
+                }
+            }
+        }
+        else if (arg == "--windows")
+        {
+            auto const v = value();
+            if (v == "fine")
+                options.windows = windows_t::fine;
+            else if (v == "medium")
+                options.windows = windows_t::medium;
+            else if (v == "coarse")
+                options.windows = windows_t::coarse;
+            else
+                return std::nullopt;
+        }
+        else if (arg == "--zscore-threshold")
+        {
+            auto const v = value();
+            auto const z = v ? parse_number<double>(*v) : std::nullopt;
+            if (not z or not (*z > 0.0))
+                return std::nullopt;
+            options.zscore_threshold = *z;
+        }
+        else if (arg == "--count-window" or arg == "--capacity" or arg == "--snapshot-interval")
+        {
+            auto const v = value();
+            auto const n = v ? parse_number<std::size_t>(*v) : std::nullopt;
+            if (not n or (arg == "--count-window" and *n == 0ul))
+                return std::nullopt;
+            if (arg == "--count-window")
+                options.count_window_size = *n;
+            else if (arg == "--capacity")
+                options.capacity = *n;
+            else
+                options.snapshot_interval = std::chrono::milliseconds(*n);
+        }
+        else if (arg.starts_with("--"))
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return std::nullopt;
+        }
+        else
+            options.files.emplace_back(arg);
+    }
+    if (options.files.empty())
+        return std::nullopt;
+    return options;
+}
+
+/**
+ * A read-only memory mapping of a whole file.
+ */
+class mapped_file_t
+{
+    char const* data = nullptr;
+    std::size_t size = 0ul;
+
+public:
+    explicit mapped_file_t(std::string const& path)
+    {
+        int const fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), path);
+        struct stat st;
+        if (::fstat(fd, &st) == 0 and st.st_size > 0)
+        {
+            size = static_cast<std::size_t>(st.st_size);
+            void* const p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                data = static_cast<char const*>(p);
+                ::madvise(p, size, MADV_SEQUENTIAL);
+            }
+        }
+        auto const error = errno;
+        ::close(fd);
+        if (size > 0ul and not data)
+            throw std::system_error(error, std::generic_category(), path);
+    }
+
+    ~mapped_file_t()
+    {
+        if (data)
+            ::munmap(const_cast<char*>(data), size);
+    }
+
+    mapped_file_t(mapped_file_t const&) = delete;
+    mapped_file_t& operator=(mapped_file_t const&) = delete;
+
+    std::string_view contents() const { return {data, size}; }
+};
+
+/**
+ * Call `f(timestamp, value)` for every record in the given binary contents; return the number of records.
+ */
+template <typename F>
+std::size_t for_each_binary_record(std::string_view const contents, F&& f)
+{
+    constexpr auto record_size = sizeof(std::int64_t) + sizeof(double);
+    auto const n = contents.size() / record_size;
+    for (std::size_t i = 0ul; i < n; ++i)
+    {
+        std::int64_t ns;
+        double value;
+        std::memcpy(&ns, contents.data() + i * record_size, sizeof(ns));
+        std::memcpy(&value, contents.data() + i * record_size + sizeof(ns), sizeof(value));
+        f(clock_type::time_point(std::chrono::nanoseconds(ns)), value);
+    }
+    return n;
+}
+
+/**
+ * Call `f(timestamp, value)` for every well-formed line in the given CSV contents; return the number of records.
+ */
+template <typename F>
+std::size_t for_each_csv_record(std::string_view contents, F&& f)
+{
+    std::size_t n = 0ul;
+    while (not contents.empty())
+    {
+        auto const eol = contents.find('\n');
+        auto line = contents.substr(0ul, eol);
+        contents.remove_prefix(eol == std::string_view::npos ? contents.size() : eol + 1ul);
+        if (line.ends_with('\r'))
+            line.remove_suffix(1ul);
+        auto const comma = line.find(',');
+        if (comma == std::string_view::npos)
+            continue;
+        auto const ns = parse_number<std::int64_t>(line.substr(0ul, comma));
+        auto const value = parse_number<double>(line.substr(comma + 1ul));
+        if (not ns or not value) // eg the header line
+            continue;
+        f(clock_type::time_point(std::chrono::nanoseconds(*ns)), *value);
+        ++n;
+    }
+    return n;
+}
+
+/**
+ * Return the name of a time window in CSV headers, eg `100us` or `10ms`.
+ */
+std::string window_name(std::chrono::nanoseconds const size)
+{
+    auto const ns = size.count();
+    if (ns % 1'000'000 == 0)
+        return std::to_string(ns / 1'000'000) + "ms";
+    if (ns % 1'000 == 0)
+        return std::to_string(ns / 1'000) + "us";
+    return std::to_string(ns) + "ns";
+}
+
+/**
+ * The estimators that recorded samples are pushed through.
+ */
+template <livestats::sliding_time_window_size_t Window1, livestats::sliding_time_window_size_t... WindowN>
+class estimator_chain_t
+{
+    using time_windows_t = livestats::sliding_time_window_variance_estimator_t<double, Window1, WindowN...>;
+    using zscore_t = livestats::zscore_outlier_estimator_adaptor_t<livestats::welford_variance_estimator_t<double>>;
+
+    options_t const& options;
+    time_windows_t time_windows;
+    livestats::sliding_window_variance_estimator_t<double> count_window;
+    zscore_t zscore;
+
+public:
+    explicit estimator_chain_t(options_t const& options)
+        : options(options)
+        , time_windows(options.capacity)
+        , count_window(options.count_window_size)
+        , zscore(options.zscore_threshold)
+    { }
+
+    void push(clock_type::time_point const timestamp, double const value)
+    {
+        if (options.time_windows)
+            time_windows.push(value, timestamp);
+        if (options.count_window)
+            count_window.push(value);
+        if (options.zscore)
+            zscore.push(value);
+    }
+
+    static void print_header()
+    {
+        std::printf("timestamp_ns");
+        for (auto const& w: {window_name(Window1.duration()), window_name(WindowN.duration())...})
+            std::printf(",size_%s,mean_%s,variance_%s", w.c_str(), w.c_str(), w.c_str());
+        std::printf(",count_window_variance,zscore_variance,zscore_discarded\n");
+    }
+
+    /**
+     * Print the state of all estimators at the given time, which must not be older than any sample pushed so far,
+     * so that the time windows end at that time rather than at the latest sample.
+     */
+    void print_snapshot(clock_type::time_point const timestamp)
+    {
+        using livestats::sliding_time_window_tag;
+        time_windows.advance(timestamp);
+        auto const print_window = [&] (auto const w)
+        {
+            std::printf(",%zu,%.17g,%.17g", time_windows.size(w), time_windows.mean(w), time_windows.get(w));
+        };
+        std::printf("%lld", static_cast<long long>(timestamp.time_since_epoch().count()));
+        print_window(sliding_time_window_tag<Window1>);
+        (print_window(sliding_time_window_tag<WindowN>), ...);
+        std::printf(",%.17g,%.17g,%zu\n", count_window.get(), zscore.get(), zscore.size_discarded());
+    }
+
+    std::size_t high_watermark() const { return time_windows.high_watermark(); }
+};
+
+/**
+ * Replay all input files through the estimators, with the given time windows; return the exit status.
+ */
+template <livestats::sliding_time_window_size_t Window1, livestats::sliding_time_window_size_t... WindowN>
+int replay(options_t const& options)
+{
+    estimator_chain_t<Window1, WindowN...> chain(options);
+    std::optional<clock_type::time_point> next_snapshot;
+    auto const push = [&] (clock_type::time_point const timestamp, double const value)
+    {
+        if (options.snapshot_interval.count() > 0)
+        {
+            if (not next_snapshot)
+                next_snapshot = timestamp + options.snapshot_interval;
+            while (*next_snapshot <= timestamp)
+            {
+                chain.print_snapshot(*next_snapshot);
+                *next_snapshot += options.snapshot_interval;
+            }
+        }
+        chain.push(timestamp, value);
+    };
+
+    if (options.snapshot_interval.count() > 0)
+        chain.print_header();
+    std::size_t n = 0ul;
+    std::size_t bytes = 0ul;
+    auto const t0 = std::chrono::steady_clock::now();
+    for (auto const& path: options.files)
+    {
+        try
+        {
+            mapped_file_t const file(path);
+            auto const format = options.format.value_or(path.ends_with(".csv") ? format_t::csv : format_t::binary);
+            auto const contents = file.contents();
+            n += format == format_t::csv ? for_each_csv_record(contents, push) : for_each_binary_record(contents, push);
+            bytes += contents.size();
+        }
+        catch (std::system_error const& e)
+        {
+            std::fprintf(stderr, "cannot read %s\n", e.what());
+            return 1;
+        }
+    }
+    auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::fprintf(stderr, "replayed %zu samples (%zu bytes) in %.3fs: %.0f samples/s, %.1f MB/s; "
+                         "time window buffer high watermark: %zu samples\n",
+                 n, bytes, elapsed, elapsed > 0.0 ? n / elapsed : 0.0, elapsed > 0.0 ? bytes / elapsed / 1e6 : 0.0,
+                 chain.high_watermark());
+    return 0;
+}
+
+} // namespace
+
+int main(int const argc, char const* const* const argv)
+{
+    using namespace std::chrono_literals;
+    auto const options = parse_options(argc, argv);
+    if (not options)
+    {
+        std::fputs(usage, stderr);
+        return 1;
+    }
+    switch (options->windows)
+    {
+    case windows_t::fine:
+        return replay<100us, 1ms, 10ms, 100ms>(*options);
+    case windows_t::medium:
+        return replay<1ms, 10ms, 100ms, 1s>(*options);
+    case windows_t::coarse:
+        return replay<1s, 10s, 1min, 5min>(*options);
+    }
+    return 1;
+}